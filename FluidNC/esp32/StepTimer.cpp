@@ -44,6 +44,8 @@ void IRAM_ATTR stepTimerStop() {
     timer_ll_set_alarm_enable(&TIMERG0, TIMER_0, false);
 }
 
+void stepTimerPoll() {}
+
 void stepTimerInit(uint32_t frequency, bool (*callback)(void)) {
     timer_ll_intr_disable(&TIMERG0, TIMER_0);
     timer_ll_set_counter_enable(&TIMERG0, TIMER_0, TIMER_PAUSE);
@@ -12,6 +12,11 @@ void stepTimerStop();
 void stepTimerSetTicks(uint32_t ticks);
 void stepTimerStart();
 
+// Deliver step timer interrupts that have fallen due.  The hardware timer
+// interrupts on its own so this does nothing on ESP32; the host simulator
+// uses it to advance its virtual clock.
+void stepTimerPoll();
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,9 @@
 // GPIO interface
 
 void gpio_write(pinnum_t pin, bool value);
+// Drives the outputs in set high and those in clear low, with a register write
+// for each bank that has any; bit n of each mask is GPIO n
+void gpio_write_masks(uint64_t set, uint64_t clear);
 bool gpio_read(pinnum_t pin);
 void gpio_mode(pinnum_t pin, bool input, bool output, bool pullup, bool pulldown, bool opendrain = false);
 void gpio_set_interrupt_type(pinnum_t pin, int mode);
@@ -0,0 +1,13 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// PWM for the simulator.  The duty cycle is not modelled; spindles and
+// lasers only need the period to scale their output.
+
+#include "Driver/PwmPin.h"
+
+PwmPin::PwmPin(Pin& pin, uint32_t frequency) : _frequency(frequency), _channel(0), _period(1 << 10), _gpio(pin.getNative(Pin::Capabilities::PWM)) {}
+
+PwmPin::~PwmPin() {}
+
+void PwmPin::setDuty(uint32_t duty) {}
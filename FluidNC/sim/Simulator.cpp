@@ -0,0 +1,263 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Host-side motion simulator.
+//
+//   fluidnc_sim [options] config.yaml job.nc trace.bin
+//
+//   --loop-us N   virtual cost of one realtime loop pass (default 50)
+//   --line-us N   virtual cost of parsing one G-code line (default 0)
+//
+// The job is fed through gc_execute_line() exactly as the main loop would,
+// and the step timer interrupt runs against a virtual clock.  Every step
+// segment that the ISR executes is written to the trace file, as is every
+// occasion on which the stepper ran dry before the end of the job.  See
+// README.md in this directory for the trace format.
+
+#include "Simulator.h"
+
+#include "src/Machine/MachineConfig.h"
+#include "src/Planner.h"
+#include "src/Stepper.h"
+#include "src/MotionControl.h"
+#include "src/GCode.h"
+#include "src/Protocol.h"
+#include "src/System.h"
+#include "src/StringRange.h"
+#include "src/Stepping.h"
+#include "src/Channel.h"
+#include "src/Settings.h"
+#include "src/Spindles/Spindle.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+    using Machine::Stepping;
+
+    const char     traceMagic[4] = { 'F', 'N', 'C', 'S' };
+    const uint16_t traceVersion  = 1;
+
+    enum class Record : uint8_t {
+        Segment = 'S',
+        Starved = 'E',
+        Line    = 'L',
+    };
+
+    enum class Starve : uint8_t {
+        Segments = 1,  // The planner had blocks but prep_buffer() did not keep up
+        Planner  = 2,  // The planner was empty while input lines remained
+    };
+
+    FILE*    trace = nullptr;
+    size_t   n_axis;
+    float    steps_per_mm[MAX_N_AXIS];
+    bool     segmentOpen = false;
+    uint64_t segmentStartTime;
+    uint32_t segmentTicks;
+    int32_t  segmentStartSteps[MAX_N_AXIS];
+
+    uint32_t segmentCount = 0;
+    uint32_t starveCount  = 0;
+    uint64_t busyTicks    = 0;
+
+    template <typename T>
+    void put(T value) {
+        fwrite(&value, sizeof(value), 1, trace);
+    }
+
+    void writeHeader() {
+        fwrite(traceMagic, sizeof(traceMagic), 1, trace);
+        put<uint16_t>(traceVersion);
+        put<uint8_t>(n_axis);
+        put<uint8_t>(0);
+        put<uint32_t>(Stepping::fStepperTimer);
+        put<uint32_t>(Sim::loopTicks);
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            put<float>(steps_per_mm[axis]);
+        }
+    }
+
+    void closeSegment() {
+        if (!segmentOpen) {
+            return;
+        }
+        segmentOpen       = false;
+        uint64_t duration = Sim::now() - segmentStartTime;
+        int32_t* steps    = get_motor_steps();
+        float    mm_sqr   = 0;
+
+        put<uint8_t>(uint8_t(Record::Segment));
+        put<uint64_t>(segmentStartTime);
+        put<uint32_t>(uint32_t(duration));
+        put<uint32_t>(segmentTicks);
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            int32_t delta = steps[axis] - segmentStartSteps[axis];
+            float   mm    = delta / steps_per_mm[axis];
+            mm_sqr += mm * mm;
+            put<int32_t>(delta);
+        }
+        // Average speed over the segment in mm/min
+        float minutes = float(duration) / (Stepping::fStepperTimer * 60.0f);
+        put<float>(minutes > 0 ? sqrtf(mm_sqr) / minutes : 0.0f);
+
+        segmentCount++;
+        busyTicks += duration;
+    }
+
+    void openSegment(uint32_t ticks) {
+        segmentOpen      = true;
+        segmentStartTime = Sim::now();
+        segmentTicks     = ticks;
+        memcpy(segmentStartSteps, get_motor_steps(), sizeof(segmentStartSteps));
+    }
+
+    bool loadConfig(const char* filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            fprintf(stderr, "Cannot open configuration file %s\n", filename);
+            return false;
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string yaml = contents.str();
+
+        char* buffer = new char[yaml.length() + 1];
+        memcpy(buffer, yaml.c_str(), yaml.length() + 1);
+        bool okay = Machine::MachineConfig::load_yaml(new StringRange(buffer, buffer + yaml.length()));
+        delete[] buffer;
+        return okay;
+    }
+
+    // The subset of setup() and reset_variables() in Main.cpp that concerns motion
+    void initMotion() {
+        config->_stepping->init();
+        plan_init();
+        config->_axes->init();
+        config->_kinematics->init();
+
+        // Laser and PWM spindles are updated from the stepper ISR, so they need their outputs
+        for (auto s : config->_spindles) {
+            s->init();
+        }
+        Spindles::Spindle::switchSpindle(0, config->_spindles, spindle);
+
+        system_reset();
+        protocol_reset();
+        gc_init();
+        plan_reset();
+        Stepper::reset();
+        plan_sync_position();
+        gc_sync_position();
+        mc_init();
+
+        sys.set_state(State::Idle);
+    }
+}
+
+namespace Sim {
+    bool inputPending = false;
+
+    void segmentStart(uint32_t ticks) {
+        closeSegment();
+        openSegment(ticks);
+    }
+
+    void timerStopped() {
+        closeSegment();
+
+        bool plannerBusy = plan_get_current_block() != nullptr;
+        if (plannerBusy || inputPending) {
+            put<uint8_t>(uint8_t(Record::Starved));
+            put<uint64_t>(now());
+            put<uint8_t>(uint8_t(plannerBusy ? Starve::Segments : Starve::Planner));
+            starveCount++;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t    lineTicks = 0;
+    const char* files[3];
+    int         nfiles = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--loop-us") && i + 1 < argc) {
+            Sim::loopTicks = atoi(argv[++i]) * (Stepping::fStepperTimer / 1000000);
+        } else if (!strcmp(argv[i], "--line-us") && i + 1 < argc) {
+            lineTicks = atoi(argv[++i]) * (Stepping::fStepperTimer / 1000000);
+        } else if (nfiles < 3) {
+            files[nfiles++] = argv[i];
+        } else {
+            nfiles = 0;
+            break;
+        }
+    }
+    if (nfiles != 3) {
+        fprintf(stderr, "Usage: %s [--loop-us N] [--line-us N] config.yaml job.nc trace.bin\n", argv[0]);
+        return 2;
+    }
+
+    protocol_init();
+    settings_init();
+    if (!loadConfig(files[0])) {
+        return 1;
+    }
+    initMotion();
+
+    n_axis = config->_axes->_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        steps_per_mm[axis] = config->_axes->_axis[axis]->_stepsPerMm;
+    }
+
+    std::ifstream job(files[1]);
+    if (!job) {
+        fprintf(stderr, "Cannot open job file %s\n", files[1]);
+        return 1;
+    }
+    trace = fopen(files[2], "wb");
+    if (!trace) {
+        fprintf(stderr, "Cannot create trace file %s\n", files[2]);
+        return 1;
+    }
+    writeHeader();
+
+    std::string line;
+    uint32_t    lineNumber = 0;
+    Sim::inputPending      = true;
+    while (std::getline(job, line)) {
+        ++lineNumber;
+        Sim::advance(lineTicks);
+
+        put<uint8_t>(uint8_t(Record::Line));
+        put<uint64_t>(Sim::now());
+        put<uint32_t>(lineNumber);
+
+        char buffer[Channel::maxLine];
+        strncpy(buffer, line.c_str(), sizeof(buffer) - 1);
+        buffer[sizeof(buffer) - 1] = '\0';
+
+        Error status = gc_execute_line(buffer);
+        if (status != Error::Ok) {
+            fprintf(stderr, "Line %u: error %d: %s\n", lineNumber, int(status), line.c_str());
+        }
+
+        // Same checkpoint as protocol_main_loop()
+        protocol_auto_cycle_start();
+        protocol_execute_realtime();
+    }
+    Sim::inputPending = false;
+    protocol_buffer_synchronize();
+    closeSegment();
+    fclose(trace);
+
+    double seconds = double(Sim::now()) / Stepping::fStepperTimer;
+    printf("lines %u, segments %u, starvations %u\n", lineNumber, segmentCount, starveCount);
+    printf("virtual time %.3f s, stepping %.3f s\n", seconds, double(busyTicks) / Stepping::fStepperTimer);
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Host-side motion simulator.  The planner, the segment generator and the
+// stepper ISR run unmodified; only the Driver layer (step timer and CPU
+// cycle counter) is replaced by a virtual clock so that a run is fully
+// deterministic and independent of the speed of the host.
+
+#include <cstdint>
+
+namespace Sim {
+    // Virtual time is counted in step timer ticks (fStepperTimer, 20 MHz)
+    uint64_t now();
+
+    // Advance virtual time by ticks, running every step timer interrupt that
+    // falls due along the way.
+    void advance(uint64_t ticks);
+
+    // Cost of one pass through protocol_exec_rt_system(), in timer ticks.
+    extern uint32_t loopTicks;
+
+    // Set by the runner while input lines remain, so that an empty segment
+    // buffer can be told apart from the normal end of the job.
+    extern bool inputPending;
+
+    // Hooks from the virtual step timer into the trace writer
+    void segmentStart(uint32_t ticks);
+    void timerStopped();
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Virtual replacement for the ESP32 alarm timer used for step timing.
+// Interrupts are not asynchronous; they are delivered by Sim::advance()
+// as virtual time passes, which stepTimerPoll() does once per pass
+// through the realtime loop.
+
+#include "Driver/StepTimer.h"
+#include "Simulator.h"
+
+static bool (*timer_isr_callback)(void);
+
+static bool     timer_running = false;
+static uint32_t timer_ticks   = 0;  // Alarm period, reloaded after every interrupt
+static uint64_t next_alarm    = 0;  // Virtual time of the next interrupt
+static uint64_t virtual_now   = 0;
+
+namespace Sim {
+    uint32_t loopTicks = 20 * 50;  // 50 us at 20 MHz
+
+    uint64_t now() { return virtual_now; }
+
+    void advance(uint64_t ticks) {
+        uint64_t end = virtual_now + ticks;
+        while (timer_running && next_alarm <= end) {
+            virtual_now = next_alarm;
+            if (timer_isr_callback()) {
+                // Auto reload; the callback may have changed the period
+                next_alarm = virtual_now + timer_ticks;
+            } else {
+                timer_running = false;
+                timerStopped();
+            }
+        }
+        virtual_now = end;
+    }
+}
+
+void stepTimerStart() {
+    next_alarm    = virtual_now + 10;  // Interrupt very soon to start the stepping
+    timer_running = true;
+}
+
+void stepTimerSetTicks(uint32_t ticks) {
+    timer_ticks = ticks;
+    if (timer_running) {
+        Sim::segmentStart(ticks);
+    }
+}
+
+void stepTimerStop() {
+    if (timer_running) {
+        timer_running = false;
+        Sim::timerStopped();
+    }
+}
+
+void stepTimerInit(uint32_t frequency, bool (*callback)(void)) {
+    timer_running      = false;
+    timer_ticks        = 0;
+    timer_isr_callback = callback;
+}
+
+void stepTimerPoll() {
+    Sim::advance(Sim::loopTicks);
+}
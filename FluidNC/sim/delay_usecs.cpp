@@ -0,0 +1,30 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// CPU cycle counter derived from the simulator's virtual clock.  Busy-waits
+// cost no virtual time, so spinUntil() returns immediately instead of
+// waiting for a clock that only moves between main loop passes.
+
+#include "Driver/delay_usecs.h"
+#include "Simulator.h"
+
+static const uint32_t ticks_per_us     = 240;  // Nominal ESP32 CPU clock
+static const uint32_t cpu_ticks_per_st = 12;   // 240 MHz CPU / 20 MHz step timer
+
+void timing_init() {}
+
+void delay_us(int32_t us) {}
+
+int32_t usToCpuTicks(int32_t us) {
+    return us * ticks_per_us;
+}
+
+int32_t usToEndTicks(int32_t us) {
+    return getCpuTicks() + usToCpuTicks(us);
+}
+
+void spinUntil(int32_t endTicks) {}
+
+int32_t getCpuTicks() {
+    return int32_t(Sim::now() * cpu_ticks_per_st);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// GPIO for the simulator.  Outputs are remembered so that reading one back
+// gives what was written; inputs stay at their pulled level because nothing
+// outside the simulator drives them, so limit switches and probes never trip.
+
+#include "Driver/fluidnc_gpio.h"
+#include "src/Logging.h"  // Print <<
+
+#include <Print.h>
+
+static const pinnum_t nPins = 64;
+
+static bool levels[nPins];
+
+void gpio_write(pinnum_t pin, bool value) {
+    if (pin < nPins) {
+        levels[pin] = value;
+    }
+}
+
+void gpio_write_masks(uint64_t set, uint64_t clear) {
+    for (pinnum_t pin = 0; pin < nPins; ++pin) {
+        uint64_t bit = uint64_t(1) << pin;
+        if (set & bit) {
+            levels[pin] = true;
+        } else if (clear & bit) {
+            levels[pin] = false;
+        }
+    }
+}
+
+bool gpio_read(pinnum_t pin) {
+    return pin < nPins && levels[pin];
+}
+
+void gpio_mode(pinnum_t pin, bool input, bool output, bool pullup, bool pulldown, bool opendrain) {
+    if (pin < nPins && input && !output) {
+        levels[pin] = pullup;
+    }
+}
+
+void gpio_set_interrupt_type(pinnum_t pin, int mode) {}
+void gpio_add_interrupt(pinnum_t pin, int mode, void (*callback)(void*), void* arg) {}
+void gpio_remove_interrupt(pinnum_t pin) {}
+void gpio_route(pinnum_t pin, uint32_t signal) {}
+
+void gpio_dump(Print& out) {
+    for (pinnum_t pin = 0; pin < nPins; ++pin) {
+        if (levels[pin]) {
+            out << pin << " O1\n";
+        }
+    }
+}
+
+// Inputs never change, so there are no edges to dispatch
+void gpio_set_action(int gpio_num, gpio_dispatch_t action, void* arg, bool invert) {}
+void gpio_clear_action(int gpio_num) {}
+void poll_gpios() {}
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// Local file system for the simulator.  There is no flash partition, so
+// nothing is mounted and paths are only given their file system prefix.
+
+#include "Driver/localfs.h"
+
+#include <cstdio>
+#include <cstring>
+
+const char* localfsName = defaultLocalfsName;
+
+bool localfs_format(const char* fsname) {
+    return true;
+}
+
+bool localfs_mount() {
+    return true;
+}
+
+void localfs_unmount() {}
+
+std::uintmax_t localfs_size() {
+    return 0;
+}
+
+const char* canonicalPath(const char* filename, const char* defaultFs) {
+    static char path[128];
+    if (*filename == '/') {
+        strncpy(path, filename, sizeof(path) - 1);
+    } else {
+        snprintf(path, sizeof(path), "/%s/%s", *defaultFs ? defaultFs : localfsName, filename);
+    }
+    return path;
+}
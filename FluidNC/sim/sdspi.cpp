@@ -0,0 +1,17 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// The simulator has no SD card; jobs are read from the host file system
+
+#include "Driver/sdspi.h"
+
+bool sd_init_slot(uint32_t freq_hz, int cs_pin, int cd_pin, int wp_pin) {
+    return false;
+}
+
+void sd_unmount() {}
+void sd_deinit_slot() {}
+
+std::error_code sd_mount(int max_files) {
+    return std::make_error_code(std::errc::no_such_device);
+}
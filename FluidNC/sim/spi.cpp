@@ -0,0 +1,12 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+// The simulator has no SPI bus, so SPI devices fail to attach
+
+#include "Driver/spi.h"
+
+bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool dma) {
+    return false;
+}
+
+void spi_deinit_bus() {}
@@ -0,0 +1,78 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "BinaryReport.h"
+
+namespace {
+    class FrameWriter {
+    public:
+        FrameWriter(uint8_t* frame) : _p(frame), _start(frame) {}
+
+        void byte(uint8_t value) { *_p++ = value; }
+
+        // 7 bits per byte, low bits first, high bit set on all but the last byte
+        void varint(uint32_t value) {
+            while (value >= 0x80) {
+                *_p++ = uint8_t(value | 0x80);
+                value >>= 7;
+            }
+            *_p++ = uint8_t(value);
+        }
+
+        // Small differences of either sign take one byte
+        void delta(int32_t value, int32_t previous) {
+            auto difference = int32_t(uint32_t(value) - uint32_t(previous));
+            varint((uint32_t(difference) << 1) ^ uint32_t(difference >> 31));
+        }
+
+        void deltas(const int32_t* values, const int32_t* previous, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                delta(values[i], previous[i]);
+            }
+        }
+
+        size_t length() const { return _p - _start; }
+
+    private:
+        uint8_t* _p;
+        uint8_t* _start;
+    };
+}
+
+size_t BinaryReport::encode(const Sample& sample, uint8_t* frame) {
+    bool keyframe = _sinceKeyframe >= keyframeInterval || sample.n_axis != _last.n_axis || sample.hasBelts != _last.hasBelts;
+
+    // A keyframe is the difference from all zeros
+    static const Sample zero = {};
+    const Sample&       last = keyframe ? zero : _last;
+
+    FrameWriter out(frame);
+    out.byte(magic);
+    out.byte((keyframe ? Keyframe : 0) | (sample.hasBelts ? Belts : 0));
+    out.byte(_sequence++);
+    out.byte(sample.n_axis);
+    out.varint(sample.time - last.time);
+
+    out.delta(sample.state, last.state);
+    out.deltas(sample.mpos, last.mpos, sample.n_axis);
+    out.deltas(sample.wco, last.wco, sample.n_axis);
+    out.delta(sample.feed, last.feed);
+    out.delta(sample.spindle, last.spindle);
+    out.delta(sample.feedOverride, last.feedOverride);
+    out.delta(sample.rapidOverride, last.rapidOverride);
+    out.delta(sample.spindleOverride, last.spindleOverride);
+    out.delta(sample.accessories, last.accessories);
+    out.delta(sample.plannerAvailable, last.plannerAvailable);
+    out.delta(sample.rxAvailable, last.rxAvailable);
+    out.delta(sample.lineNumber, last.lineNumber);
+    out.delta(sample.limits, last.limits);
+    out.delta(sample.probe, last.probe);
+    if (sample.hasBelts) {
+        out.deltas(sample.belt, last.belt, beltCount);
+        out.deltas(sample.current, last.current, beltCount);
+    }
+
+    _sinceKeyframe = keyframe ? 1 : _sinceKeyframe + 1;
+    _last          = sample;
+    return out.length();
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  BinaryReport packs the values of a realtime status report, and on Maslow
+  the belt lengths and motor currents, into a small binary frame for clients
+  that chart machine data at a high rate.  $Report/Binary=<ms> turns the frames
+  on for a WebSocket channel; they are sent as binary messages of their own,
+  so they do not pass through the text buffer or the command stream.
+
+  Frame layout:
+    0xFE                 never starts a UTF-8 text message
+    flags                Keyframe, Belts
+    sequence             uint8, wraps
+    n_axis               uint8
+    varint time          ms since the previous frame, or millis() in a keyframe
+    zigzag varint fields difference from the previous frame, or the value in a keyframe:
+      state, mpos[n_axis] (um), wco[n_axis] (um), feed (mm/min), spindle (rpm),
+      feed/rapid/spindle overrides (%), accessories (Accessory bits),
+      planner blocks available, rx bytes available, line number,
+      limits (motor mask), probe
+      belts only: belt lengths TL,TR,BL,BR (um), motor currents TL,TR,BL,BR
+
+  A client that misses a frame, which it sees from the sequence number, waits
+  for the next keyframe.  Keyframes are sent when the frames are turned on and
+  then every keyframeInterval frames.
+*/
+
+#include "Config.h"  // MAX_N_AXIS
+
+#include <cstddef>
+#include <cstdint>
+
+class BinaryReport {
+public:
+    static const uint8_t magic            = 0xFE;
+    static const int     keyframeInterval = 50;
+    static const int     beltCount        = 4;
+
+    enum Flags : uint8_t {
+        Keyframe = 1 << 0,
+        Belts    = 1 << 1,
+    };
+
+    enum Accessory : uint8_t {
+        SpindleCw  = 1 << 0,
+        SpindleCcw = 1 << 1,
+        Flood      = 1 << 2,
+        Mist       = 1 << 3,
+    };
+
+    // Values are scaled to integers by the caller
+    struct Sample {
+        uint32_t time;  // ms
+        uint8_t  n_axis;
+        bool     hasBelts;
+        int32_t  state;
+        int32_t  mpos[MAX_N_AXIS];
+        int32_t  wco[MAX_N_AXIS];
+        int32_t  feed;
+        int32_t  spindle;
+        int32_t  feedOverride;
+        int32_t  rapidOverride;
+        int32_t  spindleOverride;
+        int32_t  accessories;
+        int32_t  plannerAvailable;
+        int32_t  rxAvailable;
+        int32_t  lineNumber;
+        int32_t  limits;
+        int32_t  probe;
+        int32_t  belt[beltCount];
+        int32_t  current[beltCount];
+    };
+
+    // Large enough for a keyframe with every field at its longest
+    static const size_t maxLength = 5 + 5 + 5 * (12 + 2 * MAX_N_AXIS + 2 * beltCount);
+
+    // The next frame will be a keyframe
+    void restart() { _sinceKeyframe = keyframeInterval; }
+
+    // Builds the frame for sample into frame, which has room for maxLength
+    // bytes, and returns its length
+    size_t encode(const Sample& sample, uint8_t* frame);
+
+private:
+    Sample  _last;
+    uint8_t _sequence      = 0;
+    int     _sinceKeyframe = keyframeInterval;
+};
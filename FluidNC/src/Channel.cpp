@@ -145,6 +145,7 @@ Channel* Channel::pollLine(char* line) {
         }
     }
     autoReport();
+    autoReportBinary();
     return nullptr;
 }
 
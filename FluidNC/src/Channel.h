@@ -22,6 +22,7 @@
 #include <Stream.h>
 #include <freertos/FreeRTOS.h>  // TickType_T
 #include <queue>
+#include <atomic>
 
 class Channel : public Stream {
 public:
@@ -50,6 +51,8 @@ protected:
     bool       _reportWco = true;
     CoordIndex _reportNgc = CoordIndex::End;
 
+    std::atomic<bool> _stopped { false };
+
 public:
     Channel(const char* name, bool addCR = false) : _name(name), _linelen(0), _addCR(addCR) {}
     virtual ~Channel() = default;
@@ -87,6 +90,12 @@ public:
 
     virtual void stopJob() {}
 
+    // stop() is used when a channel ends on an error, such as a file job whose
+    // line failed.  The main loop then drops the lines that the channel has
+    // already queued, instead of executing them.
+    void stop() { _stopped = true; }
+    bool stopped() { return _stopped; }
+
     size_t timedReadBytes(uint8_t* buffer, size_t length, TickType_t timeout) { return timedReadBytes((char*)buffer, length, timeout); }
 
     bool setCr(bool on) {
@@ -105,5 +114,13 @@ public:
     uint32_t setReportInterval(uint32_t ms);
     uint32_t getReportInterval() { return _reportInterval; }
     void     autoReport();
-    void     autoReportGCodeState();
+
+    // Channels that can send binary frames override these; see BinaryReport.h.
+    // setBinaryReportInterval() returns the interval in use, or 0 if binary
+    // reports are off or not supported.
+    virtual uint32_t setBinaryReportInterval(uint32_t ms) { return 0; }
+    virtual uint32_t getBinaryReportInterval() { return 0; }
+    virtual void     autoReportBinary() {}
+
+    void autoReportGCodeState();
 };
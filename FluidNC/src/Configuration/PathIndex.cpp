@@ -0,0 +1,108 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "PathIndex.h"
+
+#include "Configurable.h"
+
+#include <cctype>
+
+namespace Configuration {
+    std::unordered_map<std::string, Configurable*> PathIndex::_sections;
+    Configurable*                                  PathIndex::_root = nullptr;
+    std::mutex                                     PathIndex::_mutex;
+
+    namespace {
+        // Walks the tree the way RuntimeSetting does, recording each section under its path
+        class Indexer : public HandlerBase {
+            std::unordered_map<std::string, Configurable*>& _sections;
+            std::string                                     _path;
+
+        protected:
+            void enterSection(const char* name, Configurable* value) override {
+                auto length = _path.length();
+                if (length) {
+                    _path += '/';
+                }
+                for (auto p = name; *p; ++p) {
+                    _path += char(tolower(*p));
+                }
+                _sections[_path] = value;
+                value->group(*this);
+                _path.resize(length);
+            }
+            bool        matchesUninitialized(const char* name) override { return false; }
+            HandlerType handlerType() override { return HandlerType::Runtime; }
+
+        public:
+            Indexer(std::unordered_map<std::string, Configurable*>& sections) : _sections(sections) {}
+
+            void item(const char* name, bool& value) override {}
+            void item(const char* name, int32_t& value, int32_t minValue, int32_t maxValue) override {}
+            void item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) override {}
+            void item(const char* name, float& value, float minValue, float maxValue) override {}
+            void item(const char* name, std::vector<speedEntry>& value) override {}
+            void item(const char* name, UartData& wordLength, UartParity& parity, UartStop& stopBits) override {}
+            void item(const char* name, std::string& value, int minLength, int maxLength) override {}
+            void item(const char* name, Pin& value) override {}
+            void item(const char* name, IPAddress& value) override {}
+            void item(const char* name, int& value, EnumItem* e) override {}
+        };
+    }
+
+    void PathIndex::index(Configurable* root) {
+        _sections.clear();
+        _root = root;
+        if (root) {
+            _sections[""] = root;
+            Indexer indexer(_sections);
+            root->group(indexer);
+        }
+    }
+
+    void PathIndex::build(Configurable* root) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        index(root);
+    }
+
+    void PathIndex::invalidate() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sections.clear();
+        _root = nullptr;
+    }
+
+    Configurable* PathIndex::find(Configurable* root, const char* path, const char*& leaf) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (root != _root) {
+            index(root);
+        }
+
+        while (*path == '/') {
+            ++path;
+        }
+        std::string key;
+        for (auto p = path; *p; ++p) {
+            key += char(tolower(*p));
+        }
+        while (!key.empty() && key.back() == '/') {
+            key.pop_back();
+        }
+        if (key.empty()) {
+            return nullptr;
+        }
+
+        auto it = _sections.find(key);
+        if (it != _sections.end()) {
+            leaf = nullptr;
+            return it->second;
+        }
+
+        auto slash = key.rfind('/');
+        it         = _sections.find(slash == std::string::npos ? std::string() : key.substr(0, slash));
+        if (it == _sections.end()) {
+            return nullptr;
+        }
+        leaf = slash == std::string::npos ? path : path + slash + 1;
+        return it->second;
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Configuration {
+    class Configurable;
+
+    // PathIndex maps the full path of every section of the configuration tree,
+    // like axes/x/motor0, to the section itself, so that a $/ setting is
+    // resolved with one hash lookup and a walk of the one section that holds
+    // it, instead of a walk of the whole tree.
+    //
+    // Only sections are indexed.  Items are left to the section's group(),
+    // because some group() functions hand out temporaries or list items
+    // conditionally, so a pointer to an item's value is not stable.  Sections
+    // are only created while parsing and in afterParse(), so the index is
+    // built once the tree is complete and dropped when it is replaced.
+    class PathIndex {
+    public:
+        // Indexes the tree under root, replacing any previous index
+        static void build(Configurable* root);
+
+        // Forgets the index, as when the tree it points into is deleted
+        static void invalidate();
+
+        // Resolves path, ignoring case and leading or trailing slashes.  If the
+        // path names a section, returns it with leaf null.  Otherwise returns
+        // the section that would hold it, with leaf pointing to the last
+        // component of path, or null if there is no such section.
+        static Configurable* find(Configurable* root, const char* path, const char*& leaf);
+
+        static size_t size() { return _sections.size(); }
+
+    private:
+        static std::unordered_map<std::string, Configurable*> _sections;
+        static Configurable*                                  _root;
+        static std::mutex                                     _mutex;
+
+        static void index(Configurable* root);
+    };
+}
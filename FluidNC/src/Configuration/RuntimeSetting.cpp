@@ -2,6 +2,7 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "RuntimeSetting.h"
+#include "PathIndex.h"
 
 #include "../Report.h"
 #include "../Protocol.h"  // send_line()
@@ -27,6 +28,32 @@ namespace Configuration {
         return s;
     }
 
+    void RuntimeSetting::handle(Configuration::Configurable* root) {
+        const char* leaf;
+        auto        section = PathIndex::find(root, setting_, leaf);
+        if (section == nullptr) {
+            return;
+        }
+        if (leaf == nullptr) {
+            showSection(section);
+            return;
+        }
+        start_ = leaf;
+        section->group(*this);
+        start_ = setting_;
+    }
+
+    void RuntimeSetting::showSection(Configuration::Configurable* value) {
+        if (newValue_ == nullptr) {
+            log_to(out_, "/", setting_ << ":");
+            Configuration::Generator generator(out_, 1);
+            value->group(generator);
+            isHandled_ = true;
+        } else {
+            log_error("Can't set a value on a section");
+        }
+    }
+
     void RuntimeSetting::enterSection(const char* name, Configuration::Configurable* value) {
         if (is(name) && !isHandled_) {
             auto previous = start_;
@@ -43,14 +70,7 @@ namespace Configuration {
                 // Handle child:
                 value->group(*this);
             } else {
-                if (newValue_ == nullptr) {
-                    log_to(out_, "/", setting_ << ":");
-                    Configuration::Generator generator(out_, 1);
-                    value->group(generator);
-                    isHandled_ = true;
-                } else {
-                    log_error("Can't set a value on a section");
-                }
+                showSection(value);
             }
 
             // Restore situation:
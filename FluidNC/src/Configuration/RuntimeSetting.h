@@ -26,6 +26,8 @@ namespace Configuration {
             }
         }
 
+        void showSection(Configuration::Configurable* value);
+
     protected:
         void enterSection(const char* name, Configuration::Configurable* value) override;
         bool matchesUninitialized(const char* name) override { return false; }
@@ -33,6 +35,9 @@ namespace Configuration {
     public:
         RuntimeSetting(const char* key, const char* value, Channel& out);
 
+        // Finds the setting through the PathIndex and visits only the section that holds it
+        void handle(Configuration::Configurable* root);
+
         void item(const char* name, bool& value) override;
         void item(const char* name, int32_t& value, int32_t minValue, int32_t maxValue) override;
         void item(const char* name, uint32_t& value, uint32_t minValue, uint32_t maxValue) override;
@@ -5,6 +5,7 @@
 
 #include "Protocol.h"        // *Event
 #include "Machine/Macros.h"  // macro0Event
+#include "Report.h"          // addPinReport
 
 Control::Control() {
     // The SafetyDoor pin must be defined first because it is checked explicity in safety_door_ajar()
@@ -40,6 +41,14 @@ std::string Control::report_status() {
     return ret;
 }
 
+void Control::report_status(char* status) {
+    for (auto pin : _pins) {
+        if (pin->get()) {
+            addPinReport(status, pin->letter());
+        }
+    }
+}
+
 bool Control::stuck() {
     for (auto pin : _pins) {
         if (pin->get()) {
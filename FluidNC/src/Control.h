@@ -24,6 +24,7 @@ public:
     bool safety_door_ajar();
 
     std::string report_status();
+    void        report_status(char* status);  // Appends the letters of the active pins
 
     bool startup_check();
 
@@ -47,6 +47,7 @@ std::map<Error, const char*> ErrorNames = {
     { Error::GcodeMaxValueExceeded, "Gcode max value exceeded" },
     { Error::PParamMaxExceeded, "P param max exceeded" },
     { Error::CheckControlPins, "Check control pins" },
+    { Error::GcodeSplinePlane, "Gcode spline needs the XY plane" },
     { Error::FsFailedMount, "Failed to mount device" },
     { Error::FsFailedRead, "Read failed" },
     { Error::FsFailedOpenDir, "Failed to open directory" },
@@ -73,4 +74,7 @@ std::map<Error, const char*> ErrorNames = {
     { Error::ConfigurationInvalid, "Configuration is invalid. Check boot messages for ERR's." },
     { Error::UploadFailed, "File Upload Failed" },
     { Error::DownloadFailed, "File Download Failed" },
+    { Error::JobUnsupportedCommand, "Command cannot be compiled into a job" },
+    { Error::JobInvalid, "Compiled job is invalid or from another firmware" },
+    { Error::JobStartMismatch, "Compiled job does not match the work offsets or position" },
 };
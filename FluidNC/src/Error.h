@@ -51,6 +51,7 @@ enum class Error : uint8_t {
     GcodeMaxValueExceeded       = 38,
     PParamMaxExceeded           = 39,
     CheckControlPins            = 40,
+    GcodeSplinePlane            = 41,
     FsFailedMount               = 60,  // Filesystem failed to mount
     FsFailedRead                = 61,  // Failed to read file
     FsFailedOpenDir             = 62,  // Failed to open directory
@@ -78,6 +79,9 @@ enum class Error : uint8_t {
     ConfigurationInvalid        = 152,
     UploadFailed                = 160,
     DownloadFailed              = 161,
+    JobUnsupportedCommand       = 170,
+    JobInvalid                  = 171,
+    JobStartMismatch            = 172,
 };
 
 const char* errorString(Error errorNumber);
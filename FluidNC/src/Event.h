@@ -3,13 +3,26 @@
 
 #pragma once
 
+#include <cstdint>
+
+// Control events are run in order, before any Normal event that is waiting;
+// see EventQueue.h
+enum class EventPriority : uint8_t {
+    Control = 0,
+    Normal = 1,
+};
+
 // Objects derived from the Event base class are placed in the event queue.
 // Protocol dequeues them and calls their run methods.
 class Event {
+    EventPriority _priority;
+
 public:
-    Event() {}
+    Event(EventPriority priority = EventPriority::Normal) : _priority(priority) {}
     virtual void run(void* arg) = 0;
 
+    EventPriority priority() const { return _priority; }
+
     virtual ~Event() {}
 };
 
@@ -17,7 +30,7 @@ class NoArgEvent : public Event {
     void (*_function)() = nullptr;
 
 public:
-    NoArgEvent(void (*function)()) : _function(function) {}
+    NoArgEvent(void (*function)(), EventPriority priority = EventPriority::Normal) : Event(priority), _function(function) {}
 
     void run(void* arg) override {
         if (_function) {
@@ -30,7 +43,7 @@ class ArgEvent : public Event {
     void (*_function)(void*) = nullptr;
 
 public:
-    ArgEvent(void (*function)(void*)) : _function(function) {}
+    ArgEvent(void (*function)(void*), EventPriority priority = EventPriority::Normal) : Event(priority), _function(function) {}
 
     void run(void* arg) override {
         if (_function) {
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "EventQueue.h"
+
+#include <esp_attr.h>   // IRAM_ATTR
+#include <esp_timer.h>  // esp_timer_get_time
+
+EventQueue eventQueue;
+
+// The queue is shared by tasks on both cores and by interrupt handlers
+void IRAM_ATTR EventQueue::lock() {
+    if (xPortInIsrContext()) {
+        portENTER_CRITICAL_ISR(&_mux);
+    } else {
+        portENTER_CRITICAL(&_mux);
+    }
+}
+
+void IRAM_ATTR EventQueue::unlock() {
+    if (xPortInIsrContext()) {
+        portEXIT_CRITICAL_ISR(&_mux);
+    } else {
+        portEXIT_CRITICAL(&_mux);
+    }
+}
+
+bool IRAM_ATTR EventQueue::send(Event* event, void* arg) {
+    uint32_t now   = uint32_t(esp_timer_get_time());
+    int      index = int(event->priority());
+    Lane&    lane  = _lanes[index];
+    bool     sent  = true;
+
+    lock();
+    Entry* newest = lane.count ? &lane.entries[(lane.head + lane.count - 1) % depth(index)] : nullptr;
+    if (newest && newest->event == event && newest->arg == arg && newest->count < UINT16_MAX) {
+        ++newest->count;
+        ++lane.stats.sent;
+        ++lane.stats.coalesced;
+    } else if (lane.count < depth(index)) {
+        lane.entries[(lane.head + lane.count) % depth(index)] = { event, arg, now, 1 };
+        ++lane.count;
+        ++lane.stats.sent;
+        if (lane.count > lane.stats.highWater) {
+            lane.stats.highWater = lane.count;
+        }
+    } else {
+        ++lane.stats.dropped;
+        sent = false;
+    }
+    unlock();
+    return sent;
+}
+
+bool EventQueue::dispatch() {
+    Entry entry;
+    bool  found = false;
+
+    lock();
+    for (int index = 0; index < lanes; index++) {
+        Lane& lane = _lanes[index];
+        if (lane.count) {
+            entry     = lane.entries[lane.head];
+            lane.head = (lane.head + 1) % depth(index);
+            --lane.count;
+
+            uint32_t latency = uint32_t(esp_timer_get_time()) - entry.time;
+            ++lane.stats.dispatched;
+            lane.stats.sumLatency += latency;
+            if (latency > lane.stats.maxLatency) {
+                lane.stats.maxLatency = latency;
+            }
+            found = true;
+            break;
+        }
+    }
+    unlock();
+
+    // Run outside the lock, because events can send other events
+    if (found) {
+        for (int i = 0; i < entry.count; i++) {
+            entry.event->run(entry.arg);
+        }
+    }
+    return found;
+}
+
+EventQueue::LaneStats EventQueue::stats(EventPriority priority, bool reset) {
+    Lane& lane = _lanes[int(priority)];
+    lock();
+    LaneStats stats = lane.stats;
+    if (reset) {
+        lane.stats = LaneStats();
+    }
+    unlock();
+    return stats;
+}
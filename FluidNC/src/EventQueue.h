@@ -0,0 +1,79 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// EventQueue carries Events from the tasks and interrupt handlers that detect
+// them to the main loop, which runs them.
+//
+// Control events - everything that changes the machine state, like cycle start
+// and stop, feed hold, safety door, motion cancel, reset, sleep and limits -
+// share a lane of their own that is always emptied first, so a burst of
+// overrides or macros cannot delay or crowd out a feed hold.  They must share
+// one lane because their order matters: a cycle start followed by a feed hold
+// has to leave the machine held.  An event that is sent again
+// while it is the newest one in its lane, like repeated presses of an override
+// key, is coalesced: the entry counts the repeats and the event is run that many
+// times, so nothing is lost and a burst needs only one entry.  An event that
+// finds its lane full is dropped and counted.
+
+#include "Event.h"
+
+#include <freertos/FreeRTOS.h>  // portMUX_TYPE
+#include <cstdint>
+
+class EventQueue {
+public:
+    static const int lanes = 2;
+
+    struct LaneStats {
+        uint32_t sent       = 0;  // Events accepted, including coalesced ones
+        uint32_t coalesced  = 0;  // Events added to the previous entry instead of a new one
+        uint32_t dropped    = 0;  // Events lost because the lane was full
+        uint32_t dispatched = 0;  // Entries taken by the main loop
+        uint32_t maxLatency = 0;  // us from the first send to dispatch
+        uint64_t sumLatency = 0;  // us, over all dispatched entries
+        uint8_t  highWater  = 0;  // Most entries waiting at once
+    };
+
+    // Safe to call from tasks and from interrupt handlers
+    bool send(Event* event, void* arg);
+
+    // Main loop: runs the oldest entry of the first lane that has one,
+    // and returns false if there was none
+    bool dispatch();
+
+    // Returns the counters, and clears them if reset is true
+    LaneStats stats(EventPriority lane, bool reset);
+
+private:
+    // Control events are few and rarely repeat; overrides, macros and pin events
+    // arrive in bursts from pendants and UIs.  The depths are not in a table
+    // because send() runs in interrupt handlers, which cannot read flash.
+    static const int controlDepth = 16;
+    static const int maxDepth     = 32;
+
+    static constexpr int depth(int lane) { return lane == int(EventPriority::Control) ? controlDepth : maxDepth; }
+
+    struct Entry {
+        Event*   event;
+        void*    arg;
+        uint32_t time;   // us, when the entry was made
+        uint16_t count;  // Times to run the event
+    };
+
+    struct Lane {
+        Entry     entries[maxDepth];
+        uint8_t   head  = 0;  // Oldest entry
+        uint8_t   count = 0;
+        LaneStats stats;
+    };
+
+    Lane         _lanes[lanes];
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    void lock();
+    void unlock();
+};
+
+extern EventQueue eventQueue;
@@ -4,7 +4,6 @@
 #include "FileStream.h"
 #include "Machine/MachineConfig.h"  // config->
 #include "Driver/localfs.h"
-#include "./Maslow/Maslow.h"
 
 std::string FileStream::path() {
     return _fpath.c_str();
@@ -19,10 +18,8 @@ int FileStream::available() {
 }
 
 int FileStream::read() {
-    Maslow.readingFromSD = true;
     char   data;
     size_t res = fread(&data, 1, 1, _fd);
-    Maslow.readingFromSD = false;
     return res == 1 ? data : -1;
 }
 
@@ -33,23 +30,17 @@ int FileStream::peek() {
 void FileStream::flush() {}
 
 size_t FileStream::read(char* buffer, size_t length) {
-    Maslow.readingFromSD = true;
     size_t res = fread(buffer, 1, length, _fd);
-    Maslow.readingFromSD = false;
     return res;
 }
 
 size_t FileStream::write(uint8_t c) {
-    Maslow.readingFromSD = true;
     size_t res = FileStream::write(&c, 1);
-    Maslow.readingFromSD = false;
     return res;
 }
 
 size_t FileStream::write(const uint8_t* buffer, size_t length) {
-    Maslow.readingFromSD = true;
     size_t res = fwrite(buffer, 1, length, _fd);
-    Maslow.readingFromSD = false;
     return res;
 }
 
@@ -61,6 +52,10 @@ size_t FileStream::position() {
     return ftell(_fd);
 }
 
+bool FileStream::set_position(size_t pos) {
+    return fseek(_fd, pos, SEEK_SET) == 0;
+}
+
 void FileStream::setup(const char* mode) {
     _fd = fopen(_fpath.c_str(), mode);
 
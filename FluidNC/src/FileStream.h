@@ -33,6 +33,7 @@ public:
     FluidPath fpath() { return _fpath; }
 
     std::string path();
+    const char* c_path() { return _fpath.c_str(); }  // path() without making a copy
     std::string name();
     int         available() override;
     int         read() override;
@@ -49,6 +50,7 @@ public:
 
     size_t size();
     size_t position();
+    bool   set_position(size_t pos);
 
     // pollLine() is a required method of the Channel class that
     // FileStream implements as a no-op.
@@ -71,8 +71,10 @@ FluidPath::~FluidPath() {
     }
 }
 
+// Called after this path was written, renamed or deleted, so it is always hashed again
 void FluidPath::rehash_fs() {
     if (!_isSD) {
+        HashFS::forget(*this);
         HashFS::rehash();
     }
 }
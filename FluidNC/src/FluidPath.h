@@ -26,6 +26,8 @@ public:
     // /localfs/foo -> true,  /localfs -> false
     bool hasTail() { return ++(++begin()) != end(); }
 
+    bool isSD() { return _isSD; }
+
     void rehash_fs();
 
 private:
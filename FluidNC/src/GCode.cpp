@@ -14,6 +14,8 @@
 #include "MotionControl.h"        // mc_override_ctrl_update
 #include "Machine/UserOutputs.h"  // setAnalogPercent
 #include "Platform.h"             // WEAK_LINK
+#include "Job.h"                  // job_compiling()
+#include "Spline.h"               // CubicSpline
 
 #include "Machine/MachineConfig.h"
 
@@ -37,9 +39,15 @@ parser_block_t gc_block;
 
 #define FAIL(status) return (status);
 
+// A G5 without I and J continues the previous G5 smoothly, using the
+// reflection of its second control point as the first control point.
+static bool  splineContinues = false;
+static float splineControl[2];  // Absolute second control point of the last G5
+
 void gc_init() {
     // Reset parser state:
     memset(&gc_state, 0, sizeof(parser_state_t));
+    splineContinues = false;
 
     // Load default G54 coordinate system.
     gc_state.modal.coord_select = CoordIndex::G54;
@@ -47,6 +55,14 @@ void gc_init() {
     coords[gc_state.modal.coord_select]->get(gc_state.coord_system);
 }
 
+void gc_set_spline_control(const float* control) {
+    splineContinues = control != nullptr;
+    if (splineContinues) {
+        splineControl[0] = control[0];
+        splineControl[1] = control[1];
+    }
+}
+
 // Sets g-code parser position in mm. Input in steps. Called by the system abort and hard
 // limit pull-off routines.
 void gc_sync_position() {
@@ -172,6 +188,10 @@ Error gc_execute_line(char* line) {
     bool syncLaser     = false;
     bool disableLaser  = false;
     bool laserIsMotion = false;
+    bool negativeP     = false;  // Allowed only for G5
+
+    float splineFirst[2];   // Absolute control points for mc_spline
+    float splineSecond[2];
 
     auto    n_axis = config->_axes->_numberAxis;
     float   coord_data[MAX_N_AXIS];  // Used by WCO-related commands
@@ -300,6 +320,22 @@ Error gc_execute_line(char* line) {
                         gc_block.modal.motion = Motion::CcwArc;
                         mg_word_bit           = ModalGroup::MG1;
                         break;
+                    case 5:  // G5 - cubic spline, G5.1 - quadratic spline
+                        axis_command = AxisCommand::MotionMode;
+                        switch (mantissa) {
+                            case 0:
+                                gc_block.modal.motion = Motion::CubicSpline;
+                                break;
+                            case 10:
+                                gc_block.modal.motion = Motion::QuadraticSpline;
+                                break;
+                            default:
+                                FAIL(Error::GcodeUnsupportedCommand);
+                                break;  // [G5.2 NURBS not supported]
+                        }
+                        mantissa    = 0;  // Set to zero to indicate valid non-integer G command.
+                        mg_word_bit = ModalGroup::MG1;
+                        break;
                     case 38:  // G38 - probe
                         //only allow G38 "Probe" commands if a probe pin is defined.
                         if (!config->_probe->exists()) {
@@ -733,7 +769,10 @@ Error gc_execute_line(char* line) {
                 if (bitmask & (bitnum_to_mask(GCodeWord::F) | bitnum_to_mask(GCodeWord::N) | bitnum_to_mask(GCodeWord::P) |
                                bitnum_to_mask(GCodeWord::T) | bitnum_to_mask(GCodeWord::S))) {
                     if (value < 0.0) {
-                        FAIL(Error::NegativeValue);  // [Word value cannot be negative]
+                        if (letter != 'P') {
+                            FAIL(Error::NegativeValue);  // [Word value cannot be negative]
+                        }
+                        negativeP = true;  // Checked once the motion mode is known
                     }
                 }
                 value_words |= bitmask;  // Flag to indicate parameter assigned.
@@ -772,6 +811,10 @@ Error gc_execute_line(char* line) {
             axis_command = AxisCommand::MotionMode;  // Assign implicit motion-mode
         }
     }
+    // P is an offset that can be negative only in G5.
+    if (negativeP && !(axis_command == AxisCommand::MotionMode && gc_block.modal.motion == Motion::CubicSpline)) {
+        FAIL(Error::NegativeValue);  // [Word value cannot be negative]
+    }
     // Check for valid line number N value.
     if (bitnum_is_true(value_words, GCodeWord::N)) {
         // Line number value cannot be less than zero (done) or greater than max line number.
@@ -1272,6 +1315,52 @@ Error gc_execute_line(char* line) {
                     }
                     clear_bitnum(value_words, GCodeWord::P);
                     break;
+                case Motion::CubicSpline:
+                case Motion::QuadraticSpline: {
+                    // [G5/G5.1 Errors]: Feed rate undefined. Plane is not G17. No axis words.
+                    // [G5 Errors]: P or Q missing. Only one of I and J. I and J missing, except right after another G5,
+                    //   whose second control point is then reflected through the current point.
+                    // [G5.1 Errors]: I and J both missing.
+                    // NOTE: I,J are offsets from the current point to the first control point and P,Q from the target
+                    //   to the second. G5.1 I,J is the one control point, converted to the equivalent cubic ones.
+                    if (gc_block.modal.plane_select != Plane::XY) {
+                        FAIL(Error::GcodeSplinePlane);  // [Not G17]
+                    }
+                    if (!axis_words) {
+                        FAIL(Error::GcodeNoAxisWords);  // [No axis words]
+                    }
+                    size_t ij_words  = ijk_words & (bitnum_to_mask(X_AXIS) | bitnum_to_mask(Y_AXIS));
+                    bool   bothIJ    = ij_words == (bitnum_to_mask(X_AXIS) | bitnum_to_mask(Y_AXIS));
+                    float  scale     = gc_block.modal.units == Units::Inches ? MM_PER_INCH : 1.0f;
+                    float  start[2]  = { gc_state.position[X_AXIS], gc_state.position[Y_AXIS] };
+                    float  end[2]    = { gc_block.values.xyz[X_AXIS], gc_block.values.xyz[Y_AXIS] };
+                    float  offset[2] = { gc_block.values.ijk[X_AXIS] * scale, gc_block.values.ijk[Y_AXIS] * scale };
+                    if (gc_block.modal.motion == Motion::CubicSpline) {
+                        if (bitnum_is_false(value_words, GCodeWord::P) || bitnum_is_false(value_words, GCodeWord::Q)) {
+                            FAIL(Error::GcodeValueWordMissing);  // [P or Q missing]
+                        }
+                        if (bothIJ) {
+                            splineFirst[0] = start[0] + offset[0];
+                            splineFirst[1] = start[1] + offset[1];
+                        } else if (!ij_words && splineContinues) {
+                            splineFirst[0] = 2 * start[0] - splineControl[0];
+                            splineFirst[1] = 2 * start[1] - splineControl[1];
+                        } else {
+                            FAIL(Error::GcodeValueWordMissing);  // [I or J missing]
+                        }
+                        splineSecond[0] = end[0] + gc_block.values.p * scale;
+                        splineSecond[1] = end[1] + gc_block.values.q * scale;
+                        clear_bits(value_words, (bitnum_to_mask(GCodeWord::P) | bitnum_to_mask(GCodeWord::Q)));
+                    } else {
+                        if (!ij_words) {
+                            FAIL(Error::GcodeValueWordMissing);  // [I and J missing]
+                        }
+                        float control[2] = { start[0] + offset[0], start[1] + offset[1] };
+                        CubicSpline::fromQuadratic(start, control, end, splineFirst, splineSecond);
+                    }
+                    clear_bits(value_words, (bitnum_to_mask(GCodeWord::I) | bitnum_to_mask(GCodeWord::J)));
+                    break;
+                }
                 case Motion::ProbeTowardNoError:
                 case Motion::ProbeAwayNoError:
                     probeNoError = true;  // No break intentional.
@@ -1359,9 +1448,11 @@ Error gc_execute_line(char* line) {
     // If in laser mode, setup laser power based on current and past parser conditions.
     if (spindle->isRateAdjusted()) {
         bool blockIsFeedrateMotion = (gc_block.modal.motion == Motion::Linear) || (gc_block.modal.motion == Motion::CwArc) ||
-                                     (gc_block.modal.motion == Motion::CcwArc);
+                                     (gc_block.modal.motion == Motion::CcwArc) || (gc_block.modal.motion == Motion::CubicSpline) ||
+                                     (gc_block.modal.motion == Motion::QuadraticSpline);
         bool stateIsFeedrateMotion = (gc_state.modal.motion == Motion::Linear) || (gc_state.modal.motion == Motion::CwArc) ||
-                                     (gc_state.modal.motion == Motion::CcwArc);
+                                     (gc_state.modal.motion == Motion::CcwArc) || (gc_state.modal.motion == Motion::CubicSpline) ||
+                                     (gc_state.modal.motion == Motion::QuadraticSpline);
 
         if (!blockIsFeedrateMotion) {
             // If the new mode is not a feedrate move (G1/2/3) we want the laser off
@@ -1394,6 +1485,30 @@ Error gc_execute_line(char* line) {
             }
         }
     }
+    // While a job is being compiled, blocks that only move are recorded for job_run() to plan
+    // directly, and the text of the other blocks is recorded for job_run() to parse.
+    bool jobMotion = false;
+    if (job_compiling()) {
+        bool plainMotion = (gc_block.modal.motion == Motion::Seek) || (gc_block.modal.motion == Motion::Linear) ||
+                           (gc_block.modal.motion == Motion::CwArc) || (gc_block.modal.motion == Motion::CcwArc) ||
+                           (gc_block.modal.motion == Motion::CubicSpline) || (gc_block.modal.motion == Motion::QuadraticSpline);
+        // Check mode does not stop these from changing settings and outputs, and the
+        // position after a probe cannot be known in advance.
+        if ((gc_block.non_modal_command == NonModal::SetCoordinateData) || (gc_block.non_modal_command == NonModal::SetHome0) ||
+            (gc_block.non_modal_command == NonModal::SetHome1) || (gc_block.modal.tool_change == ToolChange::Enable) ||
+            (gc_block.modal.io_control != gc_state.modal.io_control) || (axis_command == AxisCommand::MotionMode && !plainMotion)) {
+            FAIL(Error::JobUnsupportedCommand);
+        }
+        jobMotion = plainMotion && (axis_command == AxisCommand::MotionMode) &&
+                    (gc_block.non_modal_command == NonModal::NoAction || gc_block.non_modal_command == NonModal::AbsoluteOverride) &&
+                    (gc_block.coolant == GCodeCoolant::None) && (gc_block.modal.spindle == gc_state.modal.spindle) &&
+                    (gc_block.modal.program_flow == ProgramFlow::Running) && (gc_block.modal.override == gc_state.modal.override) &&
+                    (gc_block.modal.coord_select == gc_state.modal.coord_select) &&
+                    (laserIsMotion || ((gc_state.spindle_speed == gc_block.values.s) && !syncLaser));
+        if (!jobMotion) {
+            job_record_block(line);
+        }
+    }
     // [0. Non-specific/common error-checks and miscellaneous setup]:
     // NOTE: If no line number is present, the value is zero.
     gc_state.line_number = gc_block.values.n;
@@ -1597,12 +1712,30 @@ Error gc_execute_line(char* line) {
     if (gc_state.modal.motion != Motion::None) {
         if (axis_command == AxisCommand::MotionMode) {
             GCUpdatePos gc_update_pos = GCUpdatePos::Target;
+            splineContinues           = false;
             if (gc_state.modal.motion == Motion::Linear) {
+                if (jobMotion) {
+                    job_record_linear(gc_block.values.xyz, pl_data);
+                }
                 mc_linear(gc_block.values.xyz, pl_data, gc_state.position);
             } else if (gc_state.modal.motion == Motion::Seek) {
                 pl_data->motion.rapidMotion = 1;  // Set rapid motion flag.
+                if (jobMotion) {
+                    job_record_linear(gc_block.values.xyz, pl_data);
+                }
                 mc_linear(gc_block.values.xyz, pl_data, gc_state.position);
             } else if ((gc_state.modal.motion == Motion::CwArc) || (gc_state.modal.motion == Motion::CcwArc)) {
+                if (jobMotion) {
+                    job_record_arc(gc_block.values.xyz,
+                                   pl_data,
+                                   gc_block.values.ijk,
+                                   gc_block.values.r,
+                                   axis_0,
+                                   axis_1,
+                                   axis_linear,
+                                   clockwiseArc,
+                                   int(gc_block.values.p));
+                }
                 mc_arc(gc_block.values.xyz,
                        pl_data,
                        gc_state.position,
@@ -1613,6 +1746,16 @@ Error gc_execute_line(char* line) {
                        axis_linear,
                        clockwiseArc,
                        int(gc_block.values.p));
+            } else if ((gc_state.modal.motion == Motion::CubicSpline) || (gc_state.modal.motion == Motion::QuadraticSpline)) {
+                if (jobMotion) {
+                    job_record_spline(gc_block.values.xyz, pl_data, splineFirst, splineSecond);
+                }
+                mc_spline(gc_block.values.xyz, pl_data, gc_state.position, splineFirst, splineSecond, X_AXIS, Y_AXIS);
+                if (gc_state.modal.motion == Motion::CubicSpline) {
+                    splineContinues  = true;
+                    splineControl[0] = splineSecond[0];
+                    splineControl[1] = splineSecond[1];
+                }
             } else {
                 // NOTE: gc_block.values.xyz is returned from mc_probe_cycle with the updated position value. So
                 // upon a successful probing cycle, the machine position and the returned value should be the same.
@@ -25,7 +25,7 @@ enum class Override : uint8_t {
 
 enum class ModalGroup : uint8_t {
     MG0  = 0,   // [G4,G10,G28,G28.1,G30,G30.1,G53,G92,G92.1] Non-modal
-    MG1  = 1,   // [G0,G1,G2,G3,G38.2,G38.3,G38.4,G38.5,G80] Motion
+    MG1  = 1,   // [G0,G1,G2,G3,G5,G5.1,G38.2,G38.3,G38.4,G38.5,G80] Motion
     MG2  = 2,   // [G17,G18,G19] Plane selection
     MG3  = 3,   // [G90,G91] Distance mode
     MG4  = 4,   // [G91.1] Arc IJK distance mode
@@ -71,6 +71,8 @@ enum class Motion : uint8_t {
     Linear             = 1,    // G1 (Do not alter value)
     CwArc              = 2,    // G2 (Do not alter value)
     CcwArc             = 3,    // G3 (Do not alter value)
+    CubicSpline        = 5,    // G5 (Do not alter value)
+    QuadraticSpline    = 51,   // G5.1 (Do not alter value)
     ProbeToward        = 140,  // G38.2 (Do not alter value)
     ProbeTowardNoError = 141,  // G38.3 (Do not alter value)
     ProbeAway          = 142,  // G38.4 (Do not alter value)
@@ -235,7 +237,7 @@ CoordIndex& operator++(CoordIndex& i);
 
 // NOTE: When this struct is zeroed, the 0 values in the above types set the system defaults.
 struct gc_modal_t {
-    Motion   motion;     // {G0,G1,G2,G3,G38.2,G80}
+    Motion   motion;     // {G0,G1,G2,G3,G5,G5.1,G38.2,G80}
     FeedRate feed_rate;  // {G93,G94}
     Units    units;      // {G20,G21}
     Distance distance;   // {G90,G91}
@@ -306,8 +308,15 @@ void gc_init();
 // Execute one block of rs275/ngc/g-code
 Error gc_execute_line(char* line);
 
+// Remove whitespace and comments and convert to upper case, in place
+void collapseGCode(char* line);
+
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
+// Sets the control point that a following G5 without I and J reflects, for splines
+// that were planned without the parser.  Null ends the continuation.
+void gc_set_spline_control(const float* control);
+
 void user_tool_change(uint32_t new_tool);
 void user_m30();
@@ -2,56 +2,146 @@
 #include "FileStream.h"
 
 #include <mbedtls/md.h>
+#include <sys/stat.h>
+#include <cstdio>
 
-std::map<std::string, std::string> HashFS::localFsHashes;
+std::map<std::string, std::string>   HashFS::localFsHashes;
+std::map<std::string, HashFS::Stamp> HashFS::_stamps;
+bool                                 HashFS::_loaded = false;
 
 static char hexNibble(int i) {
     return "0123456789ABCDEF"[i & 0xf];
 }
 
-static Error hashFile(const char* ipath, std::string& str) {  // No ESP command
-    mbedtls_md_context_t ctx;
+void HashFS::Hasher::start() {
+    if (_active) {
+        mbedtls_md_free(&_ctx);  // An upload that was abandoned
+    }
+    mbedtls_md_init(&_ctx);
+    mbedtls_md_setup(&_ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+    mbedtls_md_starts(&_ctx);
+    _active = true;
+}
+
+void HashFS::Hasher::update(const uint8_t* data, size_t length) {
+    if (_active) {
+        mbedtls_md_update(&_ctx, data, length);
+    }
+}
 
+std::string HashFS::Hasher::finish() {
     uint8_t shaResult[32];
+    mbedtls_md_finish(&_ctx, shaResult);
+    mbedtls_md_free(&_ctx);
+    _active = false;
+
+    std::string str;
+    str = '"';
+    for (int i = 0; i < 32; i++) {
+        uint8_t b = shaResult[i];
+        str += hexNibble(b >> 4);
+        str += hexNibble(b);
+    }
+    str += '"';
+    return str;
+}
 
+HashFS::Hasher::~Hasher() {
+    if (_active) {
+        mbedtls_md_free(&_ctx);
+    }
+}
+
+static Error hashFile(const char* ipath, std::string& str) {  // No ESP command
     try {
-        FileStream inFile { ipath, "r" };
-        uint8_t    buf[512];
-        size_t     len;
+        FileStream     inFile { ipath, "r" };
+        HashFS::Hasher hasher;
+        uint8_t        buf[512];
+        size_t         len;
 
-        mbedtls_md_init(&ctx);
-        mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
-        mbedtls_md_starts(&ctx);
+        hasher.start();
         while ((len = inFile.read(buf, 512)) > 0) {
-            mbedtls_md_update(&ctx, buf, len);
+            hasher.update(buf, len);
         }
-        mbedtls_md_finish(&ctx, shaResult);
-        mbedtls_md_free(&ctx);
+        str = hasher.finish();
     } catch (const Error err) {
         log_error("Cannot open file " << ipath);
         return Error::FsFailedOpenFile;
     }
+    return Error::Ok;
+}
 
-    str = '"';
-    for (int i = 0; i < 32; i++) {
-        uint8_t b = shaResult[i];
-        str += hexNibble(b >> 4);
-        str += hexNibble(b);
+// The manifest holds a line "size mtime hash name" for each file, so that
+// at startup only files that changed since the last rehash are read
+static const char* localDir     = "/localfs";
+static const char* manifestName = "/.hashes";
+
+bool HashFS::stamp(const char* path, Stamp& stamp) {
+    struct stat st;
+    if (::stat(path, &st)) {
+        return false;
     }
-    str += '"';
+    stamp.size  = st.st_size;
+    stamp.mtime = st.st_mtime;
+    return true;
+}
 
-    return Error::Ok;
+void HashFS::loadManifest() {
+    _loaded = true;
+    std::string contents;
+    try {
+        FileStream manifest { std::string(localDir) + manifestName, "r" };
+        contents.resize(manifest.size());
+        contents.resize(manifest.read(&contents[0], contents.size()));
+    } catch (const Error err) { return; }  // First boot, or after a format
+
+    size_t pos = 0;
+    while (pos < contents.length()) {
+        auto eol = contents.find('\n', pos);
+        if (eol == std::string::npos) {
+            eol = contents.length();
+        }
+        std::string   line = contents.substr(pos, eol - pos);
+        unsigned long size;
+        long long     mtime;
+        char          hash[70];
+        int           nameStart = 0;
+        if (sscanf(line.c_str(), "%lu %lld %69s %n", &size, &mtime, hash, &nameStart) == 3 && nameStart) {
+            std::string name = line.substr(nameStart);
+            localFsHashes[name] = hash;
+            _stamps[name]       = { size_t(size), time_t(mtime) };
+        }
+        pos = eol + 1;
+    }
+}
+
+void HashFS::saveManifest() {
+    try {
+        FileStream manifest { std::string(localDir) + manifestName, "w" };
+        char       prefix[40];
+        for (const auto& [name, hash] : localFsHashes) {
+            const auto& stamp = _stamps[name];
+            snprintf(prefix, sizeof(prefix), "%lu %lld ", (unsigned long)stamp.size, (long long)stamp.mtime);
+            std::string line(prefix);
+            line += hash;
+            line += ' ';
+            line += name;
+            line += '\n';
+            manifest.write((const uint8_t*)line.c_str(), line.length());
+        }
+    } catch (const Error err) { log_error("Cannot save " << localDir << manifestName); }
 }
 
 void HashFS::rehash() {
-    const char*     iDir = "/localfs";
     std::error_code ec;
 
-    localFsHashes.clear();
+    if (!_loaded) {
+        loadManifest();
+    }
 
-    FluidPath fpath { iDir, "", ec };
+    FluidPath fpath { localDir, "", ec };
     if (ec) {
-        log_error("Cannot open " << iDir);
+        log_error("Cannot open " << localDir);
         return;
     }
 
@@ -60,26 +150,81 @@ void HashFS::rehash() {
         log_error(fpath << " " << ec.message());
         return;
     }
-    Error err = Error::Ok;
+
+    std::map<std::string, std::string> hashes;
+    std::map<std::string, Stamp>       stamps;
+    bool                               changed = false;
     for (auto const& dir_entry : iter) {
         if (dir_entry.is_directory()) {
             log_error("Not handling localfs subdirectories");
+            continue;
+        }
+        std::string filename("/");
+        filename += dir_entry.path().filename();
+        if (filename == manifestName) {
+            continue;
+        }
+
+        Stamp now;
+        if (!stamp(dir_entry.path().c_str(), now)) {
+            continue;
+        }
+        auto old = _stamps.find(filename);
+        auto it  = localFsHashes.find(filename);
+        if (old != _stamps.end() && it != localFsHashes.end() && old->second.size == now.size && old->second.mtime == now.mtime) {
+            hashes[filename] = it->second;
         } else {
-            std::string ipath(iDir);
-            ipath += "/";
-            ipath += dir_entry.path().filename();
+            std::string ipath(localDir);
+            ipath += filename;
             std::string hash;
-            auto        err1 = hashFile(ipath.c_str(), hash);
-            if (err1 != Error::Ok) {
-                err = err1;
-            } else {
-                std::string filename("/");
-                filename += dir_entry.path().filename();
-                localFsHashes[filename] = hash;
+            if (hashFile(ipath.c_str(), hash) != Error::Ok) {
+                continue;
             }
+            hashes[filename] = hash;
+            changed          = true;
         }
+        stamps[filename] = now;
     }
+
+    // A file that was deleted leaves the map smaller, one that was added marked it changed
+    changed = changed || hashes.size() != localFsHashes.size();
+
+    localFsHashes.swap(hashes);
+    _stamps.swap(stamps);
+    if (changed) {
+        saveManifest();
+    }
+}
+
+void HashFS::forget(const FluidPath& path) {
+    if (!_loaded) {
+        loadManifest();
+    }
+
+    std::string filename("/");
+    filename += path.filename();
+    _stamps.erase(filename);
 }
+
+void HashFS::rehash_file(const FluidPath& path, const std::string& hash) {
+    if (!_loaded) {
+        loadManifest();
+    }
+
+    std::string filename("/");
+    filename += path.filename();
+
+    Stamp now;
+    if (!stamp(path.c_str(), now)) {
+        localFsHashes.erase(filename);
+        _stamps.erase(filename);
+    } else {
+        localFsHashes[filename] = hash;
+        _stamps[filename]       = now;
+    }
+    saveManifest();
+}
+
 std::string HashFS::hash(std::string name) {
     std::map<std::string, std::string>::iterator it;
 
@@ -1,12 +1,53 @@
 #pragma once
+#include "FluidPath.h"
+
+#include <mbedtls/md.h>
+#include <ctime>
 #include <string>
 #include <map>
 class HashFS {
 public:
     static std::map<std::string, std::string> localFsHashes;
 
-    static void        rehash();
+    // Computes a file's hash while it is being written, so that it need not
+    // be read back afterwards
+    class Hasher {
+        mbedtls_md_context_t _ctx;
+        bool                 _active = false;
+
+    public:
+        void        start();
+        void        update(const uint8_t* data, size_t length);
+        std::string finish();  // Quoted hex, as sent in ETag headers
+        bool        active() { return _active; }
+
+        ~Hasher();
+    };
+
+    // Brings localFsHashes up to date, hashing only the files whose size or
+    // modification time differ from the manifest saved by the last rehash.
+    // That shortcut is for the boot scan: a file rewritten within the same
+    // second at the same size keeps its stamp, so after a write, forget()
+    // the file first.
+    static void rehash();
+
+    // Drops the stamp of a localfs file, so that the next rehash() hashes it
+    static void forget(const FluidPath& path);
+
+    // Records the hash of a localfs file from a Hasher that saw all of it
+    static void        rehash_file(const FluidPath& path, const std::string& hash);
     static std::string hash(std::string name);
 
 private:
+    struct Stamp {
+        size_t size;
+        time_t mtime;
+    };
+
+    static std::map<std::string, Stamp> _stamps;
+    static bool                         _loaded;
+
+    static bool stamp(const char* path, Stamp& stamp);
+    static void loadManifest();
+    static void saveManifest();
 };
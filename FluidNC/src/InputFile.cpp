@@ -5,37 +5,155 @@
 
 #include "Report.h"
 
+#include <cstring>
+#include <freertos/task.h>  // portMUX_INITIALIZER_UNLOCKED
+
+struct PrefetchRequest {
+    InputFile* file;
+    int        buffer;
+};
+
+// One task reads ahead for all open files, in the order that the blocks are requested
+static QueueHandle_t prefetchQueue = nullptr;
+static TaskHandle_t  prefetchTask  = nullptr;
+
+InputFile::Progress InputFile::_progress    = {};
+portMUX_TYPE        InputFile::_progressMux = portMUX_INITIALIZER_UNLOCKED;
+
 InputFile::InputFile(const char* defaultFs, const char* path, WebUI::AuthenticationLevel auth_level, Channel& out) :
-    FileStream(path, "r", defaultFs), _auth_level(auth_level), _out(out), _line_num(0) {}
+    FileStream(path, "r", defaultFs), _auth_level(auth_level), _out(out), _line_num(0) {
+    if (!prefetchQueue) {
+        prefetchQueue = xQueueCreate(4, sizeof(PrefetchRequest));
+        xTaskCreatePinnedToCore(prefetchLoop,      // task
+                                "prefetch",        // name for task
+                                4096,              // size of task stack
+                                0,                 // parameters
+                                1,                 // priority
+                                &prefetchTask,     // task handle
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+    _buffer[0] = new char[blockSize];
+    _buffer[1] = new char[blockSize];
+    _filled    = xQueueCreate(2, sizeof(int));
+    prefetch(0);
+}
+
+void InputFile::prefetchLoop(void* unused) {
+    PrefetchRequest request;
+    while (true) {
+        if (xQueueReceive(prefetchQueue, &request, portMAX_DELAY)) {
+            request.file->fillBuffer(request.buffer);
+        }
+    }
+}
+
+// Starts reading the next block of the file into the given buffer
+void InputFile::prefetch(int buffer) {
+    _pending = true;
+    if (prefetchTask) {
+        PrefetchRequest request = { this, buffer };
+        xQueueSend(prefetchQueue, &request, portMAX_DELAY);
+    } else {
+        fillBuffer(buffer);
+    }
+}
+
+// Runs in the prefetch task.  This is the only place that reads the file,
+// so the SD card is accessed once per block instead of once per character.
+void InputFile::fillBuffer(int buffer) {
+    _fill[buffer] = read(_buffer[buffer], blockSize);
+    xQueueSend(_filled, &buffer, portMAX_DELAY);
+}
+
+// Switches to the buffer that is being read ahead, and starts reading ahead
+// into the one that has been used up.  Returns false at the end of the file.
+bool InputFile::nextBuffer() {
+    if (!_pending) {
+        return false;
+    }
+    int buffer;
+    while (!xQueueReceive(_filled, &buffer, portMAX_DELAY)) {}
+    _pending = false;
+
+    _current = buffer;
+    _offset  = 0;
+    if (_fill[buffer] < blockSize) {
+        _eof = true;
+    }
+    if (!_eof) {
+        prefetch(buffer ^ 1);
+    }
+    return _fill[buffer] != 0;
+}
+
 /*
   Read a line from the file
   Returns Error::Ok if a line was read, even if the line was empty.
   Returns Error::EOF on end of file.
   Returns other Error code on error, after displaying a message.
+  maxlen is the size of line, including the terminating null.
 */
 Error InputFile::readLine(char* line, int maxlen) {
     ++_line_num;
     int len = 0;
-    int c;
-    while ((c = read()) >= 0) {
-        if (len >= maxlen) {
-            return Error::LineLengthExceeded;
-        }
-        if (c == '\r') {
-            continue;
+    while (_offset < _fill[_current] || nextBuffer()) {
+        // Take characters directly from the buffer, up to the newline or the end of the buffer
+        const char* start   = _buffer[_current] + _offset;
+        size_t      avail   = _fill[_current] - _offset;
+        const char* newline = static_cast<const char*>(memchr(start, '\n', avail));
+        size_t      count   = newline ? newline - start : avail;
+
+        _offset += newline ? count + 1 : count;
+        _consumed += newline ? count + 1 : count;
+
+        for (const char* p = start; p < start + count; ++p) {
+            if (*p == '\r') {
+                continue;
+            }
+            if (len >= maxlen - 1) {
+                return Error::LineLengthExceeded;
+            }
+            line[len++] = *p;
         }
-        if (c == '\n') {
-            break;
+        if (newline) {
+            line[len] = '\0';
+            return Error::Ok;
         }
-        line[len++] = c;
     }
     line[len] = '\0';
-    return len || c >= 0 ? Error::Ok : Error::Eof;
+    return len ? Error::Ok : Error::Eof;
 }
 
 // return a percentage complete 50.5 = 50.5%
 float InputFile::percent_complete() {
-    return (float)position() / (float)size() * 100.0f;
+    return (float)_consumed / (float)size() * 100.0f;
+}
+
+// Runs in the poller after each line, and in whichever task ends the job
+void InputFile::publishProgress(bool running) {
+    float percent = running ? percent_complete() : 0;
+    portENTER_CRITICAL(&_progressMux);
+    if (running) {
+        if (_progress.owner != this) {
+            _progress.owner = this;
+            strncpy(_progress.path, c_path(), sizeof(_progress.path) - 1);
+            _progress.path[sizeof(_progress.path) - 1] = '\0';
+        }
+        _progress.percent = percent;
+    } else if (_progress.owner == this) {
+        _progress.owner = nullptr;
+    }
+    portEXIT_CRITICAL(&_progressMux);
+}
+
+void InputFile::reportProgress(Print& out) {
+    portENTER_CRITICAL(&_progressMux);
+    Progress progress = _progress;
+    portEXIT_CRITICAL(&_progressMux);
+    if (progress.owner) {
+        out << "|SD:" << setprecision(2) << progress.percent << "," << progress.path;
+    }
 }
 
 void InputFile::ack(Error status) {
@@ -44,40 +162,47 @@ void InputFile::ack(Error status) {
         if (status != Error::GcodeUnsupportedCommand) {
             // Do not stop on unsupported commands because most senders do not
             // Stop the file job on other errors
-            _notifyf("File job error", "Error:%d in %s at line: %d", status, path(), getLineNumber());
+            _notifyf("File job error", "Error:%d in %s at line: %d", static_cast<int>(status), c_path(), getLineNumber());
+            stop();  // Lines already read ahead must not run
             allChannels.kill(this);
             return;
         }
     }
     _readyNext = true;
+    if (--_unfinished == 0) {
+        finish();
+    }
 }
 
-std::string InputFile::_progress = "";
-
-#include <sstream>
-#include <iomanip>
+// The job succeeded once the whole file has been read and every line that was
+// read ahead has been executed and acked without stopping it
+void InputFile::finish() {
+    publishProgress(false);
+    _notifyf("File job done", "%s file job succeeded", c_path());
+    log_msg(path() << " file job succeeded");
+    allChannels.kill(this);
+}
 
 Channel* InputFile::pollLine(char* line) {
     // File input never returns realtime characters, so we do nothing
     // if line is null.
-    if (!_readyNext || !line) {
+    if (!_readyNext || !line || stopped() || _drained) {
         return nullptr;
     }
     switch (auto err = readLine(line, Channel::maxLine)) {
-        case Error::Ok: {
-            std::ostringstream s;
-            s << "SD:" << std::fixed << std::setprecision(2) << percent_complete() << "," << path().c_str();
-            _progress = s.str();
-        }
+        case Error::Ok:
+            ++_unfinished;
+            publishProgress(true);
             return &allChannels;
         case Error::Eof:
-            _progress = "";
-            _notifyf("File job done", "%s file job succeeded", path());
-            log_msg(path() << " file job succeeded");
-            allChannels.kill(this);
+            // Lines read ahead may still be waiting to run, and any of them can fail
+            _drained = true;
+            if (--_unfinished == 0) {
+                finish();
+            }
             return nullptr;
         default:
-            _progress = "";
+            publishProgress(false);
             log_error(static_cast<int>(err) << " (" << errorString(err) << ") in " << path() << " at line " << getLineNumber());
             allChannels.kill(this);
             return nullptr;
@@ -92,5 +217,13 @@ void InputFile::stopJob() {
 }
 
 InputFile::~InputFile() {
-    _progress = "";
+    publishProgress(false);
+    // The prefetch task must be finished with the buffers before they are freed
+    if (_pending) {
+        int buffer;
+        while (!xQueueReceive(_filled, &buffer, portMAX_DELAY)) {}
+    }
+    vQueueDelete(_filled);
+    delete[] _buffer[0];
+    delete[] _buffer[1];
 }
@@ -8,6 +8,8 @@
 //  - For reporting the progress of GCode execution, counts the number of lines read and
 //    the percentage of the file size that has currently been read.
 //  - For reporting status, remembers the I/O channel that started the process of using the file.
+//  - Reads the file in large blocks, into a pair of buffers, so that the next block is
+//    being read by a background task while lines are taken from the current one.
 // FileStream's Channel member is not that same Channel that FileStream ultimately
 // inherits from; rather it is a separate channel that is use for status reporting.
 
@@ -17,8 +19,12 @@
 #include "FileStream.h"  // FileStream and Channel
 #include "Error.h"
 
+#include <atomic>
 #include <cstdint>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
 class InputFile : public FileStream {
 private:
     WebUI::AuthenticationLevel _auth_level;
@@ -29,9 +35,50 @@ private:
 
     uint32_t _line_num;  // the most recent line number read
     bool     _readyNext = true;
+    bool     _drained   = false;  // every line has been read, so the poller is done with the file
+
+    // The lines that have been read but not yet acked, plus one until the end of the
+    // file has been read.  The poller counts up and the main loop counts down, and
+    // whichever brings it to zero reports that the job succeeded.
+    std::atomic<int> _unfinished { 1 };
+
+    void finish();
+
+    // Double buffering.  At most one block is being read ahead at any time.
+    static const size_t blockSize = 4096;
+
+    char*         _buffer[2];
+    size_t        _fill[2]  = { 0, 0 };  // bytes in each buffer
+    int           _current  = 1;         // the buffer that lines are taken from, empty until the first block
+    size_t        _offset   = 0;         // the next byte to take from the current buffer
+    size_t        _consumed = 0;         // the total bytes taken, for progress reports
+    bool          _pending  = false;     // a block is being read into the other buffer
+    bool          _eof      = false;     // the end of the file has been read
+    QueueHandle_t _filled   = nullptr;   // the buffers whose blocks have been read
+
+    void prefetch(int buffer);
+    void fillBuffer(int buffer);
+    bool nextBuffer();
+
+    static void prefetchLoop(void* unused);
+
+    // The progress of the running file job, as a copy that status reports can read
+    // from any task.  Only the poller and the ack of a job's last line write it, both
+    // before the job can be deleted, so a report never touches an InputFile that may
+    // be gone.
+    struct Progress {
+        const InputFile* owner;  // Only compared, never dereferenced; null when no job is running
+        float            percent;
+        char             path[Channel::maxLine];
+    };
+    static Progress     _progress;
+    static portMUX_TYPE _progressMux;
+
+    void publishProgress(bool running);
 
 public:
-    static std::string _progress;
+    // Appends the progress of the running file job, if any, to a status report
+    static void reportProgress(Print& out);
 
     // fsname is the default file system on which the file is located, in case the path does not specify
     // path is the full path to the file
@@ -0,0 +1,368 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Job.h"
+
+#include "GCode.h"
+#include "InputFile.h"
+#include "MotionControl.h"  // mc_linear(), mc_arc(), mc_spline()
+#include "Protocol.h"
+#include "System.h"
+#include "Machine/MachineConfig.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace {
+    enum class Record : uint8_t {
+        Linear = 1,  // Modal, plan_line_data_t, target
+        Arc    = 2,  // Modal, plan_line_data_t, target, ArcParams
+        Block  = 3,  // parser_state_t, length, text
+        End    = 4,  // parser_state_t
+        Spline = 5,  // Modal, plan_line_data_t, target, SplineParams
+    };
+
+    // The parser state that a motion block leaves behind, apart from the position,
+    // so that a block parsed after it at run time sees the modes it set
+    struct Modal {
+        gc_modal_t modal;
+        float      spindle_speed;
+        float      feed_rate;
+        int32_t    line_number;
+    };
+
+    // The records contain structures of this build, so their sizes identify compatible files
+    struct Header {
+        char           magic[4];
+        uint16_t       planSize;
+        uint16_t       stateSize;
+        uint8_t        nAxis;
+        parser_state_t start;  // The parser state that the job was compiled from
+    };
+
+    struct ArcParams {
+        float   offset[3];
+        float   radius;
+        uint8_t axis_0;
+        uint8_t axis_1;
+        uint8_t axis_linear;
+        bool    is_clockwise_arc;
+        int32_t pword_rotations;
+    };
+
+    struct SplineParams {
+        float first[2];  // Absolute XY control points
+        float second[2];
+    };
+
+    const char magic[4] = { 'F', 'N', 'J', '2' };
+
+    // Largest distance from the compiled start position at which a job can still run
+    const float startTolerance = 0.001f;
+
+    // The output of the compile in progress
+    FileStream* compiled    = nullptr;
+    bool        writeFailed = false;
+    uint32_t    motions     = 0;
+    uint32_t    blocks      = 0;
+
+    void put(const void* data, size_t length) {
+        if (compiled->write(static_cast<const uint8_t*>(data), length) != length) {
+            writeFailed = true;
+        }
+    }
+
+    bool get(FileStream& job, void* data, size_t length) { return job.read(static_cast<char*>(data), length) == length; }
+
+    // The parser has already applied the block's modes when it records the motion
+    void putRecord(Record type, const plan_line_data_t* pl_data, const float* target) {
+        Modal state = { gc_state.modal, gc_state.spindle_speed, gc_state.feed_rate, gc_state.line_number };
+        put(&type, sizeof(type));
+        put(&state, sizeof(state));
+        put(pl_data, sizeof(*pl_data));
+        put(target, config->_axes->_numberAxis * sizeof(float));
+        ++motions;
+    }
+
+    bool getMotion(FileStream& job, Modal& state, plan_line_data_t& pl_data, float* target) {
+        return get(job, &state, sizeof(state)) && get(job, &pl_data, sizeof(pl_data)) &&
+               get(job, target, config->_axes->_numberAxis * sizeof(float));
+    }
+
+    // Leaves the parser where it would be after the motion block
+    void applyMotion(const Modal& state, float* target) {
+        gc_state.modal         = state.modal;
+        gc_state.spindle_speed = state.spindle_speed;
+        gc_state.feed_rate     = state.feed_rate;
+        gc_state.line_number   = state.line_number;
+        copyAxes(gc_state.position, target);
+    }
+
+    bool sameStart(const parser_state_t& start) {
+        if (memcmp(start.coord_system, gc_state.coord_system, sizeof(start.coord_system)) ||
+            memcmp(start.coord_offset, gc_state.coord_offset, sizeof(start.coord_offset)) ||
+            start.tool_length_offset != gc_state.tool_length_offset) {
+            return false;
+        }
+        auto n_axis = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (fabsf(start.position[axis] - gc_state.position[axis]) > startTolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool job_compiling() {
+    return compiled != nullptr;
+}
+
+void job_record_block(const char* line) {
+    auto     type   = Record::Block;
+    uint16_t length = strlen(line);
+    put(&type, sizeof(type));
+    put(&gc_state, sizeof(gc_state));
+    put(&length, sizeof(length));
+    put(line, length);
+    ++blocks;
+}
+
+void job_record_linear(const float* target, const plan_line_data_t* pl_data) {
+    putRecord(Record::Linear, pl_data, target);
+}
+
+void job_record_arc(const float*            target,
+                    const plan_line_data_t* pl_data,
+                    const float*            offset,
+                    float                   radius,
+                    size_t                  axis_0,
+                    size_t                  axis_1,
+                    size_t                  axis_linear,
+                    bool                    is_clockwise_arc,
+                    int                     pword_rotations) {
+    ArcParams arc;
+    memcpy(arc.offset, offset, sizeof(arc.offset));
+    arc.radius           = radius;
+    arc.axis_0           = axis_0;
+    arc.axis_1           = axis_1;
+    arc.axis_linear      = axis_linear;
+    arc.is_clockwise_arc = is_clockwise_arc;
+    arc.pword_rotations  = pword_rotations;
+
+    putRecord(Record::Arc, pl_data, target);
+    put(&arc, sizeof(arc));
+}
+
+void job_record_spline(const float* target, const plan_line_data_t* pl_data, const float* first, const float* second) {
+    SplineParams spline;
+    memcpy(spline.first, first, sizeof(spline.first));
+    memcpy(spline.second, second, sizeof(spline.second));
+
+    putRecord(Record::Spline, pl_data, target);
+    put(&spline, sizeof(spline));
+}
+
+Error job_compile(const char* fs, const char* path, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (sys.state() != State::Idle) {
+        return Error::IdleError;
+    }
+    InputFile*  source;
+    FileStream* job;
+    std::string jobPath = std::string(path) + ".job";
+    try {
+        source = new InputFile(fs, path, auth_level, out);
+    } catch (Error err) { return err; }
+    try {
+        job = new FileStream(jobPath, "w", fs);
+    } catch (Error err) {
+        delete source;
+        return err;
+    }
+
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.planSize  = sizeof(plan_line_data_t);
+    header.stateSize = sizeof(parser_state_t);
+    header.nAxis     = config->_axes->_numberAxis;
+    header.start     = gc_state;
+
+    compiled    = job;
+    writeFailed = false;
+    motions     = 0;
+    blocks      = 0;
+    put(&header, sizeof(header));
+
+    // A job never continues a G5 from before it, so it compiles and runs the same way
+    gc_set_spline_control(nullptr);
+
+    // Check mode keeps the parser from moving the machine or switching the spindle and coolant
+    sys.set_state(State::CheckMode);
+
+    char  line[Channel::maxLine];
+    Error err;
+    while ((err = source->readLine(line, sizeof(line))) == Error::Ok) {
+        collapseGCode(line);
+        if (*line == '$' || *line == '[') {
+            err = Error::JobUnsupportedCommand;
+            break;
+        }
+        if (*line == '\0') {
+            continue;
+        }
+        err = gc_execute_line(line);
+        if (err == Error::GcodeUnsupportedCommand) {
+            // A file job skips unsupported commands, so the compiled job leaves them out
+            log_warn(errorString(err) << " in " << path << " at line " << source->getLineNumber());
+            continue;
+        }
+        if (err != Error::Ok) {
+            break;
+        }
+    }
+    if (err == Error::Eof) {
+        auto type = Record::End;
+        put(&type, sizeof(type));
+        put(&gc_state, sizeof(gc_state));
+        err = writeFailed ? Error::FsFailedCreateFile : Error::Ok;
+    }
+    compiled = nullptr;
+
+    // The job is compiled, not run, so the parser goes back to where it was
+    gc_state = header.start;
+    gc_set_spline_control(nullptr);
+    allChannels.notifyWco();
+    sys.set_state(State::Idle);
+
+    if (err == Error::Ok) {
+        log_info("Compiled " << path << " to " << jobPath << ": " << motions << " motions, " << blocks << " parsed blocks");
+    } else {
+        log_error(static_cast<int>(err) << " (" << errorString(err) << ") in " << path << " at line " << source->getLineNumber());
+    }
+    auto fpath = job->fpath();
+    delete job;
+    delete source;
+    if (err != Error::Ok) {
+        std::error_code ec;
+        stdfs::remove(fpath, ec);
+    }
+    fpath.rehash_fs();
+    return err;
+}
+
+Error job_run(const char* fs, const char* path, Channel& out) {
+    if (sys.state() != State::Idle) {
+        return Error::IdleError;
+    }
+    FileStream* job;
+    try {
+        job = new FileStream(path, "r", fs);
+    } catch (Error err) { return err; }
+
+    auto   n_axis = config->_axes->_numberAxis;
+    Header header;
+    if (!get(*job, &header, sizeof(header)) || memcmp(header.magic, magic, sizeof(magic)) ||
+        header.planSize != sizeof(plan_line_data_t) || header.stateSize != sizeof(parser_state_t) || header.nAxis != n_axis) {
+        delete job;
+        return Error::JobInvalid;
+    }
+    if (!sameStart(header.start)) {
+        log_error(path << " was compiled for other work offsets or another start position");
+        delete job;
+        return Error::JobStartMismatch;
+    }
+    gc_state = header.start;
+    gc_set_spline_control(nullptr);
+
+    plan_line_data_t pl_data;
+    float            target[MAX_N_AXIS];
+    ArcParams        arc;
+    SplineParams     spline;
+    Modal            modal;
+    parser_state_t   state;
+    uint16_t         length;
+    char             line[Channel::maxLine];
+
+    Error  err = Error::Ok;
+    Record type;
+    while (err == Error::Ok) {
+        // Between records, as between the lines of a file job, so that a motion that does
+        // not fill the planner still lets holds, overrides, reports and resets through
+        protocol_execute_realtime();
+        if (sys.abort()) {
+            break;
+        }
+        if (!get(*job, &type, sizeof(type))) {
+            err = Error::JobInvalid;
+            break;
+        }
+        switch (type) {
+            case Record::Linear:
+                if (!getMotion(*job, modal, pl_data, target)) {
+                    err = Error::JobInvalid;
+                    break;
+                }
+                mc_linear(target, &pl_data, gc_state.position);
+                applyMotion(modal, target);
+                gc_set_spline_control(nullptr);
+                break;
+            case Record::Arc:
+                if (!getMotion(*job, modal, pl_data, target) || !get(*job, &arc, sizeof(arc))) {
+                    err = Error::JobInvalid;
+                    break;
+                }
+                mc_arc(target,
+                       &pl_data,
+                       gc_state.position,
+                       arc.offset,
+                       arc.radius,
+                       arc.axis_0,
+                       arc.axis_1,
+                       arc.axis_linear,
+                       arc.is_clockwise_arc,
+                       arc.pword_rotations);
+                applyMotion(modal, target);
+                gc_set_spline_control(nullptr);
+                break;
+            case Record::Spline:
+                if (!getMotion(*job, modal, pl_data, target) || !get(*job, &spline, sizeof(spline))) {
+                    err = Error::JobInvalid;
+                    break;
+                }
+                mc_spline(target, &pl_data, gc_state.position, spline.first, spline.second, X_AXIS, Y_AXIS);
+                applyMotion(modal, target);
+                gc_set_spline_control(modal.modal.motion == Motion::CubicSpline ? spline.second : nullptr);
+                break;
+            case Record::Block:
+                if (!get(*job, &state, sizeof(state)) || !get(*job, &length, sizeof(length)) || length >= sizeof(line) ||
+                    !get(*job, line, length)) {
+                    err = Error::JobInvalid;
+                    break;
+                }
+                line[length] = '\0';
+                gc_state     = state;
+                err          = gc_execute_line(line);
+                if (err == Error::GcodeUnsupportedCommand) {
+                    err = Error::Ok;
+                } else if (err != Error::Ok) {
+                    log_error(static_cast<int>(err) << " (" << errorString(err) << ") in " << path << " at block " << line);
+                }
+                break;
+            case Record::End:
+                if (!get(*job, &state, sizeof(state))) {
+                    err = Error::JobInvalid;
+                    break;
+                }
+                // Leave the parser as it would be after running the GCode file
+                gc_state = state;
+                delete job;
+                return Error::Ok;
+            default:
+                err = Error::JobInvalid;
+                break;
+        }
+    }
+    delete job;
+    return err;
+}
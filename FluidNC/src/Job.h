@@ -0,0 +1,49 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Compiled jobs.
+
+  $Job/Compile runs a GCode file once through the parser, in check mode, and
+  writes the result to <file>.job.  Blocks that only move - G0, G1, G2 and G3,
+  with at most feed, speed and modal words that do not act on the machine - are
+  stored as planner data and absolute targets, so $Job/Run gives them to
+  mc_linear() and mc_arc() without parsing them again.  Each one also keeps
+  the modes it leaves the parser in, which $Job/Run restores after planning
+  it.  Every other block is stored as text along with the parser state that
+  preceded it, and is given back to the parser at run time.  $Job/Run runs
+  the realtime loop between records, as a file job does between lines.
+
+  A compiled job is only valid for the firmware build, the work offsets and
+  the start position that it was compiled with.  Blocks that change settings
+  or outputs even in check mode (G10, G28.1, G30.1, M6, M62-M68) and probes
+  cannot be compiled.
+*/
+
+#include "Error.h"
+#include "Planner.h"
+#include "WebUI/Authentication.h"
+
+#include <cstddef>
+
+class Channel;
+
+Error job_compile(const char* fs, const char* path, WebUI::AuthenticationLevel auth_level, Channel& out);
+Error job_run(const char* fs, const char* path, Channel& out);
+
+// Used by gc_execute_line() while a job is being compiled
+bool job_compiling();
+void job_record_block(const char* line);
+void job_record_linear(const float* target, const plan_line_data_t* pl_data);
+void job_record_arc(const float*            target,
+                    const plan_line_data_t* pl_data,
+                    const float*            offset,
+                    float                   radius,
+                    size_t                  axis_0,
+                    size_t                  axis_1,
+                    size_t                  axis_linear,
+                    bool                    is_clockwise_arc,
+                    int                     pword_rotations);
+void job_record_spline(const float* target, const plan_line_data_t* pl_data, const float* first, const float* second);
@@ -5,8 +5,12 @@
 #include "Kinematics.h"
 
 #include "../Config.h"
+#include "../Machine/MachineConfig.h"
 #include "Cartesian.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Kinematics {
     bool Kinematics::cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) {
         Assert(_system != nullptr, "No kinematic system");
@@ -57,4 +61,117 @@ namespace Kinematics {
     }
 
     Kinematics::~Kinematics() { delete _system; }
+
+    // How far the tool departs from the straight cartesian path when the motors move linearly between two motor
+    // positions, in mm from the line at the midpoint of the motor move. Only X, Y and Z are compared, because the
+    // cartesian values of axes that carry motors of a non-linear system have no meaning.
+    float KinematicSystem::chord_error(const float* from, const float* to, const float* motors_from, const float* motors_to) {
+        float motors_midpoint[MAX_N_AXIS];
+        float midpoint[MAX_N_AXIS];
+        auto  n_axis = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            motors_midpoint[axis] = (motors_from[axis] + motors_to[axis]) / 2;
+        }
+        motors_to_cartesian(midpoint, motors_midpoint, n_axis);
+
+        // Distance from the line through from and to, leaving out any offset along it
+        size_t n_cartesian = std::min<size_t>(n_axis, Z_AXIS + 1);
+        float  along = 0, length2 = 0;
+        for (size_t axis = 0; axis < n_cartesian; axis++) {
+            float d = to[axis] - from[axis];
+            along += (midpoint[axis] - from[axis]) * d;
+            length2 += d * d;
+        }
+        float fraction = length2 > 0 ? along / length2 : 0;
+        float error2   = 0;
+        for (size_t axis = 0; axis < n_cartesian; axis++) {
+            float d = midpoint[axis] - (from[axis] + (to[axis] - from[axis]) * fraction);
+            error2 += d * d;
+        }
+        return sqrtf(error2);
+    }
+
+    bool KinematicSystem::segment_by_chord_error(float*            target,
+                                                 plan_line_data_t* pl_data,
+                                                 float*            position,
+                                                 float             chord_tolerance,
+                                                 float             max_segment_length,
+                                                 float             min_segment_length) {
+        auto n_axis = config->_axes->_numberAxis;
+
+        float motors_target[MAX_N_AXIS];
+        transform_cartesian_to_motors(motors_target, target);
+
+        float total_cartesian_distance = vector_distance(position, target, n_axis);
+        if (total_cartesian_distance == 0) {
+            // Plan it anyway, so that S and M codes are updated by the planner
+            return mc_move_motors(motors_target, pl_data);
+        }
+
+        // Inverse time applies to the whole move, so convert it to a feed rate shared by the segments
+        if (pl_data->motion.inverseTime) {
+            pl_data->feed_rate *= total_cartesian_distance;
+            pl_data->motion.inverseTime = 0;
+        }
+        float cartesian_feed_rate = pl_data->feed_rate;
+
+        float segment_start[MAX_N_AXIS];
+        float motors_start[MAX_N_AXIS];
+        copyAxes(segment_start, position);
+        transform_cartesian_to_motors(motors_start, segment_start);
+
+        float done           = 0;
+        float segment_length = max_segment_length;
+        while (true) {
+            float segment_end[MAX_N_AXIS];
+            float motors_end[MAX_N_AXIS];
+            bool  last;
+
+            // Halve the segment until the motors follow the straight path closely enough
+            while (true) {
+                last = done + segment_length >= total_cartesian_distance;
+                if (last) {
+                    segment_length = total_cartesian_distance - done;
+                    copyAxes(segment_end, target);
+                    copyAxes(motors_end, motors_target);
+                } else {
+                    float fraction = (done + segment_length) / total_cartesian_distance;
+                    for (size_t axis = 0; axis < n_axis; axis++) {
+                        segment_end[axis] = position[axis] + (target[axis] - position[axis]) * fraction;
+                    }
+                    transform_cartesian_to_motors(motors_end, segment_end);
+                }
+                if (segment_length <= min_segment_length ||
+                    chord_error(segment_start, segment_end, motors_start, motors_end) <= chord_tolerance) {
+                    break;
+                }
+                segment_length /= 2;
+            }
+
+            // Adjust feedrate by the ratio of the segment lengths in motor and cartesian spaces,
+            // accounting for all axes
+            if (!pl_data->motion.rapidMotion) {  // Rapid motions ignore feedrate. Don't convert.
+                                                 // T=D/V, Tcart=Tmotor, Dcart/Vcart=Dmotor/Vmotor
+                                                 // Vmotor = Dmotor*(Vcart/Dcart)
+                float motor_segment_length = vector_distance(motors_start, motors_end, n_axis);
+                pl_data->feed_rate         = cartesian_feed_rate * motor_segment_length / segment_length;
+            }
+
+            // mc_move_motors() returns false if a jog is cancelled.
+            // In that case we stop sending segments to the planner.
+            if (!mc_move_motors(motors_end, pl_data)) {
+                return false;
+            }
+            if (last) {
+                return true;
+            }
+
+            done += segment_length;
+            copyAxes(segment_start, segment_end);
+            copyAxes(motors_start, motors_end);
+
+            // Try a longer segment next, in case the path is straighter further along
+            segment_length = std::min(segment_length * 2, max_segment_length);
+        }
+    }
 };
@@ -87,6 +87,20 @@ namespace Kinematics {
 
         // Virtual base classes require a virtual destructor.
         virtual ~KinematicSystem() {}
+
+    protected:
+        // Plans a straight cartesian move as motor moves, for systems whose motors are not linear in cartesian space.
+        // Each segment is as long as possible, up to max_segment_length, while the motors moving linearly over it keep
+        // the tool within chord_tolerance mm of the straight cartesian path at the midpoint of the motor move.
+        bool segment_by_chord_error(float*            target,
+                                    plan_line_data_t* pl_data,
+                                    float*            position,
+                                    float             chord_tolerance,
+                                    float             max_segment_length,
+                                    float             min_segment_length);
+
+    private:
+        float chord_error(const float* from, const float* to, const float* motors_from, const float* motors_to);
     };
 
     using KinematicsFactory = Configuration::GenericFactory<KinematicSystem>;
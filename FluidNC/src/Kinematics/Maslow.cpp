@@ -0,0 +1,118 @@
+// Copyright (c) 2024 Maslow CNC. All rights reserved.
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file with
+// following exception: it may not be used for any reason by MakerMade or anyone with a business or personal connection to MakerMade
+
+#include "Maslow.h"
+
+#include "../Machine/MachineConfig.h"
+#include "../Maslow/Maslow.h"
+
+namespace Kinematics {
+    void Maslow::group(Configuration::HandlerBase& handler) {
+        handler.item("tl_axis", _belt_axis[0], 0, MAX_N_AXIS - 1);
+        handler.item("tr_axis", _belt_axis[1], 0, MAX_N_AXIS - 1);
+        handler.item("bl_axis", _belt_axis[2], 0, MAX_N_AXIS - 1);
+        handler.item("br_axis", _belt_axis[3], 0, MAX_N_AXIS - 1);
+
+        handler.item("chord_tolerance_mm", _chord_tolerance, 0.001, 1.0);
+        handler.item("max_segment_length_mm", _max_segment_length, 1.0, 1000.0);
+        handler.item("min_segment_length_mm", _min_segment_length, 0.01, 10.0);
+    }
+
+    void Maslow::init() {
+        log_info("Kinematic system: " << name());
+
+        auto n_axis = config->_axes->_numberAxis;
+        for (int belt = 0; belt < nBelts; belt++) {
+            if (_belt_axis[belt] >= n_axis || _belt_axis[belt] == Z_AXIS) {
+                log_config_error("Maslow kinematics needs an axis other than Z for each of the four belts");
+            }
+        }
+
+        // The anchor table is built from the Maslow_* configuration items
+        ::Maslow.updateCenterXY();
+        ::Maslow.setBeltSpace(this);
+
+        init_position();
+    }
+
+    // Initialize the machine position. Motor zero is the belt lengths at cartesian (0, 0, 0).
+    void Maslow::init_position() {
+        auto n_axis = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            set_motor_steps(axis, 0);  // Set to zeros
+        }
+    }
+
+    bool Maslow::canHome(AxisMask axisMask) {
+        log_error("This kinematic system cannot home, use the Maslow belt commands");
+        return false;
+    }
+
+    void Maslow::zero_lengths(float lengths[nBelts]) {
+        ::Maslow.belts().compute(0, 0, 0, lengths);
+    }
+
+    void Maslow::transform_cartesian_to_motors(float* motors, float* cartesian) {
+        float lengths[nBelts];
+        float zero[nBelts];
+        ::Maslow.belts().compute(cartesian[X_AXIS], cartesian[Y_AXIS], cartesian[Z_AXIS], lengths);
+        zero_lengths(zero);
+
+        auto n_axis = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            motors[axis] = cartesian[axis];
+        }
+        for (int belt = 0; belt < nBelts; belt++) {
+            motors[_belt_axis[belt]] = lengths[belt] - zero[belt];
+        }
+    }
+
+    void Maslow::motors_to_belts(const float* motors, float lengths[nBelts]) {
+        zero_lengths(lengths);
+        for (int belt = 0; belt < nBelts; belt++) {
+            lengths[belt] += motors[_belt_axis[belt]];
+        }
+    }
+
+    /*
+      The status command uses motors_to_cartesian() to convert
+      your motor positions to cartesian X,Y,Z... coordinates.
+    */
+    void Maslow::motors_to_cartesian(float* cartesian, float* motors, int n_axis) {
+        float lengths[nBelts];
+        motors_to_belts(motors, lengths);
+
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            cartesian[axis] = motors[axis];
+        }
+        // Axes that carry belts have no cartesian meaning, other than X and Y
+        for (int belt = 0; belt < nBelts; belt++) {
+            cartesian[_belt_axis[belt]] = 0;
+        }
+        ::Maslow.belts().position(lengths[0], lengths[1], motors[Z_AXIS], cartesian[X_AXIS], cartesian[Y_AXIS]);
+    }
+
+    /*
+      cartesian_to_motors() converts from cartesian coordinates to motor space.
+
+      All linear motions pass through cartesian_to_motors() to be planned as mc_move_motors operations.
+
+      The planner moves each belt linearly over a segment, which bows the sled path away from the
+      straight line. Segments are as long as _chord_tolerance allows: long in the middle of the
+      frame, where belt length is nearly linear in position, and short near the anchors.
+
+      Parameters:
+        target = an n_axis array of target positions (where the move is supposed to go)
+        pl_data = planner data (see the definition of this type to see what it is)
+        position = an n_axis array of where the machine is starting from for this move
+    */
+    bool Maslow::cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) {
+        return segment_by_chord_error(target, pl_data, position, _chord_tolerance, _max_segment_length, _min_segment_length);
+    }
+
+    // Configuration registration
+    namespace {
+        KinematicsFactory::InstanceBuilder<Maslow> registration("Maslow");
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 Maslow CNC. All rights reserved.
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file with
+// following exception: it may not be used for any reason by MakerMade or anyone with a business or personal connection to MakerMade
+
+#pragma once
+
+/*
+	Maslow.h
+
+	Kinematic system for the Maslow M4, a sled hung from four belts. The motors are the belts
+	themselves, so the planner limits the speed and acceleration of each belt. Motor positions
+	are belt lengths relative to those at cartesian (0, 0, 0). Z is moved directly.
+
+	The frame geometry is the one configured in the Maslow_* items.
+*/
+
+#include "Kinematics.h"
+
+namespace Kinematics {
+    class Maslow : public KinematicSystem {
+    public:
+        Maslow() = default;
+
+        Maslow(const Maslow&)            = delete;
+        Maslow(Maslow&&)                 = delete;
+        Maslow& operator=(const Maslow&) = delete;
+        Maslow& operator=(Maslow&&)      = delete;
+
+        static const int nBelts = 4;  // In the order TL, TR, BL, BR
+
+        // Kinematic Interface
+
+        void init() override;
+        bool canHome(AxisMask axisMask) override;
+        void init_position() override;
+        bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
+        void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
+        void transform_cartesian_to_motors(float* motors, float* cartesian) override;
+
+        // Absolute belt lengths for a motor position
+        void motors_to_belts(const float* motors, float lengths[nBelts]);
+
+        // The motor axis that drives each belt
+        int belt_axis(int belt) const { return _belt_axis[belt]; }
+
+        // Configuration handlers:
+        void validate() override {}
+        void group(Configuration::HandlerBase& handler) override;
+        void afterParse() override {}
+
+        // Name of the configurable. Must match the name registered in the cpp file.
+        const char* name() const override { return "Maslow"; }
+
+        ~Maslow() {}
+
+    private:
+        void zero_lengths(float lengths[nBelts]);
+
+        // Parameters
+        int   _belt_axis[nBelts]  = { X_AXIS, Y_AXIS, A_AXIS, B_AXIS };
+        float _chord_tolerance    = 0.01;  // Largest departure of a segment from the straight cartesian path, in mm
+        float _max_segment_length = 50;
+        float _min_segment_length = 0.5;
+    };
+}  //  namespace Kinematics
@@ -14,7 +14,9 @@ namespace Kinematics {
         handler.item("right_anchor_x", _right_anchor_x);
         handler.item("right_anchor_y", _right_anchor_y);
 
-        handler.item("segment_length", _segment_length);
+        handler.item("segment_length", _segment_length, 1.0, 1000.0);
+        handler.item("min_segment_length", _min_segment_length, 0.01, 10.0);
+        handler.item("chord_tolerance", _chord_tolerance, 0.001, 1.0);
     }
 
     void WallPlotter::init() {
@@ -24,12 +26,6 @@ namespace Kinematics {
         // The motors assume they start from (0, 0, 0).
         // So we need to derive the zero lengths to satisfy the kinematic equations.
         xy_to_lengths(0, 0, zero_left, zero_right);
-        last_motor_segment_end[0] = zero_left;
-        last_motor_segment_end[1] = zero_right;
-        auto n_axis               = config->_axes->_numberAxis;
-        for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
-            last_motor_segment_end[axis] = 0.0;
-        }
 
         init_position();
     }
@@ -47,8 +43,18 @@ namespace Kinematics {
         return false;
     }
 
-    void WallPlotter::transform_cartesian_to_motors(float* cartesian, float* motors) {
-        log_error("WallPlotter::transform_cartesian_to_motors is broken");
+    void WallPlotter::transform_cartesian_to_motors(float* motors, float* cartesian) {
+        float left_length, right_length;
+        xy_to_lengths(cartesian[X_AXIS], cartesian[Y_AXIS], left_length, right_length);
+
+        auto n_axis = config->_axes->_numberAxis;
+        for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
+            motors[axis] = cartesian[axis];
+        }
+        // Note that the left motor runs backward.
+        // TODO: It might be better to adjust motor direction in .yaml file by inverting direction pin??
+        motors[_left_axis]  = 0 - (left_length - zero_left);
+        motors[_right_axis] = 0 + (right_length - zero_right);
     }
 
     /*
@@ -56,100 +62,17 @@ namespace Kinematics {
 
       All linear motions pass through cartesian_to_motors() to be planned as mc_move_motors operations.
 
+      The cord lengths are not linear in the puck position, so moves are broken into segments that
+      the planner moves the motors along linearly. The segments are as long as _chord_tolerance
+      allows, up to _segment_length: long in the middle of the wall and short near the anchors.
+
       Parameters:
         target = an n_axis array of target positions (where the move is supposed to go)
         pl_data = planner data (see the definition of this type to see what it is)
         position = an n_axis array of where the machine is starting from for this move
     */
     bool WallPlotter::cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) {
-        float    dx, dy, dz;     // segment distances in each cartesian axis
-        uint32_t segment_count;  // number of segments the move will be broken in to.
-
-        auto n_axis = config->_axes->_numberAxis;
-
-        float total_cartesian_distance = vector_distance(position, target, n_axis);
-        if (total_cartesian_distance == 0) {
-            mc_move_motors(target, pl_data);
-            return true;
-        }
-
-        float cartesian_feed_rate = pl_data->feed_rate;
-
-        // calculate the total X,Y axis move distance
-        // Z axis is the same in both coord systems, so it does not undergo conversion
-        float xydist = vector_distance(target, position, 2);  // Only compute distance for both axes. X and Y
-        // Segment our G1 and G0 moves based on yaml file. If we choose a small enough _segment_length we can hide the nonlinearity
-        segment_count = xydist / _segment_length;
-        if (segment_count < 1) {  // Make sure there is at least one segment, even if there is no movement
-            // We need to do this to make sure other things like S and M codes get updated properly by
-            // the planner even if there is no movement??
-            segment_count = 1;
-        }
-        float cartesian_segment_length = total_cartesian_distance / segment_count;
-
-        // Calc length of each cartesian segment - the same for all segments
-        float cartesian_segment_components[n_axis];
-        for (size_t axis = X_AXIS; axis < n_axis; axis++) {
-            cartesian_segment_components[axis] = (target[axis] - position[axis]) / segment_count;
-        }
-
-        float cartesian_segment_end[n_axis];
-        copyAxes(cartesian_segment_end, position);
-
-        // Calculate desired cartesian feedrate distance ratio. Same for each seg.
-        for (uint32_t segment = 1; segment <= segment_count; segment++) {
-            // calculate the cartesian end point of the next segment
-            for (size_t axis = X_AXIS; axis < n_axis; axis++) {
-                cartesian_segment_end[axis] += cartesian_segment_components[axis];
-            }
-
-            // Convert cartesian space coords to motor space
-            float motor_segment_end[n_axis];
-            xy_to_lengths(cartesian_segment_end[X_AXIS], cartesian_segment_end[Y_AXIS], motor_segment_end[0], motor_segment_end[1]);
-            for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
-                motor_segment_end[axis] = cartesian_segment_end[axis];
-            }
-
-#ifdef USE_CHECKED_KINEMATICS
-            // Check the inverse computation.
-            float cx, cy;
-            lengths_to_xy(motor_segment_end[0], motor_segment_end[1], cx, cy);
-
-            if (abs(cartesian_segment_end[X_AXIS] - cx) > 0.1 || abs(cartesian_segment_end[Y_AXIS] - cy) > 0.1) {
-                // FIX: Produce an alarm state?
-            }
-#endif
-            // Adjust feedrate by the ratio of the segment lengths in motor and cartesian spaces,
-            // accounting for all axes
-            if (!pl_data->motion.rapidMotion) {  // Rapid motions ignore feedrate. Don't convert.
-                                                 // T=D/V, Tcart=Tmotor, Dcart/Vcart=Dmotor/Vmotor
-                                                 // Vmotor = Dmotor*(Vcart/Dcart)
-                float motor_segment_length = vector_distance(last_motor_segment_end, motor_segment_end, n_axis);
-                pl_data->feed_rate         = cartesian_feed_rate * motor_segment_length / cartesian_segment_length;
-            }
-
-            // TODO: G93 pl_data->motion.inverseTime logic?? Does this even make sense for wallplotter?
-
-            // Remember the last motor position so the length can be computed the next time
-            copyAxes(last_motor_segment_end, motor_segment_end);
-
-            // Initiate motor movement with converted feedrate and converted position
-            // mc_move_motors() returns false if a jog is cancelled.
-            // In that case we stop sending segments to the planner.
-            // Note that the left motor runs backward.
-            // TODO: It might be better to adjust motor direction in .yaml file by inverting direction pin??
-            float cables[n_axis];
-            cables[0] = 0 - (motor_segment_end[0] - zero_left);
-            cables[1] = 0 + (motor_segment_end[1] - zero_right);
-            for (size_t axis = Z_AXIS; axis < n_axis; axis++) {
-                cables[axis] = cartesian_segment_end[axis];
-            }
-            if (!mc_move_motors(cables, pl_data)) {
-                // TODO fixup last_left last_right?? What is position state when jog is cancelled?
-                return false;
-            }
-        }
-        return true;
+        return segment_by_chord_error(target, pl_data, position, _chord_tolerance, _segment_length, _min_segment_length);
     }
 
     /*
@@ -28,7 +28,7 @@ namespace Kinematics {
         void init_position() override;
         bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
         void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
-        void transform_cartesian_to_motors(float* cartesian, float* motors) override;
+        void transform_cartesian_to_motors(float* motors, float* cartesian) override;
 
         // Configuration handlers:
         void validate() override {}
@@ -47,16 +47,17 @@ namespace Kinematics {
         // State
         float zero_left;   //  The left cord offset corresponding to cartesian (0, 0).
         float zero_right;  //  The right cord offset corresponding to cartesian (0, 0).
-        float last_motor_segment_end[MAX_N_AXIS];
 
         // Parameters
         int   _left_axis     = 0;
         float _left_anchor_x = -100;
         float _left_anchor_y = 100;
 
-        int   _right_axis     = 1;
-        float _right_anchor_x = 100;
-        float _right_anchor_y = 100;
-        float _segment_length = 10;
+        int   _right_axis         = 1;
+        float _right_anchor_x     = 100;
+        float _right_anchor_y     = 100;
+        float _segment_length     = 10;    // Longest segment, in the middle of the wall
+        float _min_segment_length = 0.5;   // Shortest segment, near the anchors
+        float _chord_tolerance    = 0.01;  // Largest departure of a segment from the straight path, in mm
     };
 }  //  namespace Kinematics
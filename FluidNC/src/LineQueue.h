@@ -0,0 +1,80 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// LineQueue is a bounded ring of input lines between the polling task, which
+// reads them, and the main loop, which executes them in order and
+// acknowledges each one on the channel it came from.  Because the poller can
+// read ahead while a line is executing, the main loop does not wait for the
+// next line to be collected after every line.
+//
+// There is exactly one producer (the polling task) and one consumer (the main
+// loop), so the only shared state is the pair of indices.
+
+#include "Channel.h"
+
+#include <atomic>
+
+class LineQueue {
+public:
+    static const int depth = 8;
+
+private:
+    struct Entry {
+        Channel* channel;
+        char     line[Channel::maxLine];
+    };
+
+    Entry            _entries[depth];
+    std::atomic<int> _head { 0 };  // next entry to execute, advanced by the consumer
+    std::atomic<int> _tail { 0 };  // next entry to fill, advanced by the producer
+
+    static int next(int index) { return (index + 1) % depth; }
+
+public:
+    // Producer: the line buffer for the next entry, or nullptr if the queue is full
+    char* reserve() {
+        int tail = _tail.load(std::memory_order_relaxed);
+        return next(tail) == _head.load(std::memory_order_acquire) ? nullptr : _entries[tail].line;
+    }
+
+    // Producer: makes the line in the reserved buffer available to the consumer
+    void push(Channel* channel) {
+        int tail               = _tail.load(std::memory_order_relaxed);
+        _entries[tail].channel = channel;
+        _tail.store(next(tail), std::memory_order_release);
+    }
+
+    // Producer: whether a line of the channel is waiting or still executing.
+    // A channel that has been killed must not be deleted until this is false,
+    // so that its last lines are executed and acked.
+    bool holds(Channel* channel) {
+        int tail = _tail.load(std::memory_order_relaxed);
+        for (int i = _head.load(std::memory_order_acquire); i != tail; i = next(i)) {
+            if (_entries[i].channel == channel) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Consumer: the oldest line and its channel, without removing it
+    bool front(char*& line, Channel*& channel) {
+        int head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        line    = _entries[head].line;
+        channel = _entries[head].channel;
+        return true;
+    }
+
+    // Consumer: removes the oldest line, after it has been executed
+    void pop() { _head.store(next(_head.load(std::memory_order_relaxed)), std::memory_order_release); }
+
+    // Consumer: discards all pending lines, after a reset
+    void flush() { _head.store(_tail.load(std::memory_order_acquire), std::memory_order_release); }
+};
+
+extern LineQueue lineQueue;
@@ -0,0 +1,40 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "LogLine.h"
+
+#include <cstring>
+
+static LogLine pool[LogLine::poolSize];
+
+LogLine* LogLine::claim() {
+    for (auto& line : pool) {
+        bool inUse = false;
+        if (line._inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            line._length  = 0;
+            line._text[0] = '\0';
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+void LogLine::release() {
+    _inUse.store(false, std::memory_order_release);
+}
+
+size_t LogLine::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+// A write that does not fit is not stored at all, so the caller can move the
+// whole line elsewhere
+size_t LogLine::write(const uint8_t* buffer, size_t length) {
+    if (length > maxLength - _length) {
+        return 0;
+    }
+    memcpy(_text + _length, buffer, length);
+    _length += length;
+    _text[_length] = '\0';
+    return length;
+}
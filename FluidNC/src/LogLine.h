@@ -0,0 +1,42 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  LogLine is a Print that collects one log message in a fixed buffer from a
+  preallocated pool, so that logging does not allocate a std::string for every
+  line.  LogStream claims one, and send_line() hands it to the output task,
+  which releases it after it has been written.  The pool is a little larger
+  than the output queue, so it only runs out when many tasks are logging at
+  once; LogStream then uses a std::string as it did before, as it also does
+  for the occasional line that is too long for the buffer.
+*/
+
+#include <Print.h>
+
+#include <atomic>
+#include <cstdint>
+
+class LogLine : public Print {
+public:
+    static const size_t maxLength = 255;
+    static const int    poolSize  = 20;
+
+    // Returns an empty line from the pool, or nullptr if all of them are in use
+    static LogLine* claim();
+    void            release();
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
+
+    const char* c_str() const { return _text; }
+    size_t      length() const { return _length; }
+
+private:
+    char   _text[maxLength + 1] = "";
+    size_t _length              = 0;
+
+    std::atomic<bool> _inUse { false };
+};
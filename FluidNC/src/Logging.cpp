@@ -5,25 +5,47 @@
 #include "Protocol.h"
 #include "Serial.h"
 #include "SettingsDefinitions.h"
+#include "LogLine.h"
 
 bool atMsgLevel(MsgLevel level) {
     return message_level == nullptr || message_level->get() >= level;
 }
 
 LogStream::LogStream(Print& channel, const char* name) : _channel(channel) {
-    _line = new std::string();
+    _pooled = LogLine::claim();
+    if (!_pooled) {
+        _line = new std::string();
+    }
     print(name);
 }
 LogStream::LogStream(const char* name) : LogStream(allChannels, name) {}
 
 size_t LogStream::write(uint8_t c) {
-    *_line += (char)c;
-    return 1;
+    return write(&c, 1);
+}
+
+size_t LogStream::write(const uint8_t* buffer, size_t length) {
+    if (_pooled) {
+        if (_pooled->write(buffer, length) == length) {
+            return length;
+        }
+        // Too long for a pooled line
+        _line = new std::string(_pooled->c_str(), _pooled->length());
+        _pooled->release();
+        _pooled = nullptr;
+    }
+    _line->append(reinterpret_cast<const char*>(buffer), length);
+    return length;
 }
 
 LogStream::~LogStream() {
-    if ((*_line).length() && (*_line)[0] == '[') {
-        *_line += ']';
+    const char* text = _pooled ? _pooled->c_str() : _line->c_str();
+    if (text[0] == '[') {
+        write(']');
+    }
+    if (_pooled) {
+        send_line(_channel, _pooled);
+    } else {
+        send_line(_channel, _line);
     }
-    send_line(_channel, _line);
 }
@@ -31,16 +31,20 @@ enum MsgLevel {
 
 #include "MyIOStream.h"
 
+class LogLine;
+
 class LogStream : public Print {
 public:
     LogStream(Print& channel, const char* name);
     LogStream(const char* name);
     size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
     ~LogStream();
 
 private:
     Print&       _channel;
-    std::string* _line;
+    LogLine*     _pooled = nullptr;  // Until the pool runs out or the line outgrows it
+    std::string* _line   = nullptr;
 };
 
 extern bool atMsgLevel(MsgLevel level);
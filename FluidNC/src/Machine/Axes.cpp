@@ -7,6 +7,7 @@
 #include "../Stepper.h"     // stepper_id_t
 #include "MachineConfig.h"  // config->
 #include "../Limits.h"
+#include "Driver/fluidnc_gpio.h"  // gpio_write_masks
 
 EnumItem axisType[] = { { 0, "X" }, { 1, "Y" }, { 2, "Z" }, { 3, "A" }, { 4, "B" }, { 5, "C" }, EnumItem(0) };
 
@@ -101,20 +102,25 @@ namespace Machine {
         if (dir_mask != previous_dir) {
             previous_dir = dir_mask;
 
+            GpioMasks pins;
             for (int axis = X_AXIS; axis < n_axis; axis++) {
                 bool thisDir = bitnum_is_true(dir_mask, axis);
 
+                pins.set |= _dirMasks[axis][thisDir].set;
+                pins.clear |= _dirMasks[axis][thisDir].clear;
                 for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
                     auto m = _axis[axis]->_motors[motor];
-                    if (m) {
+                    if (m && bitnum_is_false(_directDir, motor_bit(axis, motor))) {
                         m->_driver->set_direction(thisDir);
                     }
                 }
             }
+            gpio_write_masks(pins.set, pins.clear);
             config->_stepping->waitDirection();
         }
 
         // Turn on step pulses for motors that are supposed to step now
+        GpioMasks pins;
         for (size_t axis = X_AXIS; axis < n_axis; axis++) {
             if (bitnum_is_true(step_mask, axis)) {
                 bool dir = bitnum_is_true(dir_mask, axis);
@@ -122,23 +128,33 @@ namespace Machine {
                 auto a = _axis[axis];
                 for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
                     auto m = a->_motors[motor];
-                    if (m) {
+                    if (!m) {
+                        continue;
+                    }
+                    if (bitnum_is_true(_directStep, motor_bit(axis, motor))) {
+                        if (m->count_step(dir)) {
+                            pins.set |= _stepMasks[axis][motor].set;
+                            pins.clear |= _stepMasks[axis][motor].clear;
+                        }
+                    } else {
                         m->step(dir);
                     }
                 }
             }
         }
+        gpio_write_masks(pins.set, pins.clear);
         config->_stepping->startPulseTimer();
     }
 
     // Turn all stepper pins off
     void IRAM_ATTR Axes::unstep() {
         config->_stepping->waitPulse();
+        gpio_write_masks(_unstepMasks.set, _unstepMasks.clear);
         auto n_axis = _numberAxis;
         for (size_t axis = X_AXIS; axis < n_axis; axis++) {
             for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
                 auto m = _axis[axis]->_motors[motor];
-                if (m) {
+                if (m && bitnum_is_false(_directStep, motor_bit(axis, motor))) {
                     m->_driver->unstep();
                 }
             }
@@ -151,6 +167,36 @@ namespace Machine {
         for (int axis = 0; axis < _numberAxis; ++axis) {
             _axis[axis]->config_motors();
         }
+
+        // Collect the pins that step() and unstep() can drive directly
+        _directStep  = 0;
+        _directDir   = 0;
+        _unstepMasks = GpioMasks();
+        for (int axis = 0; axis < _numberAxis; ++axis) {
+            _dirMasks[axis][0] = GpioMasks();
+            _dirMasks[axis][1] = GpioMasks();
+            for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
+                _stepMasks[axis][motor] = GpioMasks();
+                auto m                  = _axis[axis]->_motors[motor];
+                if (!m || !m->_driver) {
+                    continue;
+                }
+                auto pins = m->_driver->direct_pins();
+                if (pins.step) {
+                    set_bitnum(_directStep, motor_bit(axis, motor));
+                    auto& active   = _stepMasks[axis][motor];
+                    auto& inactive = _unstepMasks;
+                    (pins.stepInvert ? active.clear : active.set) |= pins.stepMask;
+                    (pins.stepInvert ? inactive.set : inactive.clear) |= pins.stepMask;
+                }
+                if (pins.direction) {
+                    set_bitnum(_directDir, motor_bit(axis, motor));
+                    (pins.dirInvert ? _dirMasks[axis][1].clear : _dirMasks[axis][1].set) |= pins.dirMask;
+                    (pins.dirInvert ? _dirMasks[axis][0].set : _dirMasks[axis][0].clear) |= pins.dirMask;
+                }
+            }
+        }
+        log_debug("Direct step motors:" << motorMaskToNames(_directStep) << " direction:" << motorMaskToNames(_directDir));
     }
 
     // Some small helpers to find the axis index and axis motor index for a given motor. This
@@ -81,6 +81,22 @@ namespace Machine {
         void afterParse() override;
 
         ~Axes();
+
+    private:
+        // Step and direction pins on native GPIOs are driven with a few
+        // register writes from masks that config_motors() builds, instead of a
+        // virtual call per pin.  Other motors - RMT, I2SO and extender pins,
+        // servos - go through their drivers.
+        struct GpioMasks {
+            uint64_t set   = 0;
+            uint64_t clear = 0;
+        };
+
+        GpioMasks _stepMasks[MAX_N_AXIS][Axis::MAX_MOTORS_PER_AXIS];  // Step pins active
+        GpioMasks _dirMasks[MAX_N_AXIS][2];                            // Direction pins, for each value of the direction bit
+        GpioMasks _unstepMasks;                                        // All direct step pins inactive
+        MotorMask _directStep = 0;
+        MotorMask _directDir  = 0;
     };
 }
 extern EnumItem axisType[];
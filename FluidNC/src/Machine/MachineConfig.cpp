@@ -19,6 +19,7 @@
 #include "../Configuration/ParserHandler.h"
 #include "../Configuration/Validator.h"
 #include "../Configuration/AfterParse.h"
+#include "../Configuration/PathIndex.h"
 #include "../Configuration/ParseException.h"
 #include "../Config.h"  // ENABLE_*
 
@@ -90,7 +91,7 @@ namespace Machine {
         handler.item("report_inches", _reportInches);
         handler.item("enable_parking_override_control", _enableParkingOverrideControl);
         handler.item("use_line_numbers", _useLineNumbers);
-        handler.item("planner_blocks", _planner_blocks, 10, 120);
+        handler.item("planner_blocks", _planner_blocks, 10, 1000);
     }
 
     void MachineConfig::groupM4Items(Configuration::HandlerBase& handler) {
@@ -121,6 +122,9 @@ namespace Machine {
         handler.item(M+"_Acceptable_Calibration_Threshold", Maslow.acceptableCalibrationThreshold, 0, 1);
 	handler.item(M+"_beltEndExtension", Maslow._beltEndExtension);
 	handler.item(M+"_armLength", Maslow._armLength);
+        handler.item(M+"_control_frequency_hz", Maslow.controlFrequencyHz, 100, 1000);
+        handler.item(M+"_velocity_feed_forward", Maslow.velocityFeedForward, 0, 1000);
+        handler.item(M+"_acceleration_feed_forward", Maslow.accelerationFeedForward, 0, 100);
     }
 
     void MachineConfig::afterParse() {
@@ -199,6 +203,10 @@ namespace Machine {
         if (_macros == nullptr) {
             _macros = new Macros();
         }
+
+        // The frame geometry and the control frequency may have been changed by a $/ command
+        Maslow.updateCenterXY();
+        Maslow.updateControlFrequency();
     }
 
     // Common Default Config partial strings
@@ -309,6 +317,7 @@ namespace Machine {
             {
                 auto& machineConfig = instance();
                 if (machineConfig != nullptr) {
+                    Configuration::PathIndex::invalidate();
                     delete machineConfig;
                 }
                 machineConfig = new MachineConfig();
@@ -325,6 +334,9 @@ namespace Machine {
                 config->group(afterParse);
             } catch (std::exception& ex) { log_error("Validation error: " << ex.what()); }
 
+            // Sections are all in place now, so $/ settings can find them by path
+            Configuration::PathIndex::build(config);
+
             log_debug("Checking configuration");
 
             try {
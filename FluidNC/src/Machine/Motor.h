@@ -49,6 +49,16 @@ namespace Machine {
         void init();
         void config_motor();
         void step(bool reverse);
+
+        // Counts a step for a motor whose step pin is driven directly, and
+        // returns false if the motor must not step
+        inline bool count_step(bool reverse) {
+            if (_blocked || _limited) {
+                return false;
+            }
+            _steps += reverse ? -1 : 1;
+            return true;
+        }
         void unstep();
         void block() { _blocked = true; }
         void unblock() { _blocked = false; }
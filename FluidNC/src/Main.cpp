@@ -19,6 +19,7 @@
 #    include "MotionControl.h"
 #    include "Platform.h"
 #    include "StartupLog.h"
+#    include "LineQueue.h"
 
 #    include "WebUI/TelnetServer.h"
 #    include "WebUI/InputBuffer.h"
@@ -200,6 +201,7 @@ static void reset_variables() {
     plan_sync_position();
     gc_sync_position();
     allChannels.flushRx();
+    lineQueue.flush();
     report_init_message(allChannels);
     mc_init();
 
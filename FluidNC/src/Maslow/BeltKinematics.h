@@ -0,0 +1,75 @@
+// Copyright (c) 2024 Maslow CNC. All rights reserved.
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file with
+// following exception: it may not be used for any reason by MakerMade or anyone with a business or personal connection to MakerMade
+
+#pragma once
+
+#include <cmath>
+
+// Inverse kinematics for the four belts, computed together from a table of anchor points.
+// The table holds each anchor relative to the center of the frame, so that a target needs no
+// offsetting, and the length that the arm and belt end add to every belt. It must be rebuilt
+// with setAnchors() whenever the frame geometry changes.
+class BeltKinematics {
+public:
+    static const int nBelts = 4;  // In the order TL, TR, BL, BR
+
+    // Corner coordinates are those of the configuration, with the lower left corner at 0,0
+    void setAnchors(const float cornerX[nBelts],
+                    const float cornerY[nBelts],
+                    const float cornerZ[nBelts],
+                    float       centerX,
+                    float       centerY,
+                    float       beltEndExtension,
+                    float       armLength) {
+        for (int i = 0; i < nBelts; i++) {
+            _anchorX[i] = cornerX[i] - centerX;
+            _anchorY[i] = cornerY[i] - centerY;
+            _anchorZ[i] = cornerZ[i];
+        }
+        _offset = beltEndExtension + armLength;
+    }
+
+    // Belt lengths in mm for a target in frame-centered coordinates
+    void compute(float x, float y, float z, float lengths[nBelts]) const {
+        for (int i = 0; i < nBelts; i++) {
+            float a = _anchorX[i] - x;  // X dist from corner to router center
+            float b = _anchorY[i] - y;  // Y dist from corner to router center
+            float c = z + _anchorZ[i];  // Z dist from corner to router center, only ever squared
+
+            float XYBeltLength = sqrtf(a * a + b * b) - _offset;  // Belt length in the XY plane, less the arm and belt end
+            lengths[i]         = sqrtf(XYBeltLength * XYBeltLength + c * c);
+        }
+    }
+
+    // Frame-centered XY position for the given top belt lengths and Z. The bottom belts only
+    // hold the sled against the frame, so the top pair fixes the position, below their anchors.
+    void position(float tlLength, float trLength, float z, float& x, float& y) const {
+        float r0 = xyDistance(0, tlLength, z);
+        float r1 = xyDistance(1, trLength, z);
+
+        // Intersection of the circles around the two anchors, see http://paulbourke.net/geometry/circlesphere/
+        float dx = _anchorX[1] - _anchorX[0];
+        float dy = _anchorY[1] - _anchorY[0];
+        float d  = sqrtf(dx * dx + dy * dy);
+        float a  = (r0 * r0 - r1 * r1 + d * d) / (2 * d);
+        float h2 = r0 * r0 - a * a;
+        float h  = h2 > 0 ? sqrtf(h2) : 0;
+
+        x = _anchorX[0] + (a * dx + h * dy) / d;
+        y = _anchorY[0] + (a * dy - h * dx) / d;
+    }
+
+private:
+    // Distance in the XY plane from anchor i to the router center, the inverse of compute()
+    float xyDistance(int i, float length, float z) const {
+        float c  = z + _anchorZ[i];
+        float l2 = length * length - c * c;
+        return (l2 > 0 ? sqrtf(l2) : 0) + _offset;
+    }
+
+    float _anchorX[nBelts] = { 0 };
+    float _anchorY[nBelts] = { 0 };
+    float _anchorZ[nBelts] = { 0 };
+    float _offset          = 0;
+};
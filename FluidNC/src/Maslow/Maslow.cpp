@@ -8,6 +8,11 @@
 #include "../Protocol.h"
 #include "../System.h"
 #include "../FileStream.h"
+#include "../Stepper.h"
+#include "../Kinematics/Maslow.h"
+#include "../Machine/MachineConfig.h"
+
+#include <esp_timer.h>
 
 // Maslow specific defines
 #define VERSION_NUMBER "0.87"
@@ -60,7 +65,11 @@ int ENCODER_READ_FREQUENCY_HZ = 1000;  //max frequency for polling the encoders
 
 // Initialization function
 void Maslow_::begin(void (*sys_rt)()) {
-    Wire.begin(5, 4, 200000);
+    if (i2cMutex == nullptr) {
+        controlMutex = xSemaphoreCreateMutex();
+        i2cMutex     = xSemaphoreCreateMutex();
+    }
+    Wire.begin(5, 4, 400000);  //Fast mode, which the mux and the encoders support, so a control cycle fits its period
     I2CMux.begin(TCAADDR, Wire);
 
     axisTL.begin(tlIn1Pin, tlIn2Pin, tlADCPin, TLEncoderLine, tlIn1Channel, tlIn2Channel);
@@ -99,10 +108,24 @@ void Maslow_::begin(void (*sys_rt)()) {
     } else {
         log_info("Starting "+M+" Version " << VERSION_NUMBER);
     }
+
+    startControlTask();
 }
 
 // Maslow main loop, everything is processed here
 void Maslow_::update() {
+    //Settings can run the realtime loop while they load, which is before begin() has set up the encoder bus
+    if (i2cMutex == nullptr) {
+        return;
+    }
+
+    //The control task reads and drives the same belts, so it waits until the whole pass is done
+    xSemaphoreTake(controlMutex, portMAX_DELAY);
+    mainLoop();
+    xSemaphoreGive(controlMutex);
+}
+
+void Maslow_::mainLoop() {
     static State prevState = sys.state();
 
     //If we are in an error state, blink the LED and stop the motors
@@ -144,7 +167,11 @@ void Maslow_::update() {
     if (!Maslow.using_default_config) {
         lastCallToUpdate = millis();
 
-        Maslow.updateEncoderPositions();  //We always update encoder positions in any state,
+        //We always update encoder positions in any state. The control task does it when it is running
+        if (!controlTaskRunning) {
+            Maslow.updateEncoderPositions();
+            recordTelemetry(0);
+        }
 
         axisTL.update();  //update motor currents and belt speeds like this for now
         axisTR.update();
@@ -169,13 +196,9 @@ void Maslow_::update() {
 
         //-------Jog or G-code execution.
         if (sys.state() == State::Jog || sys.state() == State::Cycle) {
-            Maslow.setTargets(steps_to_mpos(get_axis_motor_steps(0), 0),
-                              steps_to_mpos(get_axis_motor_steps(1), 1),
-                              steps_to_mpos(get_axis_motor_steps(2), 2));
-
-            //This disables the belt motors until the user has completed calibration or apply tension and they have succeded
-            if (setupComplete()) {
-                Maslow.recomputePID();
+            //The control task drives the belts at a fixed rate, this is only a fallback if it could not be started
+            if (!controlTaskRunning) {
+                Maslow.followMotion();
             }
         }
         //--------Homing routines
@@ -519,7 +542,8 @@ void Maslow_::deallocateCalibrationMemory() {
 //------------------------------------------------------ Core utility functions
 //------------------------------------------------------
 
-//updating encoder positions for all 4 arms, cycling through them each call, at ENCODER_READ_FREQUENCY_HZ frequency
+//updating encoder positions for all 4 arms. The control task calls this every cycle, otherwise reads are limited to
+//ENCODER_READ_FREQUENCY_HZ
 bool Maslow_::updateEncoderPositions() {
     bool                 success               = true;
     static unsigned long lastCallToEncoderRead = millis();
@@ -527,35 +551,19 @@ bool Maslow_::updateEncoderPositions() {
     static int           encoderFailCounter[4] = { 0, 0, 0, 0 };
     static unsigned long encoderFailTimer      = millis();
 
-    if (!readingFromSD && (millis() - lastCallToEncoderRead > 1000 / (ENCODER_READ_FREQUENCY_HZ))) {
-        static int encoderToRead = 0;
-        switch (encoderToRead) {
-            case 0:
-                if (!axisTL.updateEncoderPosition()) {
-                    encoderFailCounter[TLEncoderLine]++;
-                }
-                break;
-            case 1:
-                if (!axisTR.updateEncoderPosition()) {
-                    encoderFailCounter[TREncoderLine]++;
-                }
-                break;
-            case 2:
-                if (!axisBL.updateEncoderPosition()) {
-                    encoderFailCounter[BLEncoderLine]++;
-                }
-                break;
-            case 3:
-                if (!axisBR.updateEncoderPosition()) {
-                    encoderFailCounter[BREncoderLine]++;
-                }
-                break;
-        }
-        encoderToRead++;
-        if (encoderToRead > 3) {
-            encoderToRead         = 0;
-            lastCallToEncoderRead = millis();
+    int readFrequency = controlTaskRunning ? controlFrequencyHz : ENCODER_READ_FREQUENCY_HZ;
+
+    if (controlTaskRunning || millis() - lastCallToEncoderRead > 1000 / (ENCODER_READ_FREQUENCY_HZ)) {
+        //Read all four, so that no belt is controlled from a position older than one cycle
+        MotorUnit* axis[4]        = { &axisTL, &axisTR, &axisBL, &axisBR };
+        const int  encoderLine[4] = { TLEncoderLine, TREncoderLine, BLEncoderLine, BREncoderLine };
+        for (int i = 0; i < 4; i++) {
+            if (!axis[i]->updateEncoderPosition()) {
+                encoderFailCounter[encoderLine[i]]++;
+                success = false;
+            }
         }
+        lastCallToEncoderRead = millis();
     }
 
     // if more than 1% of readings fail, warn user, if more than 10% fail, stop the machine and raise alarm
@@ -563,7 +571,7 @@ bool Maslow_::updateEncoderPositions() {
         for (int i = 0; i < 4; i++) {
             //turn i into proper label
             String label = axis_id_to_label(i);
-            if (encoderFailCounter[i] > 0.1 * ENCODER_READ_FREQUENCY_HZ) {
+            if (encoderFailCounter[i] > 0.1 * readFrequency) {
                 // log error statement with appropriate label
                 log_error("Failure on " << label.c_str() << " encoder, failed to read " << encoderFailCounter[i]
                                         << " times in the last second");
@@ -587,20 +595,106 @@ void Maslow_::setTargets(float xTarget, float yTarget, float zTarget, bool tl, b
     targetY = yTarget;
     targetZ = zTarget;
 
+    float lengths[BeltKinematics::nBelts];
+    belts().compute(xTarget, yTarget, zTarget, lengths);
+
     if (tl) {
-        axisTL.setTarget(computeTL(xTarget, yTarget, zTarget));
+        axisTL.setTarget(lengths[0]);
     }
     if (tr) {
-        axisTR.setTarget(computeTR(xTarget, yTarget, zTarget));
+        axisTR.setTarget(lengths[1]);
     }
     if (bl) {
-        axisBL.setTarget(computeBL(xTarget, yTarget, zTarget));
+        axisBL.setTarget(lengths[2]);
     }
     if (br) {
-        axisBR.setTarget(computeBR(xTarget, yTarget, zTarget));
+        axisBR.setTarget(lengths[3]);
+    }
+}
+
+// Gives each belt the speed and acceleration of the segment the steppers are executing, so the PIDs drive the belts
+// along the planned motion instead of only reacting once the target has moved. Call after setTargets().
+void Maslow_::setFeedForward() {
+    float unit_vec[MAX_N_AXIS] = { 0 };  //Axes beyond those configured stay at zero
+    float speed, acceleration;
+    if (!Stepper::get_exec_motion(unit_vec, speed, acceleration)) {
+        return;  //setTargets() left the targets at rest
+    }
+
+    //The steppers move the belts directly, so the path is already in belt lengths
+    if (beltSpace) {
+        speed /= 60;
+        acceleration /= 3600;
+        float d[BeltKinematics::nBelts];
+        for (int belt = 0; belt < BeltKinematics::nBelts; belt++) {
+            d[belt] = unit_vec[beltSpace->belt_axis(belt)];
+        }
+        axisTL.setFeedForward(d[0] * speed, d[0] * acceleration);
+        axisTR.setFeedForward(d[1] * speed, d[1] * acceleration);
+        axisBL.setFeedForward(d[2] * speed, d[2] * acceleration);
+        axisBR.setFeedForward(d[3] * speed, d[3] * acceleration);
+        return;
+    }
+
+    //Rate of change of each belt length per mm along the path, by stepping a short distance along it
+    const float step = 0.1;
+    float       lengths[BeltKinematics::nBelts];
+    belts().compute(targetX + unit_vec[0] * step, targetY + unit_vec[1] * step, targetZ + unit_vec[2] * step, lengths);
+    float dTL = (lengths[0] - axisTL.getTarget()) / step;
+    float dTR = (lengths[1] - axisTR.getTarget()) / step;
+    float dBL = (lengths[2] - axisBL.getTarget()) / step;
+    float dBR = (lengths[3] - axisBR.getTarget()) / step;
+
+    //The stepper works in mm/min and mm/min^2
+    speed /= 60;
+    acceleration /= 3600;
+    axisTL.setFeedForward(dTL * speed, dTL * acceleration);
+    axisTR.setFeedForward(dTR * speed, dTR * acceleration);
+    axisBL.setFeedForward(dBL * speed, dBL * acceleration);
+    axisBR.setFeedForward(dBR * speed, dBR * acceleration);
+}
+
+// Drives the belts toward the current step position, during jogs and G-code execution
+void Maslow_::followMotion() {
+    if (beltSpace) {
+        setTargetsFromMotors();
+    } else {
+        setTargets(steps_to_mpos(get_axis_motor_steps(0), 0),
+                   steps_to_mpos(get_axis_motor_steps(1), 1),
+                   steps_to_mpos(get_axis_motor_steps(2), 2));
+    }
+    setFeedForward();
+
+    //This disables the belt motors until the user has completed calibration or apply tension and they have succeded
+    if (setupComplete()) {
+        recomputePID();
     }
 }
 
+// With the Maslow kinematic system the planner has already segmented the move in belt space, so the belt targets are
+// the motor positions themselves, with no inverse kinematics per cycle
+void Maslow_::setTargetsFromMotors() {
+    float motors[MAX_N_AXIS] = { 0 };
+    auto  n_axis             = config->_axes->_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        motors[axis] = steps_to_mpos(get_axis_motor_steps(axis), axis);
+    }
+
+    float lengths[BeltKinematics::nBelts];
+    beltSpace->motors_to_belts(motors, lengths);
+    axisTL.setTarget(lengths[0]);
+    axisTR.setTarget(lengths[1]);
+    axisBL.setTarget(lengths[2]);
+    axisBR.setTarget(lengths[3]);
+
+    //Keep the getTargetN() functions meaningful
+    float cartesian[MAX_N_AXIS];
+    beltSpace->motors_to_cartesian(cartesian, motors, n_axis);
+    targetX = cartesian[X_AXIS];
+    targetY = cartesian[Y_AXIS];
+    targetZ = cartesian[Z_AXIS];
+}
+
 //updates motor powers for all axis, based on targets set by setTargets()
 void Maslow_::recomputePID() {
     axisBL.recomputePID();
@@ -616,6 +710,128 @@ void Maslow_::recomputePID() {
     }
 }
 
+//------------------------------------------------------
+//------------------------------------------------------ Belt control task
+//------------------------------------------------------
+
+static TaskHandle_t       controlTask   = nullptr;
+static esp_timer_handle_t controlTimer  = nullptr;
+static uint64_t           controlPeriod = 0;  //The period the timer is armed with, in microseconds
+
+static void control_timer_callback(void* arg) {
+    xTaskNotifyGive(controlTask);
+}
+
+// Starts the task that samples the encoders and updates the belt PIDs, woken by a periodic timer at controlFrequencyHz
+void Maslow_::startControlTask() {
+    if (controlTask) {  //begin() runs again after every reset
+        return;
+    }
+
+    //Same core as the main loop, away from WiFi, and at a higher priority so the main loop cannot delay it. The task
+    //sleeps while each I2C transfer is on the bus, so the main loop loses less than the "busy" share that $CTL reports
+    xTaskCreatePinnedToCore(control_loop,                // task
+                            "maslowControl",             // name for task
+                            8192,                        // size of task stack
+                            0,                           // parameters
+                            2,                           // priority
+                            &controlTask,                // task handle
+                            CONFIG_ARDUINO_RUNNING_CORE  // core
+    );
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback                = control_timer_callback;
+    timerArgs.name                    = "maslowControl";
+    controlPeriod = 1000000 / controlFrequencyHz;
+    if (esp_timer_create(&timerArgs, &controlTimer) != ESP_OK || esp_timer_start_periodic(controlTimer, controlPeriod) != ESP_OK) {
+        log_error(M + " control timer could not be started, the belts will be updated from the main loop");
+        return;
+    }
+    controlTaskRunning = true;
+    log_info(M + " control loop running at " << controlFrequencyHz << "Hz");
+}
+
+// Re-arms the control timer if controlFrequencyHz has been changed, such as by a $/ command, since it was started
+void Maslow_::updateControlFrequency() {
+    uint64_t period = 1000000 / controlFrequencyHz;
+    if (!controlTaskRunning || period == controlPeriod) {
+        return;
+    }
+    esp_timer_stop(controlTimer);
+    if (esp_timer_start_periodic(controlTimer, period) != ESP_OK) {
+        //Keep the belts under control at the rate that was running
+        log_error(M + " control timer could not be changed to " << controlFrequencyHz << "Hz");
+        controlFrequencyHz = 1000000 / controlPeriod;
+        esp_timer_start_periodic(controlTimer, controlPeriod);
+        return;
+    }
+    controlPeriod = period;
+    getControlStats(true);  //The old timing no longer applies
+    log_info(M + " control loop running at " << controlFrequencyHz << "Hz");
+}
+
+// One cycle of the control loop: read all four encoders, then drive the belts toward the current step position
+void Maslow_::controlLoop() {
+    int64_t start = esp_timer_get_time();
+    if (lastControlCycle) {
+        uint32_t period = start - lastControlCycle;
+        portENTER_CRITICAL(&controlStatsMux);
+        controlStats.cycles++;
+        controlStats.totalPeriod += period;
+        controlStats.minPeriod = std::min(controlStats.minPeriod, period);
+        controlStats.maxPeriod = std::max(controlStats.maxPeriod, period);
+        portEXIT_CRITICAL(&controlStatsMux);
+    }
+    lastControlCycle = start;
+
+    if (using_default_config || error) {
+        return;
+    }
+
+    //Positions, targets, PID state and holding are shared with the main loop, which changes them under the same lock
+    xSemaphoreTake(controlMutex, portMAX_DELAY);
+    updateEncoderPositions();
+
+    if ((sys.state() == State::Jog || sys.state() == State::Cycle) && !holding) {
+        followMotion();
+    }
+    xSemaphoreGive(controlMutex);
+
+    uint32_t work = esp_timer_get_time() - start;
+    portENTER_CRITICAL(&controlStatsMux);
+    controlStats.maxWork = std::max(controlStats.maxWork, work);
+    controlStats.totalWork += work;
+    if (work > 1000000 / controlFrequencyHz) {
+        controlStats.overruns++;
+    }
+    portEXIT_CRITICAL(&controlStatsMux);
+
+    recordTelemetry(work);
+}
+
+// Returns the control loop timing since the last reset
+ControlLoopStats Maslow_::getControlStats(bool reset) {
+    portENTER_CRITICAL(&controlStatsMux);
+    ControlLoopStats stats = controlStats;
+    if (reset) {
+        controlStats = ControlLoopStats();
+    }
+    portEXIT_CRITICAL(&controlStatsMux);
+    return stats;
+}
+
+void Maslow_::reportControlStats() {
+    ControlLoopStats stats = getControlStats(true);
+    if (!controlTaskRunning || stats.cycles == 0) {
+        log_info(M + " control loop is not running");
+        return;
+    }
+    log_info(M + " control loop at " << controlFrequencyHz << "Hz, " << stats.cycles << " cycles, period min " << stats.minPeriod
+                                     << "us mean " << uint32_t(stats.totalPeriod / stats.cycles) << "us max " << stats.maxPeriod
+                                     << "us, work max " << stats.maxWork << "us, " << stats.overruns << " overruns, busy "
+                                     << uint32_t(stats.totalWork * 100 / stats.totalPeriod) << "% of the main loop core");
+}
+
 //This is the function that should prevent machine from damaging itself
 void Maslow_::safety_control() {
     //We need to keep track of average belt speeds and motor currents for every axis
@@ -1962,6 +2178,24 @@ void Maslow_::updateCenterXY() {
     double B = (brY - tlY) / (brX - tlX);
     centerX  = (brY - (B * brX) + (A * trX) - trY) / (A - B);
     centerY  = A * (centerX - trX) + trY;
+
+    const float    cornerX[] = { tlX, trX, blX, brX };
+    const float    cornerY[] = { tlY, trY, blY, brY };
+    const float    cornerZ[] = { tlZ, trZ, blZ, brZ };
+    BeltKinematics table;
+    table.setAnchors(cornerX, cornerY, cornerZ, centerX, centerY, _beltEndExtension, _armLength);
+
+    portENTER_CRITICAL(&beltsMux);
+    beltKinematics = table;
+    portEXIT_CRITICAL(&beltsMux);
+}
+
+// Returns a copy of the anchor table, which cannot change while it is in use
+BeltKinematics Maslow_::belts() {
+    portENTER_CRITICAL(&beltsMux);
+    BeltKinematics table = beltKinematics;
+    portEXIT_CRITICAL(&beltsMux);
+    return table;
 }
 
 // Prints out state
@@ -1980,262 +2214,147 @@ void Maslow_::getInfo() {
           << "}");
 }
 
+//------------------------------------------------------
+//------------------------------------------------------ Telemetry
+//------------------------------------------------------
+
+// A quarter second of records at 1kHz, for when the SD card is slow to write
+static TelemetryRing<TelemetryRecord, 256> telemetryRing;
+
+// Records are written to the file in blocks of this many
+static const size_t telemetryBlockRecords = 64;
+
+static int16_t saturate16(double value) {
+    return int16_t(std::max(-32767.0, std::min(32767.0, round(value))));
+}
+
 void Maslow_::set_telemetry(bool enabled) {
-    if (enabled) {
-        // Start off the file with the length of each struct in it.
-        FileStream* file = new FileStream(MASLOW_TELEM_FILE, "w", "sd");
-        // write header
-        TelemetryFileHeader header;
-        header.structureSize = sizeof(TelemetryData);
-        strcpy(header.version, VERSION_NUMBER);
-        file->write(reinterpret_cast<uint8_t *>(&header), sizeof(TelemetryFileHeader));
-        file->flush();
-        delete file;
-    } else {
-        // TODO: not sure why this fails to find the file
-        // std::string filePath = MASLOW_TELEM_FILE;
-        // std::string newFilePath = filePath + "." + std::to_string(millis());
-        // std::error_code ec;
-        // log_info("renaming file: " + filePath + " to " + newFilePath);
-        // stdfs::rename(filePath, newFilePath, ec);
-        // if (ec) {
-        //     log_error(std::string("Error renaming file: ") + ec.message());
-        // }
-    }
+    // The telemetry task opens the file when it sees telemetry_enabled, and
+    // closes it after writing the last records once it is cleared
     telemetry_enabled = enabled;
-    log_info("Telemetry: " << (enabled? "enabled" : "disabled"));
-}
-
-void Maslow_::log_telem_hdr_csv() {
-    log_data(
-       "millis," <<
-       "tlCurrent," <<
-       "trCurrent," <<
-       "blCurrent," <<
-       "brCurrent," <<
-       "tlPower," <<
-       "trPower," <<
-       "blPower," <<
-       "brPower," <<
-       "tlSpeed," <<
-       "trSpeed," <<
-       "blSpeed," <<
-       "brSpeed," <<
-       "tlPos," <<
-       "trPos," <<
-       "blPos," <<
-       "brPos," <<
-       "extendedTL," <<
-       "extendedTR," <<
-       "extendedBL," <<
-       "extendedBR," <<
-       "extendingALL," <<
-       "complyALL," <<
-       "takeSlack," <<
-       "safetyOn," <<
-       "targetX," <<
-       "targetY," <<
-       "targetZ," <<
-       "x," <<
-       "y," <<
-       "test," <<
-       "pointCount," <<
-       "waypoint," <<
-       "calibrationGridSize," <<
-       "holdTimer," <<
-       "holding," <<
-       "holdTime," <<
-       "centerX," <<
-       "centerY," <<
-       "lastCallToPID," <<
-       "lastMiss," <<
-       "lastCallToUpdate," <<
-       "extendCallTimer," <<
-       "complyCallTimer");
-}
-
-void Maslow_::log_telem_pt_csv(TelemetryData data) {
-    log_data(
-       std::to_string(data.timestamp) + ","
-       + std::to_string(data.tlCurrent) + ","
-       + std::to_string(data.trCurrent)  + ","
-       + std::to_string(data.blCurrent)  + ","
-       + std::to_string(data.brCurrent)  + ","
-       + std::to_string(data.tlPower) + ","
-       + std::to_string(data.trPower) + ","
-       + std::to_string(data.blPower) + ","
-       + std::to_string(data.brPower) + ","
-       + std::to_string(data.tlSpeed) + ","
-       + std::to_string(data.trSpeed) + ","
-       + std::to_string(data.blSpeed) + ","
-       + std::to_string(data.brSpeed) + ","
-       + std::to_string(data.tlPos) + ","
-       + std::to_string(data.trPos) + ","
-       + std::to_string(data.blPos) + ","
-       + std::to_string(data.brPos) + ","
-       + std::to_string(data.extendedTL) + ","
-       + std::to_string(data.extendedTR) + ","
-       + std::to_string(data.extendedBL) + ","
-       + std::to_string(data.extendedBR) + ","
-       + std::to_string(data.extendingALL) + ","
-       + std::to_string(data.complyALL) + ","
-       + std::to_string(data.takeSlack) + ","
-       + std::to_string(data.safetyOn) + ","
-       + std::to_string(data.targetX) + ","
-       + std::to_string(data.targetY) + ","
-       + std::to_string(data.targetZ) + ","
-       + std::to_string(data.x) + ","
-       + std::to_string(data.y) + ","
-       + std::to_string(data.test) + ","
-       + std::to_string(data.pointCount) + ","
-       + std::to_string(data.waypoint) + ","
-       + std::to_string(data.calibrationGridSize) + ","
-       + std::to_string(data.holdTimer) + ","
-       + std::to_string(data.holding) + ","
-       + std::to_string(data.holdTime) + ","
-       + std::to_string(data.centerX) + ","
-       + std::to_string(data.centerY) + ","
-       + std::to_string(data.lastCallToPID) + ","
-       + std::to_string(data.lastMiss) + ","
-       + std::to_string(data.lastCallToUpdate) + ","
-       + std::to_string(data.extendCallTimer) + ","
-       + std::to_string(data.complyCallTimer)
-    )
-}
-
-TelemetryData Maslow_::get_telemetry_data() {
-    TelemetryData data;
-
-    // TODO: probably, we ought to use mutexes here?, but it is not implemented yet and
-    // it may not matter much. the reads are generally of types that don't
-    //if (xSemaphoreTake(telemetry_mutex, portMAX_DELAY)) {
-    // Access shared variables here
-    data.timestamp = millis();
-    data.tlCurrent = axisTL.getMotorCurrent();
-    data.trCurrent = axisTR.getMotorCurrent();
-    data.blCurrent = axisBL.getMotorCurrent();
-    data.brCurrent = axisBR.getMotorCurrent();
-
-    data.tlPower = axisTL.getMotorPower();
-    data.trPower = axisTR.getMotorPower();
-    data.blPower = axisBL.getMotorPower();
-    data.brPower = axisBR.getMotorPower();
-
-    data.tlSpeed = axisTL.getBeltSpeed();
-    data.trSpeed = axisTR.getBeltSpeed();
-    data.blSpeed = axisBL.getBeltSpeed();
-    data.brSpeed = axisBR.getBeltSpeed();
-
-    data.tlPos = axisTL.getPosition();
-    data.trPos = axisTR.getPosition();
-    data.blPos = axisBL.getPosition();
-    data.brPos = axisBR.getPosition();
-
-    data.extendedTL          = extendedTL;
-    data.extendedTR          = extendedTR;
-    data.extendedBL          = extendedBL;
-    data.extendedBR          = extendedBR;
-    data.extendingALL        = extendingALL;
-    data.complyALL           = complyALL;
-    data.takeSlack           = takeSlack;
-    data.safetyOn            = safetyOn;
-    data.targetX             = targetX;
-    data.targetY             = targetY;
-    data.targetZ             = targetZ;
-    data.x                   = x;
-    data.y                   = y;
-    data.test                = test;
-    data.pointCount          = pointCount;
-    data.waypoint            = waypoint;
-    data.calibrationGridSize = calibrationGridSize;
-    data.holdTimer           = holdTimer;
-    data.holding             = holding;
-    data.holdTime            = holdTime;
-    data.centerX             = centerX;
-    data.centerY             = centerY;
-    data.lastCallToPID       = lastCallToPID;
-    data.lastMiss            = lastMiss;
-    data.lastCallToUpdate    = lastCallToUpdate;
-    data.extendCallTimer     = extendCallTimer;
-    data.complyCallTimer     = complyCallTimer;
-    // xSemaphoreGive(telemetry_mutex);
-    //}
-    return data;
-}
-void Maslow_::write_telemetry_buffer(uint8_t* buffer, size_t length) {
-    // Open the file in append mode
-    FileStream* file = new FileStream(MASLOW_TELEM_FILE, "a", "sd");
-
-    // Write the buffer to the file
-    file->write(buffer, length);
-    file->flush();
-
-    // Close the file
-    delete file;
-}
-
-void Maslow_::dump_telemetry(const char* file) {
-    log_info("Dumping telemetry...");
-    vTaskDelay(2000 / portTICK_PERIOD_MS);
-    // open the file
-    FileStream* f = new FileStream(MASLOW_TELEM_FILE, "r", "sd");
-    if (f) {
-        // read the size of each struct from the file
-        TelemetryFileHeader header;
-        f->read(reinterpret_cast<char*>(&header), sizeof(TelemetryFileHeader));
-        log_info("Struct size " << header.structureSize);
-        log_info("Dump version " << header.version);
-        log_telem_hdr_csv();
-        // TODO: check version and adapt?
-        TelemetryData* data   = new TelemetryData();
-        char*          buffer = new char[header.structureSize];
-        while (f->available()) {
-            f->read(&buffer[0], header.structureSize);
-            // populate data from buffer
-            memcpy(data, buffer, header.structureSize);
-            // print the data
-            log_telem_pt_csv(*data);
-            // log_telem_pt(*data);
-        }
-        // delete the buffer
-        delete[] buffer;
-        // delete the data
-        delete data;
-    } else{
-        log_info("File not found")
+    log_info("Telemetry: " << (enabled ? "enabled" : "disabled"));
+}
+
+void Maslow_::recordTelemetry(uint32_t workUs) {
+    if (!telemetry_enabled) {
+        return;
+    }
+    MotorUnit* motors[4] = { &axisTL, &axisTR, &axisBL, &axisBR };
+
+    TelemetryRecord record;
+    record.time = uint32_t(esp_timer_get_time());
+    for (int i = 0; i < 4; i++) {
+        record.position[i] = motors[i]->getPosition();
+        record.error[i]    = saturate16(motors[i]->getPositionError() * 1000.0);
+        record.current[i]  = saturate16(motors[i]->getMotorCurrent());
+        record.power[i]    = saturate16(motors[i]->getMotorPower());
+        record.speed[i]    = saturate16(motors[i]->getBeltSpeed() * 100.0);
+    }
+    record.target[0] = targetX;
+    record.target[1] = targetY;
+
+    uint16_t flags = 0;
+    bool     bits[] = { extendedTL, extendedTR, extendedBL, extendedBR, extendingALL, complyALL,
+                        takeSlack,  safetyOn,   holding,    calibrationInProgress };
+    for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); i++) {
+        flags |= bits[i] << i;
+    }
+    record.flags = flags;
+    record.state = uint8_t(sys.state());
+    record.work  = uint8_t(std::min(workUs / 10, uint32_t(255)));
+
+    telemetryRing.push(record);
+}
+
+// Logs what is in a telemetry file.  The records themselves are decoded on a
+// computer, with decode-telemetry.py, after downloading the file.
+void Maslow_::dump_telemetry(const char* filename) {
+    if (telemetry_enabled) {
+        log_info("Telemetry is still being recorded");
+        return;
+    }
+    FileStream* f;
+    try {
+        f = new FileStream(filename, "r", "sd");
+    } catch (Error err) {
+        log_info("File not found");
+        return;
+    }
+
+    TelemetryFileHeader header;
+    TelemetryRecord     first, last;
+    if (f->read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) || memcmp(header.magic, "M4TL", 4)) {
+        log_info(filename << " is not a telemetry file, or is from an older firmware");
+    } else if (header.version != telemetryVersion || header.recordSize != sizeof(TelemetryRecord)) {
+        log_info(filename << " has telemetry version " << header.version << ", this firmware writes version " << telemetryVersion);
+    } else {
+        size_t records = (f->size() - sizeof(header)) / sizeof(TelemetryRecord);
+        if (records && f->read(reinterpret_cast<char*>(&first), sizeof(first)) == sizeof(first) &&
+            f->set_position(sizeof(header) + (records - 1) * sizeof(TelemetryRecord)) &&
+            f->read(reinterpret_cast<char*>(&last), sizeof(last)) == sizeof(last)) {
+            // The time wraps after 71 minutes, so longer recordings only show their length modulo that
+            uint32_t span = last.time - first.time;
+            log_info(filename << ": " << records << " records at " << header.sampleHz << "Hz over " << span / 1000 << "ms, firmware "
+                              << std::string(header.firmware, strnlen(header.firmware, sizeof(header.firmware))));
+        } else {
+            log_info(filename << " has no records");
+        }
+        log_info("Download it and run decode-telemetry.py to convert it to CSV");
     }
     delete f;
 }
 
-// Called on utility core as a task to gather telemetry and write it to an SD log
+// Called on utility core as a task to write recorded telemetry to an SD log.
+// The file stays open while telemetry is on, and is written in blocks.
 void telemetry_loop(void* unused) {
-    const int bufferSize = 5000;
-    uint8_t buffer[bufferSize];
-    int bufferIndex = 0;
+    static TelemetryRecord block[telemetryBlockRecords];
+    FileStream*            file = nullptr;
 
     while (true) {
-        if (Maslow.telemetry_enabled) {
-            TelemetryData data = Maslow.get_telemetry_data();
-
-            // Copy the telemetry data into the buffer
-            memcpy(buffer + bufferIndex, reinterpret_cast<uint8_t*>(&data), sizeof(TelemetryData));
-            // increment the index
-            bufferIndex += sizeof(TelemetryData);
-
-            // Check if the buffer is about to overflow
-            if (bufferIndex >= bufferSize) {
-                log_debug("!" << bufferIndex);
-                Maslow.write_telemetry_buffer(buffer, bufferIndex);
-                bufferIndex = 0;
+        bool enabled = Maslow.telemetry_enabled;
+        if (enabled && !file) {
+            try {
+                file = new FileStream(MASLOW_TELEM_FILE, "w", "sd");
+            } catch (Error err) {
+                log_error("Cannot create " << MASLOW_TELEM_FILE << ", telemetry turned off");
+                Maslow.telemetry_enabled = false;
+                continue;
             }
-        } else {
-            if (bufferIndex > 0) {
-                Maslow.write_telemetry_buffer(buffer, bufferIndex);
-                bufferIndex = 0;
+            TelemetryFileHeader header = {};
+            memcpy(header.magic, "M4TL", 4);
+            header.version    = telemetryVersion;
+            header.recordSize = sizeof(TelemetryRecord);
+            header.sampleHz   = Maslow.controlFrequencyHz;
+            strncpy(header.firmware, VERSION_NUMBER, sizeof(header.firmware));
+            file->write(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+
+            // Records from before the file was opened belong to an earlier recording
+            telemetryRing.clear();
+            telemetryRing.takeDropped();
+        }
+        if (file) {
+            // Whole blocks while recording, then whatever is left when it stops
+            while (telemetryRing.size() >= telemetryBlockRecords || (!enabled && telemetryRing.size())) {
+                size_t count = telemetryRing.pop(block, telemetryBlockRecords);
+                file->write(reinterpret_cast<uint8_t*>(block), count * sizeof(TelemetryRecord));
+            }
+            if (!enabled) {
+                delete file;
+                file = nullptr;
+                if (uint32_t dropped = telemetryRing.takeDropped()) {
+                    log_warn("Telemetry dropped " << dropped << " records because the SD card was too slow");
+                }
             }
         }
-        // Start with 2Hz-ish
-        vTaskDelay(500 / portTICK_PERIOD_MS);
+        vTaskDelay(20 / portTICK_PERIOD_MS);
+    }
+}
+
+// Belt control task. Each timer tick wakes it for one cycle; ticks that arrive while a cycle is still running are merged
+void control_loop(void* unused) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        Maslow.controlLoop();
     }
 }
 
@@ -5,11 +5,17 @@
 #pragma once
 #include <Arduino.h>
 #include "MotorUnit.h"
+#include "BeltKinematics.h"
+#include "Telemetry.h"
 #include "../System.h"  // sys.*
 #include "../Planner.h"
 #include <nvs.h>
-#include "FreeRTOS.h"
-#include "semphr.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+namespace Kinematics {
+    class Maslow;
+}
 
 #define TCAADDR 0x70
 
@@ -30,72 +36,15 @@ const std::string M = "Maslow";
 // Non-volatile storage name
 //const char * nvs_t = "maslow";
 
-struct TelemetryFileHeader {
-    unsigned int structureSize; // 4 bytes
-    char version[10];       // 10
-    // if you add to the header take bytes from this
-    char _unused[64]; // 64 bytes
-};
-
-struct TelemetryData {
-    unsigned long timestamp;
-    // motors
-    double tlCurrent;
-    double trCurrent;
-    double blCurrent;
-    double brCurrent;
-    // power
-    double tlPower;
-    double trPower;
-    double blPower;
-    double brPower;
-    // speed
-    double tlSpeed;
-    double trSpeed;
-    double blSpeed;
-    double brSpeed;
-     // position
-    double tlPos;
-    double trPos;
-    double blPos;
-    double brPos;
-
-    int tlState;
-    int trState;
-    int blState;
-    int brState;
-
-    bool extendedTL;
-    bool extendedTR;
-    bool extendedBL;
-    bool extendedBR;
-
-    bool extendingALL;
-    bool complyALL;
-    bool takeSlack;
-
-    bool safetyOn;
-    double targetX;
-    double targetY;
-    double targetZ;
-    double x;
-    double y;
-    double z;
-
-    bool test;
-    int pointCount;
-    int waypoint;
-    int calibrationGridSize;
-    unsigned long holdTimer;
-    bool holding;
-    unsigned long holdTime;
-    float centerX;
-    float centerY;
-    unsigned long lastCallToPID;
-    unsigned long lastMiss;
-    unsigned long lastCallToUpdate;
-    unsigned long extendCallTimer;
-    unsigned long complyCallTimer;
+// Timing of the belt control loop, in microseconds
+struct ControlLoopStats {
+    uint32_t cycles      = 0;
+    uint32_t overruns    = 0;  // Cycles whose work took longer than the control period
+    uint32_t minPeriod   = UINT32_MAX;
+    uint32_t maxPeriod   = 0;
+    uint64_t totalPeriod = 0;
+    uint32_t maxWork     = 0;
+    uint64_t totalWork   = 0;  // Time spent in cycles, an upper bound on what the main loop, on the same core, loses
 };
 
 class Maslow_ {
@@ -117,11 +66,29 @@ public:
     void   heartBeat();
     bool   updateEncoderPositions();
     void   setTargets(float xTarget, float yTarget, float zTarget, bool tl = true, bool tr = true, bool bl = true, bool br = true);
+    void   setFeedForward();
+    void   followMotion();
     double getTargetX();
     double getTargetY();
     double getTargetZ();
     void   recomputePID();
 
+    //belt control loop, run by a timer-driven task at controlFrequencyHz
+    void             startControlTask();
+    void             updateControlFrequency();
+    void             controlLoop();
+    ControlLoopStats getControlStats(bool reset);
+    void             reportControlStats();
+    int              controlFrequencyHz = 500;  //About half a millisecond of bus time reads the four encoders at 400kHz
+
+    //PID feed-forward gains for the planned belt motion, in PWM per mm/s and PWM per mm/s^2. Zero disables
+    float velocityFeedForward     = 0;
+    float accelerationFeedForward = 0;
+
+    //Set by the Maslow kinematic system, whose motors are the belts themselves. Null when the motors are cartesian
+    void                  setBeltSpace(Kinematics::Maslow* kinematics) { beltSpace = kinematics; }
+    BeltKinematics        belts();
+
     //math
     void  updateCenterXY();
     float computeBL(float x, float y, float z);
@@ -191,15 +158,13 @@ public:
     void handleMotorOverides();
     bool checkOverides();
     void getInfo();
-    bool telemetry_enabled = false;
-    // TODO: probably need to use this for all fields in telemetry, but we'll try without first
-    // SemaphoreHandle_t telemetry_mutex = xSemaphoreCreateMutex();
-    TelemetryData get_telemetry_data();
-    // turns on or off telemetry gathering
+    std::atomic<bool> telemetry_enabled { false };
+    // turns on or off telemetry recording
     void set_telemetry(bool enabled);
-    void dump_telemetry(const char * filename);
-    // writes whatever is in teh telemetry buffer to SD card
-    void write_telemetry_buffer(uint8_t* buffer, size_t length);
+    // logs a summary of a telemetry file
+    void dump_telemetry(const char* filename);
+    // called by the control loop every cycle
+    void recordTelemetry(uint32_t workUs);
 
     //These are the current targets set by the setTargets function used for moving the machine during normal operations
     double targetX = 0;
@@ -219,9 +184,10 @@ public:
     bool axisTRHomed;
     bool axisTLHomed;
     bool calibrationInProgress;  //Used to turn off regular movements during calibration
-    bool readingFromSD = false;  //Used to turn off reading from the encoders when reading from the - i dont think we need this anymore TODO
     bool using_default_config = false;
     QWIICMUX I2CMux;
+    SemaphoreHandle_t i2cMutex = nullptr;  //Held for each transaction on the encoder bus, which the control task shares
+    SemaphoreHandle_t controlMutex = nullptr;  //Held by the control task for each cycle and by the main loop for each update
 
     //calibration stuff
 
@@ -288,6 +254,17 @@ private:
     float centerX;
     float centerY;
 
+    //One pass of update(), run while holding controlMutex
+    void mainLoop();
+
+    //Rebuilt by updateCenterXY() whenever the frame geometry changes, and copied out by belts(). Both hold beltsMux,
+    //because the control task reads the table while settings and calibration can rebuild it from the main loop
+    BeltKinematics      beltKinematics;
+    portMUX_TYPE        beltsMux  = portMUX_INITIALIZER_UNLOCKED;
+    Kinematics::Maslow* beltSpace = nullptr;
+
+    void setTargetsFromMotors();
+
     //Used to keep track of how often the PID controller is updated
     unsigned long lastCallToPID    = millis();
     unsigned long lastMiss         = millis();
@@ -295,6 +272,12 @@ private:
     unsigned long extendCallTimer  = millis();
     unsigned long complyCallTimer  = millis();
 
+    //Control loop timing, updated by the control task and read and reset from the main loop under controlStatsMux
+    ControlLoopStats controlStats;
+    portMUX_TYPE     controlStatsMux    = portMUX_INITIALIZER_UNLOCKED;
+    int64_t          lastControlCycle   = 0;
+    bool             controlTaskRunning = false;
+
     //Stores a reference to the global system runtime function to be called when blocking operations are needed
     void (*_sys_rt)() = nullptr;
 
@@ -313,13 +296,13 @@ private:
     unsigned long overideTimer = millis();
 
     bool HeartBeatEnabled = true;
-    void log_telem_hdr_csv();
-    void log_telem_pt_csv(TelemetryData data);
     void allocateCalibrationMemory();
     void deallocateCalibrationMemory();
 };
 
 extern Maslow_& Maslow;
 
-// actual task loop for gathering telemetry data (runs on utility core)
+// writes recorded telemetry to the SD card (runs on utility core)
 void   telemetry_loop(void* unused);
+// belt control task, woken by a periodic timer
+void   control_loop(void* unused);
@@ -36,6 +36,9 @@ void MiniPID::init() {
     D = 0;
     F = 0;
 
+    velocityGain     = 0;
+    accelerationGain = 0;
+
     maxIOutput     = 0;
     maxError       = 0;
     errorSum       = 0;
@@ -113,6 +116,19 @@ void MiniPID::setF(double f) {
     checkSigns();
 }
 
+/**Configure feed-forward from the trajectory being followed. <br>
+ * Suited to position control of a moving target, where the velocity and acceleration of the
+ * setpoint are known in advance: they drive the output directly, and the P, I and D terms
+ * only have to correct the remaining error.
+ *
+ * @param velocity Gain on the setpoint velocity passed to getOutput(actual, setpoint, velocity, acceleration)
+ * @param acceleration Gain on the setpoint acceleration
+ */
+void MiniPID::setTrajectoryFeedForward(double velocity, double acceleration) {
+    velocityGain     = velocity;
+    accelerationGain = acceleration;
+}
+
 /** Create a new PID object. 
  * @param p Proportional gain. Large if large difference between setpoint and target. 
  * @param i Integral gain.	Becomes large if setpoint cannot reach target quickly. 
@@ -198,6 +214,19 @@ void MiniPID::setSetpoint(double setpoint) {
 * @return calculated output value for driving the actual to the target 
 */
 double MiniPID::getOutput(double actual, double setpoint) {
+    return getOutput(actual, setpoint, 0, 0);
+}
+
+/**
+ * Calculates the PID value for a moving setpoint, adding the trajectory feed-forward terms
+ * configured with setTrajectoryFeedForward().
+ * @param actual The monitored value
+ * @param setpoint The target value
+ * @param velocity Rate of change of the target
+ * @param acceleration Rate of change of velocity
+ * @return calculated output value for driving the actual to the target
+ */
+double MiniPID::getOutput(double actual, double setpoint, double velocity, double acceleration) {
     double output;
     double Poutput;
     double Ioutput;
@@ -215,7 +244,7 @@ double MiniPID::getOutput(double actual, double setpoint) {
     double error = setpoint - actual;
 
     //Calculate F output. Notice, this->depends only on the setpoint, and not the error.
-    Foutput = F * setpoint;
+    Foutput = F * setpoint + velocityGain * velocity + accelerationGain * acceleration;
 
     //Calculate P term
     Poutput = P * error;
@@ -10,6 +10,7 @@ public:
     void   setI(double);
     void   setD(double);
     void   setF(double);
+    void   setTrajectoryFeedForward(double, double);
     void   setPID(double, double, double);
     void   setPID(double, double, double, double);
     void   setMaxIOutput(double);
@@ -24,6 +25,7 @@ public:
     double getOutput();
     double getOutput(double);
     double getOutput(double, double);
+    double getOutput(double, double, double, double);
 
 private:
     double clamp(double, double, double);
@@ -34,6 +36,8 @@ private:
     double I;
     double D;
     double F;
+    double velocityGain;
+    double accelerationGain;
 
     double maxIOutput;
     double maxError;
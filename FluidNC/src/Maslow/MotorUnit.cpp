@@ -116,13 +116,21 @@ void MotorUnit::update() {
 
 // Reads the encoder value and updates it's position
 bool MotorUnit::updateEncoderPosition() {
-    if (!Maslow.I2CMux.setPort(_encoderAddress))
+    //The control task reads the encoders while the main loop may be zeroing one, so hold the bus for the whole transaction
+    xSemaphoreTake(Maslow.i2cMutex, portMAX_DELAY);
+    bool portSet   = Maslow.I2CMux.setPort(_encoderAddress);
+    bool connected = portSet && encoder.isConnected();  //this func has 50ms timeout (or worse?, hard to tell)
+    if (connected) {
+        mostRecentCumulativeEncoderReading = encoder.getCumulativePosition();  //This updates and returns the encoder value
+    }
+    xSemaphoreGive(Maslow.i2cMutex);
+
+    if (!portSet)
         return false;
 
     String encAddrLabel = Maslow.axis_id_to_label(_encoderAddress);
 
-    if (encoder.isConnected()) {                                               //this func has 50ms timeout (or worse?, hard to tell)
-        mostRecentCumulativeEncoderReading = encoder.getCumulativePosition();  //This updates and returns the encoder value
+    if (connected) {
         return true;
     } else if (millis() - encoderReadFailurePrintTime > 5000) {
         encoderReadFailurePrintTime = millis();
@@ -141,7 +149,9 @@ double MotorUnit::getPositionError() {
 
 // Recomputes the PID and drives the output
 double MotorUnit::recomputePID() {
-    _commandPWM = positionPID.getOutput(getPosition(), setpoint);
+    //The gains are read every cycle, so that a $/ change to them takes effect without a restart
+    positionPID.setTrajectoryFeedForward(Maslow.velocityFeedForward, Maslow.accelerationFeedForward);
+    _commandPWM = positionPID.getOutput(getPosition(), setpoint, targetVelocity, targetAcceleration);
 
     motor.runAtPWM(_commandPWM);
 
@@ -263,9 +273,17 @@ bool MotorUnit::extend(double targetLength) {
 //------------------------------------------------------ Utility functions
 //------------------------------------------------------
 
-// Sets the target location in mm
+// Sets the target location in mm. The target is taken to be at rest until setFeedForward() says otherwise
 void MotorUnit::setTarget(double newTarget) {
-    setpoint = newTarget;
+    setpoint           = newTarget;
+    targetVelocity     = 0;
+    targetAcceleration = 0;
+}
+
+// Sets the speed (mm/s) and acceleration (mm/s^2) with which the target is moving
+void MotorUnit::setFeedForward(double velocity, double acceleration) {
+    targetVelocity     = velocity;
+    targetAcceleration = acceleration;
 }
 
 // Gets the target location in mm
@@ -348,6 +366,8 @@ void MotorUnit::reset() {
 
 //sets the encoder position to 0
 void MotorUnit::zero() {
+    xSemaphoreTake(Maslow.i2cMutex, portMAX_DELAY);
     Maslow.I2CMux.setPort(_encoderAddress);
     encoder.resetCumulativePosition();
+    xSemaphoreGive(Maslow.i2cMutex);
 }
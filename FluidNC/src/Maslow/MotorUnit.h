@@ -18,6 +18,7 @@ public:
     void   begin(int forwardPin, int backwardPin, int readbackPin, int encoderAddress, int channel1, int channel2);
     void   zero();
     void   setTarget(double newTarget);
+    void   setFeedForward(double velocity, double acceleration);
     double getTarget();
     double getPosition();
     double getCurrent();
@@ -48,6 +49,8 @@ private:
     MiniPID positionPID;  //These are the P,I,D values for the servo motors
     DCMotor motor;
     double  setpoint                           = 0.0;
+    double  targetVelocity                     = 0.0;  //Belt speed of the moving target in mm/s, used as feed-forward
+    double  targetAcceleration                 = 0.0;  //Belt acceleration of the moving target in mm/s^2
     double  _mmPerRevolution                   = 43.975;  //If the amount of belt extended is too long, this number needs to be bigger
     int     _stallThreshold                    = 25;      //The number of times in a row needed to trigger a warning
     int     _stallCurrent                      = 27;      //The current threshold needed to count
@@ -55,7 +58,7 @@ private:
     int     _numPosErrors                      = 0;  //Keeps track of the number of position errors in a row to detect a stall
     double  _lastPosition                      = 0.0;
     double  _commandPWM                        = 0;  //The last PWM duty cycle sent to the motor
-    double  mostRecentCumulativeEncoderReading = 0;
+    int32_t mostRecentCumulativeEncoderReading = 0;  //Written by the control task, so kept to a single word
     double  encoderReadFailurePrintTime        = millis();
     //unsigned long lastCallGetPos = millis();
 
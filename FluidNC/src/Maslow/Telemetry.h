@@ -0,0 +1,107 @@
+// Copyright (c) 2024 Maslow CNC. All rights reserved.
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file with
+// following exception: it may not be used for any reason by MakerMade or anyone with a business or personal connection to MakerMade
+
+#pragma once
+
+/*
+  Belt telemetry.  While it is on, the control loop pushes a TelemetryRecord
+  into a ring every cycle and the telemetry task writes the ring to the SD card
+  in large blocks, into a file that stays open until telemetry is turned off.
+
+  The file is a TelemetryFileHeader followed by records, little endian and
+  without padding.  decode-telemetry.py at the top of the repository turns it
+  into CSV.  Change telemetryVersion, and the decoder, when the layout changes.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+const uint16_t telemetryVersion = 2;
+
+struct TelemetryFileHeader {
+    char     magic[4];      // "M4TL"
+    uint16_t version;       // telemetryVersion
+    uint16_t recordSize;    // sizeof(TelemetryRecord)
+    uint32_t sampleHz;      // Control loop frequency
+    char     firmware[20];  // Maslow firmware version, nul padded
+};
+static_assert(sizeof(TelemetryFileHeader) == 32, "TelemetryFileHeader layout changed");
+
+enum TelemetryFlag : uint16_t {
+    ExtendedTL            = 1 << 0,
+    ExtendedTR            = 1 << 1,
+    ExtendedBL            = 1 << 2,
+    ExtendedBR            = 1 << 3,
+    ExtendingAll          = 1 << 4,
+    ComplyAll             = 1 << 5,
+    TakeSlack             = 1 << 6,
+    SafetyOn              = 1 << 7,
+    Holding               = 1 << 8,
+    CalibrationInProgress = 1 << 9,
+};
+
+// The belts are in the order TL, TR, BL, BR
+struct TelemetryRecord {
+    uint32_t time;          // us since boot, wraps after 71 minutes
+    float    position[4];   // Belt lengths, mm
+    float    target[2];     // targetX, targetY, mm
+    int16_t  error[4];      // Belt length minus setpoint, um, saturated
+    int16_t  current[4];    // Motor current, averaged over the last 10 readings
+    int16_t  power[4];      // Motor drive, PWM
+    int16_t  speed[4];      // Belt speed, 0.01 mm/s, saturated
+    uint16_t flags;         // TelemetryFlag
+    uint8_t  state;         // sys.state()
+    uint8_t  work;          // Control cycle work time, 10 us units, saturated
+};
+static_assert(sizeof(TelemetryRecord) == 64, "TelemetryRecord layout changed");
+
+// A ring for one producer and one consumer that never blocks either of them.
+// When it is full, push() drops the record and counts it.  Size must be a
+// power of two.
+template <typename Record, size_t Size>
+class TelemetryRing {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+    // Producer side
+    bool push(const Record& record) {
+        auto head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Size) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _records[head % Size] = record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.  Copies up to max records into out and returns how many.
+    size_t pop(Record* out, size_t max) {
+        auto   tail  = _tail.load(std::memory_order_relaxed);
+        size_t count = _head.load(std::memory_order_acquire) - tail;
+        if (count > max) {
+            count = max;
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[i] = _records[(tail + i) % Size];
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t size() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed); }
+
+    // Consumer side.  Discards the records that are waiting.
+    void clear() { _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Records that push() could not store; the consumer resets it
+    uint32_t takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    Record                _records[Size];
+    std::atomic<uint32_t> _head { 0 };
+    std::atomic<uint32_t> _tail { 0 };
+    std::atomic<uint32_t> _dropped { 0 };
+};
@@ -13,6 +13,7 @@
 #include "Planner.h"         // plan_reset, etc
 #include "Platform.h"        // WEAK_LINK
 #include "Settings.h"        // coords
+#include "Spline.h"          // CubicSpline
 
 #include <cmath>
 
@@ -252,6 +253,72 @@ void mc_arc(float*            target,
     mc_linear(target, pl_data, previous_position);
 }
 
+// Execute a cubic Bezier curve, for G5 and G5.1.  Like an arc, the curve is approximated by
+// linear segments within arc_tolerance of it, but the segments are as long as the curvature
+// allows, and each one is computed only when the previous one has been planned, so a long
+// curve waits in mc_linear() for room in the planner instead of being flattened all at once.
+static void spline_point(float*       point,
+                         const float* position,
+                         const float* target,
+                         float        t,
+                         float        x,
+                         float        y,
+                         size_t       axis_0,
+                         size_t       axis_1,
+                         size_t       n_axis) {
+    for (size_t i = 0; i < n_axis; i++) {
+        point[i] = position[i] + t * (target[i] - position[i]);
+    }
+    point[axis_0] = x;
+    point[axis_1] = y;
+}
+
+void mc_spline(float* target, plan_line_data_t* pl_data, float* position, const float* first, const float* second, size_t axis_0, size_t axis_1) {
+    auto n_axis = config->_axes->_numberAxis;
+
+    float start[2] = { position[axis_0], position[axis_1] };
+    float end[2]   = { target[axis_0], target[axis_1] };
+    CubicSpline spline(start, first, second, end, config->_arcTolerance);
+
+    float previous_position[MAX_N_AXIS] = { 0.0f };
+    float segment_target[MAX_N_AXIS]    = { 0.0f };
+    copyAxes(previous_position, position);
+
+    float t, x, y;
+
+    // The inverse feed rate is for the whole curve, so convert it to the feed
+    // rate that covers the length of all the segments in that time.
+    if (pl_data->motion.inverseTime) {
+        float length = 0.0f;
+        while (spline.next(t, x, y)) {
+            spline_point(segment_target, position, target, t, x, y, axis_0, axis_1, n_axis);
+            length += vector_distance(previous_position, segment_target, n_axis);
+            copyAxes(previous_position, segment_target);
+        }
+        pl_data->feed_rate *= length;
+        pl_data->motion.inverseTime = 0;  // Force as feed absolute mode over spline segments.
+        spline.restart();
+        copyAxes(previous_position, position);
+    }
+
+    float original_feedrate = pl_data->feed_rate;  // Kinematics may alter the feedrate, so save an original copy
+    while (spline.next(t, x, y)) {
+        if (t >= 1.0f) {
+            break;  // The last segment goes to the exact target, below
+        }
+        spline_point(segment_target, position, target, t, x, y, axis_0, axis_1, n_axis);
+        pl_data->feed_rate = original_feedrate;  // This restores the feedrate kinematics may have altered
+        mc_linear(segment_target, pl_data, previous_position);
+        copyAxes(previous_position, segment_target);
+        // Bail mid-curve on system abort. Runtime command check already performed by mc_linear.
+        if (sys.abort()) {
+            return;
+        }
+    }
+    pl_data->feed_rate = original_feedrate;
+    mc_linear(target, pl_data, previous_position);
+}
+
 // Execute dwell in seconds.
 bool mc_dwell(int32_t milliseconds) {
     if (milliseconds <= 0 || sys.state() == State::CheckMode) {
@@ -46,6 +46,11 @@ void mc_arc(float*            target,
             bool              is_clockwise_arc,
             int               pword_rotations);
 
+// Execute a cubic Bezier curve from position to target.  first and second are the control
+// points in the plane of axis_0 and axis_1; the other axes move in proportion to the curve
+// parameter.  Segments are within arc_tolerance of the curve and are planned as they are computed.
+void mc_spline(float* target, plan_line_data_t* pl_data, float* position, const float* first, const float* second, size_t axis_0, size_t axis_1);
+
 // Dwell for a specific number of seconds
 bool mc_dwell(int32_t milliseconds);
 
@@ -81,6 +81,24 @@ namespace MotorDrivers {
         // this is used to configure and test motors. This would be used for Trinamic
         virtual void config_motor() {}
 
+        // DirectPins describes the step and direction pins that Axes can
+        // drive with GPIO register writes, instead of calling step(),
+        // unstep() and set_direction() for every pulse.  A mask has bit n
+        // set for GPIO n; a direct pin with a mask of 0 means there is
+        // nothing to drive.
+        struct DirectPins {
+            bool     step       = false;
+            bool     direction  = false;
+            uint64_t stepMask   = 0;
+            uint64_t dirMask    = 0;
+            bool     stepInvert = false;
+            bool     dirInvert  = false;
+        };
+
+        // direct_pins() is called from Axes::config_motors().  The default
+        // leaves both pins to the driver's own methods.
+        virtual DirectPins direct_pins() { return DirectPins(); }
+
         // test(), called from init(), checks to see if a motor is
         // responsive, returning true on failure.  Typical
         // implementations also display messages to show the result.
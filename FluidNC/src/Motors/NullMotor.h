@@ -11,6 +11,14 @@ namespace MotorDrivers {
 
         bool isReal() override { return false; }
 
+        // No pins, so nothing for the stepping code to call
+        DirectPins direct_pins() override {
+            DirectPins pins;
+            pins.step      = true;
+            pins.direction = true;
+            return pins;
+        }
+
         // Configuration handlers:
         void group(Configuration::HandlerBase& handler) override {}
 
@@ -116,6 +116,25 @@ namespace MotorDrivers {
 
     void IRAM_ATTR StandardStepper::set_direction(bool dir) { _dir_pin.write(dir); }
 
+    // Timed step pulses and direction on native GPIOs can be driven directly.
+    // RMT pulses, I2SO and extender pins need the methods above.
+    MotorDriver::DirectPins StandardStepper::direct_pins() {
+        DirectPins pins;
+        if (config->_stepping->_engine == Stepping::TIMED && _step_pin.capabilities().has(Pin::Capabilities::Native)) {
+            pins.step       = true;
+            pins.stepMask   = uint64_t(1) << _step_pin.getNative(Pin::Capabilities::Output);
+            pins.stepInvert = _invert_step;
+        }
+        if (_dir_pin.undefined()) {
+            pins.direction = true;
+        } else if (_dir_pin.capabilities().has(Pin::Capabilities::Native)) {
+            pins.direction = true;
+            pins.dirMask   = uint64_t(1) << _dir_pin.getNative(Pin::Capabilities::Output);
+            pins.dirInvert = _dir_pin.getAttr().has(Pin::Attr::ActiveLow);
+        }
+        return pins;
+    }
+
     void IRAM_ATTR StandardStepper::set_disable(bool disable) { _disable_pin.synchronousWrite(disable); }
 
     // Configuration registration
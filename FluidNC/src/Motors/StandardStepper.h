@@ -22,6 +22,8 @@ namespace MotorDrivers {
         void unstep() override;
         void read_settings() override;
 
+        DirectPins direct_pins() override;
+
         void init_step_dir_pins();
 
     protected:
@@ -184,6 +184,23 @@ float limit_rate_by_axis_maximum(float* unit_vec) {
     return limit_value;
 }
 
+// Returns zero, meaning a trapezoid profile, unless every axis in the move has a jerk limit.
+float limit_jerk_by_axis_maximum(float* unit_vec) {
+    float limit_value = SOME_LARGE_VALUE;
+    auto  n_axis      = config->_axes->_numberAxis;
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        auto axisSetting = config->_axes->_axis[idx];
+        if (unit_vec[idx] != 0) {  // Avoid divide by zero.
+            if (axisSetting->_jerk == 0) {
+                return 0;
+            }
+            limit_value = MIN(limit_value, fabsf(axisSetting->_jerk / unit_vec[idx]));
+        }
+    }
+    // mm/sec^3 to mm/min^3
+    return limit_value * secPerMinSq * 60.0f;
+}
+
 bool char_is_numeric(char value) {
     return value >= '0' && value <= '9';
 }
@@ -79,6 +79,7 @@ void scale_vector(float* v, float scale, size_t n);
 float convert_delta_vector_to_unit_vector(float* vector);
 float limit_acceleration_by_axis_maximum(float* unit_vec);
 float limit_rate_by_axis_maximum(float* unit_vec);
+float limit_jerk_by_axis_maximum(float* unit_vec);
 
 const char* to_hex(uint32_t n);
 
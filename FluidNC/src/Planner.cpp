@@ -10,21 +10,49 @@
 
 #include "Planner.h"
 #include "Machine/MachineConfig.h"
+#include "SCurve.h"
 
-#include <cstdlib>  // PSoc Required for labs
+#include <cfloat>
+#include <cstdlib>  // PSoc Required for labs, calloc
 #include <cmath>
 
-static plan_block_t* block_buffer = nullptr;  // A ring buffer for motion instructions
-static uint8_t       block_buffer_tail;       // Index of the block to process now
-static uint8_t       block_buffer_head;       // Index of the next block to be pushed
-static uint8_t       next_buffer_head;        // Index of the next buffer head
-static uint8_t       block_buffer_planned;    // Index of the optimally planned block
+#ifdef ESP32
+#    include <sdkconfig.h>  // CONFIG_IDF_TARGET_*
+#    include <esp_heap_caps.h>
+#endif
+
+static plan_block_t* block_buffer      = nullptr;  // A ring buffer for motion instructions
+static plan_index_t  block_buffer_size = 0;        // Number of blocks in the ring, from config->_planner_blocks
+static plan_index_t  block_buffer_tail;            // Index of the block to process now
+static plan_index_t  block_buffer_head;            // Index of the next block to be pushed
+static plan_index_t  next_buffer_head;             // Index of the next buffer head
+static plan_index_t  block_buffer_planned;         // Index of the optimally planned block
+static uint32_t      plan_revision;                // Incremented whenever the plan changes
+
+// The planner is only used from the main loop, never from the stepper ISR, so
+// on ESP32-S3 modules with PSRAM a deep look-ahead buffer can be kept there,
+// leaving internal RAM for everything else.
+static plan_block_t* alloc_block_buffer(plan_index_t n_blocks) {
+    void* buffer = nullptr;
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+    buffer = heap_caps_calloc(n_blocks, sizeof(plan_block_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer) {
+        log_info("Planner buffer of " << n_blocks << " blocks in PSRAM");
+    }
+#endif
+    if (!buffer) {
+        buffer = calloc(n_blocks, sizeof(plan_block_t));
+    }
+    Assert(buffer != nullptr, "Cannot allocate planner buffer");
+    return static_cast<plan_block_t*>(buffer);
+}
 
 void plan_init() {
     if (block_buffer) {
-        delete[] block_buffer;
+        free(block_buffer);
     }
-    block_buffer = new plan_block_t[config->_planner_blocks];
+    block_buffer_size = config->_planner_blocks;
+    block_buffer      = alloc_block_buffer(block_buffer_size);
 }
 
 // Define planner variables
@@ -38,23 +66,78 @@ typedef struct {
 static planner_t pl;
 
 // Returns the index of the next block in the ring buffer. Also called by stepper segment buffer.
-static uint8_t plan_next_block_index(uint8_t block_index) {
+static plan_index_t plan_next_block_index(plan_index_t block_index) {
     block_index++;
-    if (block_index == config->_planner_blocks) {
+    if (block_index == block_buffer_size) {
         block_index = 0;
     }
     return block_index;
 }
 
 // Returns the index of the previous block in the ring buffer
-static uint8_t plan_prev_block_index(uint8_t block_index) {
+static plan_index_t plan_prev_block_index(plan_index_t block_index) {
     if (block_index == 0) {
-        block_index = config->_planner_blocks;
+        block_index = block_buffer_size;
     }
     block_index--;
     return block_index;
 }
 
+// A run of jerk-limited blocks back (or forward) to the last anchored junction
+struct ramp_run_t {
+    float speed_sqr;  // At the anchored junction
+    float mm;         // Distance from it
+    float accel;      // Lowest acceleration limit along the run
+    float jerk;       // Lowest jerk limit along the run
+};
+
+static void run_anchor(ramp_run_t* run, float speed_sqr) {
+    run->speed_sqr = speed_sqr;
+    run->mm        = 0.0f;
+    run->accel     = FLT_MAX;
+    run->jerk      = FLT_MAX;
+}
+
+static void run_extend(ramp_run_t* run, const plan_block_t* block) {
+    run->mm += block->millimeters;
+    run->accel = MIN(run->accel, block->max_acceleration);
+    run->jerk  = MIN(run->jerk, block->jerk);
+}
+
+// Extends the run back over a block that ends at exit_speed_sqr and returns its highest entry speed squared.
+// Sets anchor and starts a new run if the plan should hold zero acceleration at the entry.
+static float run_back(ramp_run_t* run, const plan_block_t* block, float exit_speed_sqr, bool* anchor) {
+    float entry_speed_sqr;
+    if (block->jerk <= 0.0f) {
+        entry_speed_sqr = MIN(block->max_entry_speed_sqr, exit_speed_sqr + 2 * block->acceleration * block->millimeters);
+        *anchor         = true;
+    } else {
+        run_extend(run, block);
+        float speed = sqrtf(run->speed_sqr);
+        // Landing on a slow speed with zero acceleration can take longer than coming to a stop, so take
+        // whichever allows more. The segment generator lands on the slow speed still decelerating if it must.
+        float reach = MAX(SCurveRamp::reachableSpeed(speed, run->mm, run->accel, run->jerk),
+                          SCurveRamp::reachableSpeed(0.0f, run->mm, run->accel, run->jerk));
+        float ceiling = SCurveRamp::ceilingSpeed(speed, run->mm, run->accel, run->jerk);
+        entry_speed_sqr = MIN(block->max_entry_speed_sqr, reach * reach);
+        *anchor         = block->max_entry_speed_sqr < ceiling * ceiling;
+    }
+    if (*anchor) {
+        run_anchor(run, entry_speed_sqr);
+    }
+    return entry_speed_sqr;
+}
+
+// Extends the run forward over a block and returns the highest exit speed squared that it can reach.
+static float run_forward(ramp_run_t* run, const plan_block_t* block) {
+    if (block->jerk <= 0.0f) {
+        return block->entry_speed_sqr + 2 * block->acceleration * block->millimeters;
+    }
+    run_extend(run, block);
+    float reach = SCurveRamp::reachableSpeed(sqrtf(run->speed_sqr), run->mm, run->accel, run->jerk);
+    return reach * reach;
+}
+
 /*                            PLANNER SPEED DEFINITION
                                      +--------+   <- current->nominal_speed
                                     /          \
@@ -119,10 +202,20 @@ static uint8_t plan_prev_block_index(uint8_t block_index) {
   to compute an optimal plan, so select carefully. The Arduino 328p memory is already maxed out, but future
   ARM versions should have enough memory and speed for look-ahead blocks numbering up to a hundred or more.
 
+  Jerk-limited blocks cannot change acceleration instantly, so the segment generator runs S-curve ramps
+  straight through the junctions between them rather than easing to zero acceleration at each one. The
+  speeds those ramps can reach depend on the whole run of blocks back to the last junction where the
+  acceleration is zero, so both passes carry a ramp_run_t along and bound each junction speed with the
+  zero-ended ramp from the start of the run. A junction whose speed limit is below the ceiling of any motion
+  from there is anchored: the plan holds zero acceleration at it, and a new run starts. Trapezoid blocks
+  anchor every junction, which leaves the guidelines above unchanged for them. The planned pointer only
+  moves to anchored junctions, since the speed at any other one still depends on the blocks around it.
+
 */
-static void planner_recalculate() {
+static void planner_recalculate(bool incremental = true) {
+    plan_revision++;
     // Initialize block index to the last block in the planner buffer.
-    uint8_t block_index = plan_prev_block_index(block_buffer_head);
+    plan_index_t block_index = plan_prev_block_index(block_buffer_head);
     // Bail. Can't do anything with one only one plan-able block.
     if (block_index == block_buffer_planned) {
         return;
@@ -131,11 +224,16 @@ static void planner_recalculate() {
     // block in buffer. Cease planning when the last optimal planned or tail pointer is reached.
     // NOTE: Forward pass will later refine and correct the reverse pass to create an optimal plan.
     float         entry_speed_sqr;
+    bool          anchor;
+    ramp_run_t    run;
     plan_block_t* next;
     plan_block_t* current = &block_buffer[block_index];
     // Calculate maximum entry speed for last block in buffer, where the exit speed is always zero.
-    current->entry_speed_sqr = MIN(current->max_entry_speed_sqr, 2 * current->acceleration * current->millimeters);
+    run_anchor(&run, 0.0f);
+    current->entry_speed_sqr = run_back(&run, current, 0.0f, &current->anchor);
     block_index              = plan_prev_block_index(block_index);
+    // Forward pass start point. Moved up to the watermark if the reverse pass stops early.
+    plan_index_t forward_index = block_buffer_planned;
     if (block_index == block_buffer_planned) {  // Only two plannable blocks in buffer. Reverse pass complete.
         // Check if the first block is the tail. If so, notify stepper to update its current parameters.
         if (block_index == block_buffer_tail) {
@@ -143,48 +241,61 @@ static void planner_recalculate() {
         }
     } else {  // Three or more plan-able blocks
         while (block_index != block_buffer_planned) {
-            next        = current;
-            current     = &block_buffer[block_index];
-            block_index = plan_prev_block_index(block_index);
+            next                       = current;
+            current                    = &block_buffer[block_index];
+            plan_index_t current_index = block_index;
+            block_index                = plan_prev_block_index(block_index);
+            // A trapezoid block ramps on its own, so the jerk-limited profile after it starts at its exit.
+            if (current->jerk <= 0.0f) {
+                next->anchor = true;
+            }
+            // Compute maximum entry speed decelerating over the current block from its exit speed.
+            entry_speed_sqr = run_back(&run, current, next->entry_speed_sqr, &anchor);
+            // Watermark: while blocks are being appended, entry speeds only ever rise, so an anchored
+            // block whose entry speed comes out unchanged was planned from the same exit speed last time.
+            // Every block before it is then already optimal, and the forward pass can start here.
+            if (incremental && anchor && current->anchor && entry_speed_sqr == current->entry_speed_sqr) {
+                forward_index = current_index;
+                break;
+            }
+            current->entry_speed_sqr = entry_speed_sqr;
+            current->anchor          = anchor;
             // Check if next block is the tail block(=planned block). If so, update current stepper parameters.
             if (block_index == block_buffer_tail) {
                 Stepper::update_plan_block_parameters();
             }
-            // Compute maximum entry speed decelerating over the current block from its exit speed.
-            if (current->entry_speed_sqr != current->max_entry_speed_sqr) {
-                entry_speed_sqr = next->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
-                if (entry_speed_sqr < current->max_entry_speed_sqr) {
-                    current->entry_speed_sqr = entry_speed_sqr;
-                } else {
-                    current->entry_speed_sqr = current->max_entry_speed_sqr;
-                }
-            }
         }
     }
     // Forward Pass: Forward plan the acceleration curve from the planned pointer onward.
     // Also scans for optimal plan breakpoints and appropriately updates the planned pointer.
-    next        = &block_buffer[block_buffer_planned];  // Begin at buffer planned pointer
-    block_index = plan_next_block_index(block_buffer_planned);
+    next        = &block_buffer[forward_index];  // Begin at buffer planned pointer or watermark
+    block_index = plan_next_block_index(forward_index);
+    run_anchor(&run, next->entry_speed_sqr);
     while (block_index != block_buffer_head) {
         current = next;
         next    = &block_buffer[block_index];
         // Any acceleration detected in the forward pass automatically moves the optimal planned
         // pointer forward, since everything before this is all optimal. In other words, nothing
         // can improve the plan from the buffer tail to the planned pointer by logic.
+        entry_speed_sqr = run_forward(&run, current);
         if (current->entry_speed_sqr < next->entry_speed_sqr) {
-            entry_speed_sqr = current->entry_speed_sqr + 2 * current->acceleration * current->millimeters;
             // If true, current block is full-acceleration and we can move the planned pointer forward.
             if (entry_speed_sqr < next->entry_speed_sqr) {
                 next->entry_speed_sqr = entry_speed_sqr;  // Always <= max_entry_speed_sqr. Backward pass sets this.
-                block_buffer_planned  = block_index;      // Set optimal plan pointer.
+                if (next->anchor) {
+                    block_buffer_planned = block_index;  // Set optimal plan pointer.
+                }
             }
         }
         // Any block set at its maximum entry speed also creates an optimal plan up to this
         // point in the buffer. When the plan is bracketed by either the beginning of the
         // buffer and a maximum entry speed or two maximum entry speeds, every block in between
         // cannot logically be further improved. Hence, we don't have to recompute them anymore.
-        if (next->entry_speed_sqr == next->max_entry_speed_sqr) {
-            block_buffer_planned = block_index;
+        if (next->anchor) {
+            if (next->entry_speed_sqr == next->max_entry_speed_sqr) {
+                block_buffer_planned = block_index;
+            }
+            run_anchor(&run, next->entry_speed_sqr);
         }
         block_index = plan_next_block_index(block_index);
     }
@@ -205,7 +316,7 @@ void plan_reset_buffer() {
 // Called from stepper pulse function when the block is complete
 void plan_discard_current_block() {
     if (block_buffer_head != block_buffer_tail) {  // Discard non-empty buffer.
-        uint8_t block_index = plan_next_block_index(block_buffer_tail);
+        plan_index_t block_index = plan_next_block_index(block_buffer_tail);
         // Push block_buffer_planned pointer, if encountered.
         if (block_buffer_tail == block_buffer_planned) {
             block_buffer_planned = block_index;
@@ -228,13 +339,31 @@ plan_block_t* plan_get_current_block() {
 }
 
 float plan_get_exec_block_exit_speed_sqr() {
-    uint8_t block_index = plan_next_block_index(block_buffer_tail);
+    plan_index_t block_index = plan_next_block_index(block_buffer_tail);
     if (block_index == block_buffer_head) {
         return 0.0f;
     }
     return block_buffer[block_index].entry_speed_sqr;
 }
 
+plan_block_t* plan_get_exec_block_ahead(plan_index_t ahead) {
+    plan_index_t block_index = block_buffer_tail;
+    while (ahead--) {
+        if (block_index == block_buffer_head) {
+            return NULL;
+        }
+        block_index = plan_next_block_index(block_index);
+    }
+    if (block_index == block_buffer_head) {
+        return NULL;
+    }
+    return &block_buffer[block_index];
+}
+
+uint32_t plan_get_revision() {
+    return plan_revision;
+}
+
 // Returns the availability status of the block ring buffer. True, if full.
 uint8_t plan_check_full_buffer() {
     return block_buffer_tail == next_buffer_head;
@@ -260,9 +389,21 @@ float plan_compute_profile_nominal_speed(plan_block_t* block) {
     return MINIMUM_FEED_RATE;
 }
 
+// An S-curve ramp to the nominal speed takes longer than a linear one at the same peak acceleration.
+// Plan with its average acceleration, so that the segment generator can shape every ramp without
+// exceeding max_acceleration.  This does not depend on the block length, so short blocks that
+// continue one ramp are planned the same as one long block would be.  It depends on the nominal
+// speed, so it is recomputed whenever an override changes that.
+static void plan_compute_profile_acceleration(plan_block_t* block, float nominal_speed) {
+    if (block->jerk > 0) {
+        block->acceleration = SCurveRamp::averageAcceleration(nominal_speed, block->max_acceleration, block->jerk);
+    }
+}
+
 // Computes and updates the max entry speed (sqr) of the block, based on the minimum of the junction's
 // previous and current nominal speeds and max junction speed.
 static void plan_compute_profile_parameters(plan_block_t* block, float nominal_speed, float prev_nominal_speed) {
+    plan_compute_profile_acceleration(block, nominal_speed);
     // Compute the junction maximum entry based on the minimum of the junction speed and neighboring nominal speeds.
     if (nominal_speed > prev_nominal_speed) {
         block->max_entry_speed_sqr = prev_nominal_speed * prev_nominal_speed;
@@ -277,7 +418,7 @@ static void plan_compute_profile_parameters(plan_block_t* block, float nominal_s
 
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
 void plan_update_velocity_profile_parameters() {
-    uint8_t       block_index = block_buffer_tail;
+    plan_index_t  block_index = block_buffer_tail;
     plan_block_t* block;
     float         nominal_speed;
     float         prev_nominal_speed = SOME_LARGE_VALUE;  // Set high for first block nominal speed calculation.
@@ -289,6 +430,7 @@ void plan_update_velocity_profile_parameters() {
         block_index        = plan_next_block_index(block_index);
     }
     pl.previous_nominal_speed = prev_nominal_speed;  // Update prev nominal speed for next incoming block.
+    plan_revision++;
 }
 
 bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
@@ -332,9 +474,11 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     // down such that no individual axes maximum values are exceeded with respect to the line direction.
     // NOTE: This calculation assumes all axes are orthogonal (Cartesian) and works with ABC-axes,
     // if they are also orthogonal/independent. Operates on the absolute value of the unit vector.
-    block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
-    block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
-    block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+    block->millimeters      = convert_delta_vector_to_unit_vector(unit_vec);
+    block->acceleration     = limit_acceleration_by_axis_maximum(unit_vec);
+    block->max_acceleration = block->acceleration;
+    block->jerk             = limit_jerk_by_axis_maximum(unit_vec);
+    block->rapid_rate       = limit_rate_by_axis_maximum(unit_vec);
     // Store programmed rate.
     if (block->motion.rapidMotion) {
         block->programmed_rate = block->rapid_rate;
@@ -344,6 +488,10 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
             block->programmed_rate *= block->millimeters;
         }
     }
+    // System motion is not subject to overrides, so its planned acceleration is set once here.
+    if (block->motion.systemMotion) {
+        plan_compute_profile_acceleration(block, plan_compute_profile_nominal_speed(block));
+    }
     // TODO: Need to check this method handling zero junction speeds when starting from rest.
     if ((block_buffer_head == block_buffer_tail) || (block->motion.systemMotion)) {
         // Initialize block entry speed as zero. Assume it will be starting from rest. Planner will correct this later.
@@ -424,9 +572,9 @@ void plan_sync_position() {
 
 // Returns the number of available blocks are in the planner buffer.
 // Called from report_realtime_status
-uint8_t plan_get_block_buffer_available() {
+plan_index_t plan_get_block_buffer_available() {
     if (block_buffer_head >= block_buffer_tail) {
-        return (config->_planner_blocks - 1) - (block_buffer_head - block_buffer_tail);
+        return (block_buffer_size - 1) - (block_buffer_head - block_buffer_tail);
     } else {
         return block_buffer_tail - block_buffer_head - 1;
     }
@@ -438,5 +586,5 @@ void plan_cycle_reinitialize() {
     // Re-plan from a complete stop. Reset planner entry speeds and buffer planned pointer.
     Stepper::update_plan_block_parameters();
     block_buffer_planned = block_buffer_tail;
-    planner_recalculate();
+    planner_recalculate(false);  // Speeds may have dropped, so the watermark does not apply
 }
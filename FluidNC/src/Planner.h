@@ -15,6 +15,10 @@
 
 #include <cstdint>
 
+// Index into the planner ring buffer.  The depth of the buffer comes from the
+// planner_blocks config item, which can exceed the range of a uint8_t.
+typedef uint16_t plan_index_t;
+
 // Define planner data condition flags. Used to denote running conditions of a block.
 struct PlMotion {
     uint8_t rapidMotion : 1;
@@ -44,9 +48,12 @@ struct plan_block_t {
     float entry_speed_sqr;      // The current planned entry speed at block junction in (mm/min)^2
     float max_entry_speed_sqr;  // Maximum allowable entry speed based on the minimum of junction limit and
     //   neighboring nominal speeds with overrides in (mm/min)^2
-    float acceleration;  // Axis-limit adjusted line acceleration in (mm/min^2). Does not change.
+    float acceleration;      // Axis-limit adjusted line acceleration in (mm/min^2). Changes with overrides if jerk-limited.
+    float max_acceleration;  // Axis-limit adjusted acceleration that S-curve ramps may peak at (mm/min^2).
+    float jerk;              // Axis-limit adjusted jerk in (mm/min^3), zero for trapezoid ramps. Does not change.
     float millimeters;   // The remaining distance for this block to be executed in (mm).
     // NOTE: This value may be altered by stepper algorithm during execution.
+    bool anchor;  // The plan holds zero acceleration at the entry junction. Jerk-limited ramps run through the others.
 
     // Stored rate limiting data used by planner when changes occur.
     float max_junction_speed_sqr;  // Junction entry speed limit based on direction vectors in (mm/min)^2
@@ -93,11 +100,18 @@ plan_block_t* plan_get_system_motion_block();
 plan_block_t* plan_get_current_block();
 
 // Increment block index with wrap-around
-static uint8_t plan_next_block_index(uint8_t block_index);
+static plan_index_t plan_next_block_index(plan_index_t block_index);
 
 // Called by step segment buffer when computing executing block velocity profile.
 float plan_get_exec_block_exit_speed_sqr();
 
+// Called by step segment buffer to look ahead of the executing block for the junction that its
+// jerk-limited profile runs to. Returns NULL past the last block.
+plan_block_t* plan_get_exec_block_ahead(plan_index_t ahead);
+
+// Counts changes to the plan, so the step segment buffer can tell when to replan its profile.
+uint32_t plan_get_revision();
+
 // Called by main program during planner calculations and step segment buffer during initialization.
 float plan_compute_profile_nominal_speed(plan_block_t* block);
 
@@ -111,7 +125,7 @@ void plan_sync_position();
 void plan_cycle_reinitialize();
 
 // Returns the number of available blocks are in the planner buffer.
-uint8_t plan_get_block_buffer_available();
+plan_index_t plan_get_block_buffer_available();
 
 // Returns the status of the block ring buffer. True, if buffer is full.
 uint8_t plan_check_full_buffer();
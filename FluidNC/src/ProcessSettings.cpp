@@ -24,6 +24,8 @@
 #include "StartupLog.h"           // startupLog
 #include "Driver/fluidnc_gpio.h"  // gpio_dump()
 #include "Maslow/Maslow.h"
+#include "Job.h"         // job_compile(), job_run()
+#include "EventQueue.h"  // eventQueue
 
 #include "FluidPath.h"
 
@@ -611,6 +613,31 @@ static Error macros_run(const char* value, WebUI::AuthenticationLevel auth_level
     return Error::InvalidStatement;
 }
 
+// Compiled jobs live on the SD card, like the files that $SD/Run runs
+static std::string sd_path(const char* value) {
+    std::string path(value);
+    if (path[0] != '/') {
+        path = "/" + path;
+    }
+    return path;
+}
+
+static Error job_compile_file(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (!value || !*value) {
+        log_error_to(out, "$Job/Compile requires a file name");
+        return Error::InvalidValue;
+    }
+    return job_compile("sd", sd_path(value).c_str(), auth_level, out);
+}
+
+static Error job_run_file(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (!value || !*value) {
+        log_error_to(out, "$Job/Run requires a compiled file name");
+        return Error::InvalidValue;
+    }
+    return job_run("sd", sd_path(value).c_str(), out);
+}
+
 static Error xmodem_receive(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
     if (!value || !*value) {
         value = "uploaded";
@@ -815,11 +842,53 @@ static Error setReportInterval(const char* value, WebUI::AuthenticationLevel aut
     return Error::Ok;
 }
 
+static Error setBinaryReportInterval(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    if (!value) {
+        uint32_t actual = out.getBinaryReportInterval();
+        if (actual) {
+            log_info("Channel binary report interval is " << actual << " ms");
+        } else {
+            log_info("Channel binary reporting is off");
+        }
+        return Error::Ok;
+    }
+    char*    endptr;
+    uint32_t intValue = strtol(value, &endptr, 10);
+
+    if (endptr == value || *endptr != '\0') {
+        return Error::BadNumberFormat;
+    }
+
+    uint32_t actual = out.setBinaryReportInterval(intValue);
+    if (actual) {
+        log_info("Channel binary report interval set to " << actual << " ms");
+    } else if (intValue) {
+        log_error("Binary reports are only available on WebSocket channels");
+        return Error::InvalidValue;
+    } else {
+        log_info("Channel binary reporting turned off");
+    }
+    return Error::Ok;
+}
+
 static Error showHeap(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
     log_info("Heap free: " << xPortGetFreeHeapSize() << " min: " << heapLowWater);
     return Error::Ok;
 }
 
+// Shows the event counters since the last time they were shown
+static Error showEvents(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    const char* names[EventQueue::lanes] = { "Control", "Normal" };
+    for (int lane = 0; lane < EventQueue::lanes; lane++) {
+        auto     stats   = eventQueue.stats(EventPriority(lane), true);
+        uint32_t average = stats.dispatched ? uint32_t(stats.sumLatency / stats.dispatched) : 0;
+        log_info(names[lane] << " events: " << stats.sent << " sent, " << stats.coalesced << " coalesced, " << stats.dropped
+                             << " dropped, at most " << int(stats.highWater) << " waiting, latency " << average << "us average "
+                             << stats.maxLatency << "us max");
+    }
+    return Error::Ok;
+}
+
 
 /*
 
@@ -888,9 +957,8 @@ static Error maslow_stop(const char* value, WebUI::AuthenticationLevel auth_leve
 }
 static Error maslow_telemetry_dump(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
     if (!value || !*value) {
-        value = std::string(MASLOW_TELEM_FILE).c_str();
+        value = MASLOW_TELEM_FILE;
     }
-    // TODO: only call if the file exists
     Maslow.dump_telemetry(value);
     return Error::Ok;
 }
@@ -1103,6 +1171,11 @@ static Error maslow_get_info(const char* value, WebUI::AuthenticationLevel auth_
     return Error::Ok;
 }
 
+static Error maslow_control_stats(const char* value, WebUI::AuthenticationLevel auth_level, Channel& out) {
+    Maslow.reportControlStats();
+    return Error::Ok;
+}
+
 // Commands use the same syntax as Settings, but instead of setting or
 // displaying a persistent value, a command causes some action to occur.
 // That action could be anything, from displaying a run-time parameter
@@ -1144,6 +1217,8 @@ void make_user_commands() {
     new UserCommand("MI", "Motors/Init", motors_init, notIdleOrAlarm);
 
     new UserCommand("RM", "Macros/Run", macros_run, notIdleOrAlarm);
+    new UserCommand("JC", "Job/Compile", job_compile_file, notIdleOrAlarm);
+    new UserCommand("JR", "Job/Run", job_run_file, notIdleOrAlarm);
 
     new UserCommand("HX", "Home/X", home_x, notIdleOrAlarm);
     new UserCommand("HY", "Home/Y", home_y, notIdleOrAlarm);
@@ -1158,9 +1233,11 @@ void make_user_commands() {
     new UserCommand("RST", "Settings/Restore", restore_settings, notIdleOrAlarm, WA);
 
     new UserCommand("Heap", "Heap/Show", showHeap, anyState);
+    new UserCommand("EV", "Events/Show", showEvents, anyState);
     new UserCommand("SS", "Startup/Show", showStartupLog, anyState);
 
     new UserCommand("RI", "Report/Interval", setReportInterval, anyState);
+    new UserCommand("RB", "Report/Binary", setBinaryReportInterval, anyState);
 
     new UserCommand("30", "FakeMaxSpindleSpeed", fakeMaxSpindleSpeed, notIdleOrAlarm);
     new UserCommand("32", "FakeLaserMode", fakeLaserMode, notIdleOrAlarm);
@@ -1199,6 +1276,7 @@ void make_user_commands() {
     new UserCommand("ESTOP", M+"/estop", maslow_estop, anyState);
     new UserCommand("SETZSTOP", M+"/setZStop", maslow_set_zStop, anyState);
     new UserCommand("MINFO", M+"/getInfo", maslow_get_info, anyState);
+    new UserCommand("CTL", M+"/controlStats", maslow_control_stats, anyState);
 };
 
 // normalize_key puts a key string into canonical form -
@@ -1246,7 +1324,7 @@ Error do_command_or_setting(const char* key, char* value, WebUI::AuthenticationL
     // value if one is given, otherwise display the current value
     try {
         Configuration::RuntimeSetting rts(key, value, out);
-        config->group(rts);
+        rts.handle(config);
 
         if (rts.isHandled_) {
             if (value) {
@@ -1274,46 +1352,37 @@ Error do_command_or_setting(const char* key, char* value, WebUI::AuthenticationL
         return Error::ConfigurationInvalid;
     }
 
-    // Next search the settings list by text name. If found, set a new
-    // value if one is given, otherwise display the current value
-    for (Setting* s = Setting::List; s; s = s->next()) {
-        if (strcasecmp(s->getName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getName(), s->getStringValue(), NULL, out);
-                return Error::Ok;
-            }
-        }
-    }
-
-    // Then search the setting list by compatible name.  If found, set a new
-    // value if one is given, otherwise display the current value in compatible mode
-    for (Setting* s = Setting::List; s; s = s->next()) {
-        if (s->getGrblName() && strcasecmp(s->getGrblName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
+    // Next look up the settings and commands by name.
+    WordIndex::Entry entry;
+    if (WordIndex::find(key, entry)) {
+        switch (entry.kind) {
+            case WordIndex::Kind::Setting:
+            case WordIndex::Kind::GrblSetting: {
+                // A setting: set a new value if one is given, otherwise display
+                // the current value, in compatible mode if named by its Grbl name
+                Setting* s = static_cast<Setting*>(entry.word);
+                if (auth_failed(s, value, auth_level)) {
+                    return Error::AuthenticationFailed;
+                }
+                if (value) {
+                    return s->setStringValue(uriDecode(value));
+                }
+                if (entry.kind == WordIndex::Kind::GrblSetting) {
+                    show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
+                } else {
+                    show_setting(s->getName(), s->getStringValue(), NULL, out);
+                }
                 return Error::Ok;
             }
-        }
-    }
-    // If we did not find a setting, look for a command.  Commands
-    // handle values internally; you cannot determine whether to set
-    // or display solely based on the presence of a value.
-    for (Command* cp = Command::List; cp; cp = cp->next()) {
-        if ((strcasecmp(cp->getName(), key) == 0) || (cp->getGrblName() && strcasecmp(cp->getGrblName(), key) == 0)) {
-            if (auth_failed(cp, value, auth_level)) {
-                return Error::AuthenticationFailed;
+            case WordIndex::Kind::Command: {
+                // Commands handle values internally; you cannot determine whether
+                // to set or display solely based on the presence of a value.
+                Command* cp = static_cast<Command*>(entry.word);
+                if (auth_failed(cp, value, auth_level)) {
+                    return Error::AuthenticationFailed;
+                }
+                return cp->action(value, auth_level, out);
             }
-            return cp->action(value, auth_level, out);
         }
     }
 
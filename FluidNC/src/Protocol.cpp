@@ -9,6 +9,7 @@
 
 #include "Protocol.h"
 #include "Event.h"
+#include "EventQueue.h"
 
 #include "Machine/MachineConfig.h"
 #include "Machine/Homing.h"
@@ -19,6 +20,10 @@
 #include "Settings.h"       // settings_execute_startup
 #include "Machine/LimitPin.h"
 #include "./Maslow/Maslow.h"
+#include "Driver/StepTimer.h"  // stepTimerPoll
+#include "LineQueue.h"
+#include "StatusReport.h"
+#include "LogLine.h"
 
 volatile ExecAlarm rtAlarm;  // Global realtime executor bitflag variable for setting various alarms.
 
@@ -90,14 +95,24 @@ TaskHandle_t outputTask = nullptr;
 
 xQueueHandle message_queue;
 
+enum class LineKind : uint8_t {
+    Fixed,   // const char*, not reclaimed
+    String,  // std::string*, deleted after sending
+    Report,  // StatusReport*, released to its pool after sending
+    Pooled,  // LogLine*, released to its pool after sending
+};
+
 struct LogMessage {
-    Print* channel;
-    void*  line;
-    bool   isString;
+    Print*   channel;
+    void*    line;
+    LineKind kind;
 };
 
+// Set while the output task is writing messages it has taken from the queue
+static volatile bool outputBusy = false;
+
 void drain_messages() {
-    while (uxQueueMessagesWaiting(message_queue)) {
+    while (uxQueueMessagesWaiting(message_queue) || outputBusy) {
         vTaskDelay(1);  // Let the output task finish sending data
     }
 }
@@ -109,7 +124,7 @@ void drain_messages() {
 // with fixed messages.
 void send_line(Print& channel, const char* line) {
     if (outputTask) {
-        LogMessage msg { &channel, (void*)line, false };
+        LogMessage msg { &channel, (void*)line, LineKind::Fixed };
         while (!xQueueSend(message_queue, &msg, 10)) {}
     } else {
         channel.println(line);
@@ -126,7 +141,7 @@ void send_line(Print& channel, const char* line) {
 // is allocated once and freed once.
 void send_line(Print& channel, const std::string* line) {
     if (outputTask) {
-        LogMessage msg { &channel, (void*)line, true };
+        LogMessage msg { &channel, (void*)line, LineKind::String };
         while (!xQueueSend(message_queue, &msg, 10)) {}
     } else {
         channel.println(line->c_str());
@@ -134,50 +149,145 @@ void send_line(Print& channel, const std::string* line) {
     }
 }
 
+// This overload is used by LogStream, which builds most
+// log messages in a LogLine from a preallocated pool.
+// The output task returns the line to the pool after
+// sending it, so nothing is allocated.
+void send_line(Print& channel, LogLine* line) {
+    if (outputTask) {
+        LogMessage msg { &channel, (void*)line, LineKind::Pooled };
+        while (!xQueueSend(message_queue, &msg, 10)) {}
+    } else {
+        channel.println(line->c_str());
+        line->release();
+    }
+}
+
 // This overload is used for many miscellaneous messages
 // where the std::string is allocated in a code block and
 // then extended with various information.  This send_line()
-// copies that string to a newly allocated one and sends that
-// via the std::string* version of send_line().  The original
-// string is freed by the caller sometime after send_line()
-// returns, while the new string is freed by the output task
-// after the message is forwared to the output channel.
-// This is the least efficient form, requiring two strings
-// to be allocated and freed, with an intermediate copy.
-// It is used only rarely.
+// copies that string to a pooled LogLine, or to a newly
+// allocated string if it is too long or the pool is empty,
+// and sends the copy.  The original string is freed by the
+// caller sometime after send_line() returns, while the copy
+// is reclaimed by the output task after the message is
+// forwarded to the output channel.
 void send_line(Print& channel, const std::string& line) {
     if (outputTask) {
-        send_line(channel, new std::string(line));
+        LogLine* pooled = line.length() <= LogLine::maxLength ? LogLine::claim() : nullptr;
+        if (pooled) {
+            pooled->write(line.c_str(), line.length());
+            send_line(channel, pooled);
+        } else {
+            send_line(channel, new std::string(line));
+        }
     } else {
         channel.println(line.c_str());
     }
 }
 
+// This overload is used for realtime status reports, which
+// are built in a pool of fixed buffers to keep frequent
+// reports from allocating memory.  The report is returned
+// to the pool after it has been sent.
+void send_line(Print& channel, StatusReport* report) {
+    if (outputTask) {
+        LogMessage msg { &channel, (void*)report, LineKind::Report };
+        while (!xQueueSend(message_queue, &msg, 10)) {}
+    } else {
+        channel.println(report->c_str());
+        report->release();
+    }
+}
+
+static const char* message_text(const LogMessage& message) {
+    switch (message.kind) {
+        case LineKind::Fixed:
+            return static_cast<const char*>(message.line);
+        case LineKind::String:
+            return static_cast<std::string*>(message.line)->c_str();
+        case LineKind::Report:
+            return static_cast<StatusReport*>(message.line)->c_str();
+        case LineKind::Pooled:
+            return static_cast<LogLine*>(message.line)->c_str();
+    }
+    return "";
+}
+
+static void reclaim(const LogMessage& message) {
+    switch (message.kind) {
+        case LineKind::Fixed:
+            break;
+        case LineKind::String:
+            delete static_cast<std::string*>(message.line);
+            break;
+        case LineKind::Report:
+            static_cast<StatusReport*>(message.line)->release();
+            break;
+        case LineKind::Pooled:
+            static_cast<LogLine*>(message.line)->release();
+            break;
+    }
+}
+
+// The output task sleeps until a message arrives, then gathers it and any
+// messages queued behind it for the same channel into one buffer, so that a
+// burst of log lines or a settings dump costs one channel write - one lock of
+// allChannels, one TCP segment or WebSocket frame - instead of two per line.
+static const size_t batchSize = 1024;
+static char         batch[batchSize];
+
 void output_loop(void* unused) {
+    LogMessage message;
     while (true) {
-        LogMessage message;
-        if (xQueueReceive(message_queue, &message, 0)) {
-            if (message.isString) {
-                std::string* s = static_cast<std::string*>(message.line);
-                message.channel->println(s->c_str());
-                delete s;
+        // Peek first so that drain_messages() cannot see an empty queue
+        // before outputBusy is set
+        xQueuePeek(message_queue, &message, portMAX_DELAY);
+        outputBusy = true;
+        xQueueReceive(message_queue, &message, 0);
+
+        Print* channel = message.channel;
+        size_t length  = 0;
+        while (true) {
+            const char* text = message_text(message);
+            size_t      len  = strlen(text);
+            if (len + 2 > batchSize) {
+                // Too long to batch
+                if (length) {
+                    channel->write(batch, length);
+                    length = 0;
+                }
+                channel->println(text);
             } else {
-                const char* cp = static_cast<const char*>(message.line);
-                message.channel->println(cp);
+                if (length + len + 2 > batchSize) {
+                    channel->write(batch, length);
+                    length = 0;
+                }
+                memcpy(batch + length, text, len);
+                length += len;
+                batch[length++] = '\r';
+                batch[length++] = '\n';
             }
+            reclaim(message);
+
+            if (!xQueuePeek(message_queue, &message, 0) || message.channel != channel) {
+                break;
+            }
+            xQueueReceive(message_queue, &message, 0);
+        }
+        if (length) {
+            channel->write(batch, length);
         }
-        vTaskDelay(0);
+        outputBusy = false;
     }
 }
 
-Channel* activeChannel = nullptr;  // Channel associated with the input line
+LineQueue lineQueue;  // Lines read by the polling task, waiting for the main loop
 
 TaskHandle_t telemetryTask = nullptr;
 
 TaskHandle_t pollingTask = nullptr;
 
-char activeLine[Channel::maxLine];
-
 void stop_telemetry() {
     if (telemetryTask) {
         vTaskSuspend(telemetryTask);
@@ -208,16 +318,20 @@ void polling_loop(void* unused) {
             vTaskDelay(100);
             continue;
         }
-        if (activeChannel) {
+        char* line = lineQueue.reserve();
+        if (!line) {
             // Poll for realtime characters when waiting for the primary loop
-            // (in another thread) to pick up the line.
+            // (in another thread) to make room for another line.
             pollChannels();
             continue;
         }
 
-        // Polling without an argument both checks for realtime characters and
+        // Polling with a line buffer both checks for realtime characters and
         // returns a line-oriented command if one is ready.
-        activeChannel = pollChannels(activeLine);
+        Channel* channel = pollChannels(line);
+        if (channel) {
+            lineQueue.push(channel);
+        }
     }
 }
 
@@ -299,20 +413,26 @@ void     protocol_main_loop() {
     // This is also where the system idles while waiting for something to do.
     // ---------------------------------------------------------------------------------
     for (;; vTaskDelay(0)) {
-        if (activeChannel) {
-            // The input polling task has collected a line of input
+        char*    line;
+        Channel* channel;
+        if (lineQueue.front(line, channel)) {
+            // The input polling task has collected a line of input.  Lines from
+            // a channel that has stopped on an error, like a failed file job, are
+            // dropped.  The channel is not deleted until its lines are popped.
+            if (!channel->stopped()) {
 #ifdef DEBUG_REPORT_ECHO_RAW_LINE_RECEIVED
-            report_echo_line_received(activeLine, allChannels);
+                report_echo_line_received(line, allChannels);
 #endif
 
-            Error status_code = execute_line(activeLine, *activeChannel, WebUI::AuthenticationLevel::LEVEL_GUEST);
+                Error status_code = execute_line(line, *channel, WebUI::AuthenticationLevel::LEVEL_GUEST);
 
-            // Tell the channel that the line has been processed.
-            activeChannel->ack(status_code);
+                // Tell the channel that the line has been processed.
+                channel->ack(status_code);
+            }
 
             // Tell the input polling task that the line has been processed,
-            // so it can give us another one when available
-            activeChannel = nullptr;
+            // so it can reuse its buffer
+            lineQueue.pop();
         }
 
         // Auto-cycle start any queued moves.
@@ -860,6 +980,9 @@ void protocol_exec_rt_system() {
 
     //do all the Maslow stuff here
     Maslow.update();
+
+    stepTimerPoll();
+
     // Reload step segment buffer
     switch (sys.state()) {
         case State::ConfigAlarm:
@@ -1106,43 +1229,35 @@ ArgEvent feedOverrideEvent { protocol_do_feed_override };
 ArgEvent rapidOverrideEvent { protocol_do_rapid_override };
 ArgEvent spindleOverrideEvent { protocol_do_spindle_override };
 ArgEvent accessoryOverrideEvent { protocol_do_accessory_override };
-ArgEvent limitEvent { protocol_do_limit };
+ArgEvent limitEvent { protocol_do_limit, EventPriority::Control };
 
 ArgEvent reportStatusEvent { (void (*)(void*))report_realtime_status };
 
-NoArgEvent safetyDoorEvent { request_safety_door };
-NoArgEvent feedHoldEvent { protocol_do_feedhold };
-NoArgEvent cycleStartEvent { protocol_do_cycle_start };
-NoArgEvent cycleStopEvent { protocol_do_cycle_stop };
-NoArgEvent motionCancelEvent { protocol_do_motion_cancel };
-NoArgEvent sleepEvent { protocol_do_sleep };
+NoArgEvent safetyDoorEvent { request_safety_door, EventPriority::Control };
+NoArgEvent feedHoldEvent { protocol_do_feedhold, EventPriority::Control };
+NoArgEvent cycleStartEvent { protocol_do_cycle_start, EventPriority::Control };
+NoArgEvent cycleStopEvent { protocol_do_cycle_stop, EventPriority::Control };
+NoArgEvent motionCancelEvent { protocol_do_motion_cancel, EventPriority::Control };
+NoArgEvent sleepEvent { protocol_do_sleep, EventPriority::Control };
 NoArgEvent debugEvent { report_realtime_debug };
 
 // Only mc_reset() is permitted to set rtReset.
-NoArgEvent resetEvent { mc_reset };
+NoArgEvent resetEvent { mc_reset, EventPriority::Control };
 
 // The problem is that report_realtime_status needs a channel argument
 // Event statusReportEvent { protocol_do_status_report(XXX) };
 
-xQueueHandle event_queue;
-
 void protocol_init() {
-    event_queue   = xQueueCreate(10, sizeof(EventItem));
-    message_queue = xQueueCreate(10, sizeof(LogMessage));
+    message_queue = xQueueCreate(16, sizeof(LogMessage));
 }
 
+// Both can be called from tasks and interrupt handlers; see EventQueue.h
 void IRAM_ATTR protocol_send_event_from_ISR(Event* evt, void* arg) {
-    EventItem item { evt, arg };
-    xQueueSendFromISR(event_queue, &item, NULL);
+    eventQueue.send(evt, arg);
 }
-void protocol_send_event(Event* evt, void* arg) {
-    EventItem item { evt, arg };
-    xQueueSend(event_queue, &item, 0);
+void IRAM_ATTR protocol_send_event(Event* evt, void* arg) {
+    eventQueue.send(evt, arg);
 }
 void protocol_handle_events() {
-    EventItem item;
-    while (xQueueReceive(event_queue, &item, 0)) {
-        // log_debug("event");
-        item.event->run(item.arg);
-    }
+    while (eventQueue.dispatch()) {}
 }
@@ -97,15 +97,8 @@ extern NoArgEvent debugEvent;
 
 // extern NoArgEvent statusReportEvent;
 
-extern xQueueHandle event_queue;
-
 extern bool pollingPaused;
 
-struct EventItem {
-    Event* event;
-    void*  arg;
-};
-
 void protocol_send_event(Event*, void* arg = 0);
 void protocol_handle_events();
 
@@ -115,9 +108,14 @@ inline void protocol_send_event(Event* evt, int arg) {
 
 void protocol_send_event_from_ISR(Event* evt, void* arg = 0);
 
+class StatusReport;
+class LogLine;
+
 void send_line(Print& channel, const char* message);
 void send_line(Print& channel, const std::string* message);
 void send_line(Print& channel, const std::string& message);
+void send_line(Print& channel, StatusReport* report);
+void send_line(Print& channel, LogLine* line);
 
 void drain_messages();
 
@@ -32,12 +32,15 @@
 #include "WebUI/BTConfig.h"              // bt_config
 #include "WebUI/WebSettings.h"
 #include "InputFile.h"
+#include "StatusReport.h"
+#include "Maslow/Maslow.h"  // belt lengths and currents
 
 #include <map>
 #include <freertos/task.h>
 #include <cstring>
 #include <cstdio>
 #include <cstdarg>
+#include <cmath>
 #include <sstream>
 #include <iomanip>
 
@@ -59,16 +62,17 @@ void _notifyf(const char* title, const char* format, ...) {
     va_start(arg, format);
     va_copy(copy, arg);
     size_t len = vsnprintf(NULL, 0, format, arg);
-    va_end(copy);
+    va_end(arg);
     if (len >= sizeof(loc_buf)) {
         temp = new char[len + 1];
         if (temp == NULL) {
+            va_end(copy);
             return;
         }
     }
-    len = vsnprintf(temp, len + 1, format, arg);
+    len = vsnprintf(temp, len + 1, format, copy);
     _notify(title, temp);
-    va_end(arg);
+    va_end(copy);
     if (temp != loc_buf) {
         delete[] temp;
     }
@@ -258,6 +262,12 @@ void report_gcode_modes(Channel& channel) {
         case Motion::CcwArc:
             msg << "G3";
             break;
+        case Motion::CubicSpline:
+            msg << "G5";
+            break;
+        case Motion::QuadraticSpline:
+            msg << "G5.1";
+            break;
         case Motion::ProbeToward:
             msg << "G38.2";
             break;
@@ -489,15 +499,10 @@ const char* state_name() {
     return "";
 }
 
-static std::string pinString() {
-    std::string msg;
-    bool        prefixNeeded = true;
+static void report_pins(StatusReport& msg) {
+    char pins[MAX_N_AXIS + 16] = "";  // Probe, limits and the control pins
     if (config->_probe->get_state()) {
-        if (prefixNeeded) {
-            prefixNeeded = false;
-            msg += "|Pn:";
-        }
-        msg += 'P';
+        addPinReport(pins, 'P');
     }
 
     MotorMask lim_pin_state = limits_get_state();
@@ -506,37 +511,88 @@ static std::string pinString() {
         for (size_t axis = 0; axis < n_axis; axis++) {
             if (bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 0)) ||
                 bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 1))) {
-                if (prefixNeeded) {
-                    prefixNeeded = false;
-                    msg += "|Pn:";
-                }
-                msg += config->_axes->axisName(axis);
+                addPinReport(pins, config->_axes->axisName(axis));
             }
         }
     }
 
-    std::string ctrl_pin_report = config->_control->report_status();
-    if (ctrl_pin_report.length()) {
-        if (prefixNeeded) {
-            prefixNeeded = false;
-            msg += "|Pn:";
-        }
-        msg += ctrl_pin_report;
+    config->_control->report_status(pins);
+    if (*pins) {
+        msg << "|Pn:" << pins;
     }
-    return msg;
 }
 
 // Define this to do something if a debug request comes in over serial
 void report_realtime_debug() {}
 
-// Prints real-time data. This function grabs a real-time snapshot of the stepper subprogram
-// and the actual location of the CNC machine. Users may change the following function to their
-// specific needs, but the desired real-time data report must be as short as possible. This is
-// requires as it minimizes the computational overhead to keep running smoothly,
-// especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
-void report_realtime_status(Channel& channel) {
-    LogStream msg(channel, "<");
-    msg << state_name();
+// The WCO and override fields are sent only every few reports and change
+// rarely, so their text is kept until their values change.
+struct WcoKey {
+    float    wco[MAX_N_AXIS];
+    uint32_t n_axis;
+    uint32_t inches;
+};
+
+struct OverrideKey {
+    Percent feed;
+    Percent rapid;
+    Percent spindle_speed;
+    uint8_t spindle;
+    uint8_t coolant;
+};
+
+static CachedReportText<WcoKey, StatusReport::maxLength / 2> wcoText;
+static CachedReportText<OverrideKey, 24>                     overrideText;
+
+static void report_wco(StatusReport& msg) {
+    WcoKey key;
+    memcpy(key.wco, get_wco(), sizeof(key.wco));
+    key.n_axis = config->_axes->_numberAxis;
+    key.inches = config->_reportInches;
+    wcoText.print(msg, key, [&key](StatusReport& msg) {
+        msg << "|WCO:";
+        msg.axes(key.wco, key.n_axis, key.inches);
+    });
+}
+
+static void report_overrides(StatusReport& msg) {
+    SpindleState sp_state      = spindle->get_state();
+    CoolantState coolant_state = config->_coolant->get_state();
+    OverrideKey  key { sys.f_override(),
+                      sys.r_override(),
+                      sys.spindle_speed_ovr(),
+                      uint8_t(sp_state),
+                      uint8_t(coolant_state.Mist | (coolant_state.Flood << 1)) };
+    overrideText.print(msg, key, [&](StatusReport& msg) {
+        msg << "|Ov:" << int(key.feed) << "," << int(key.rapid) << "," << int(key.spindle_speed);
+        if (sp_state != SpindleState::Disable || coolant_state.Mist || coolant_state.Flood) {
+            msg << "|A:";
+            switch (sp_state) {
+                case SpindleState::Disable:
+                    break;
+                case SpindleState::Cw:
+                    msg << "S";
+                    break;
+                case SpindleState::Ccw:
+                    msg << "C";
+                    break;
+                case SpindleState::Unknown:
+                    break;
+            }
+
+            auto coolant = coolant_state;
+            if (coolant.Flood) {
+                msg << "F";
+            }
+            if (coolant.Mist) {
+                msg << "M";
+            }
+        }
+    });
+}
+
+static void build_realtime_status(StatusReport& msg, Channel& channel) {
+    msg << "<" << state_name();
 
     // Report position
     float* print_position = get_mpos();
@@ -546,7 +602,7 @@ void report_realtime_status(Channel& channel) {
         msg << "|WPos:";
         mpos_to_wpos(print_position);
     }
-    msg << report_util_axis_values(print_position).c_str();
+    msg.axes(print_position, config->_axes->_numberAxis, config->_reportInches);
 
     // Returns planner and serial read buffer states.
 
@@ -570,9 +626,11 @@ void report_realtime_status(Channel& channel) {
     if (config->_reportInches) {
         rate /= MM_PER_INCH;
     }
-    msg << "|FS:" << setprecision(0) << rate << "," << sys.spindle_speed();
+    msg << "|FS:";
+    msg.fixed(rate, 0);
+    msg << "," << sys.spindle_speed();
 
-    msg << pinString();
+    report_pins(msg);
 
     if (report_wco_counter > 0) {
         report_wco_counter--;
@@ -591,7 +649,7 @@ void report_realtime_status(Channel& channel) {
         if (report_ovr_counter == 0) {
             report_ovr_counter = 1;  // Set override on next report.
         }
-        msg << "|WCO:" << report_util_axis_values(get_wco()).c_str();
+        report_wco(msg);
     }
 
     if (report_ovr_counter > 0) {
@@ -608,37 +666,9 @@ void report_realtime_status(Channel& channel) {
                 report_ovr_counter = (REPORT_OVR_REFRESH_IDLE_COUNT - 1);
                 break;
         }
-
-        msg << "|Ov:" << int(sys.f_override()) << "," << int(sys.r_override()) << "," << int(sys.spindle_speed_ovr());
-        SpindleState sp_state      = spindle->get_state();
-        CoolantState coolant_state = config->_coolant->get_state();
-        if (sp_state != SpindleState::Disable || coolant_state.Mist || coolant_state.Flood) {
-            msg << "|A:";
-            switch (sp_state) {
-                case SpindleState::Disable:
-                    break;
-                case SpindleState::Cw:
-                    msg << "S";
-                    break;
-                case SpindleState::Ccw:
-                    msg << "C";
-                    break;
-                case SpindleState::Unknown:
-                    break;
-            }
-
-            auto coolant = coolant_state;
-            if (coolant.Flood) {
-                msg << "F";
-            }
-            if (coolant.Mist) {
-                msg << "M";
-            }
-        }
-    }
-    if (InputFile::_progress.length()) {
-        msg << "|" + InputFile::_progress;
+        report_overrides(msg);
     }
+    InputFile::reportProgress(msg);
 #ifdef DEBUG_STEPPER_ISR
     msg << "|ISRs:" << Stepper::isr_count;
 #endif
@@ -646,8 +676,78 @@ void report_realtime_status(Channel& channel) {
     msg << "|Heap:" << esp.getHeapSize();
 #endif
     msg << ">";
-    // The DebugStream destructor sends the line
-    // when msg goes out of scope
+}
+
+// Prints real-time data. This function grabs a real-time snapshot of the stepper subprogram
+// and the actual location of the CNC machine. Users may change the following function to their
+// specific needs, but the desired real-time data report must be as short as possible. This is
+// requires as it minimizes the computational overhead to keep running smoothly,
+// especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
+// The report is built in a pooled fixed buffer, so it does not use the heap.
+void report_realtime_status(Channel& channel) {
+    StatusReport* report = StatusReport::claim();
+    if (report) {
+        build_realtime_status(*report, channel);
+        send_line(channel, report);
+    } else {
+        // Every pooled report is still waiting for the output task
+        StatusReport local;
+        build_realtime_status(local, channel);
+        send_line(channel, std::string(local.c_str()));
+    }
+}
+
+static int32_t micrometers(float mm) {
+    return int32_t(lroundf(mm * 1000.0f));
+}
+
+void report_binary_sample(BinaryReport::Sample& sample, Channel& channel) {
+    auto   n_axis = config->_axes->_numberAxis;
+    float* mpos   = get_mpos();
+    float* wco    = get_wco();
+    sample.time   = millis();
+    sample.n_axis = n_axis;
+    sample.state  = int32_t(sys.state());
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        sample.mpos[axis] = micrometers(mpos[axis]);
+        sample.wco[axis]  = micrometers(wco[axis]);
+    }
+    sample.feed            = int32_t(lroundf(Stepper::get_realtime_rate()));
+    sample.spindle         = sys.spindle_speed();
+    sample.feedOverride    = sys.f_override();
+    sample.rapidOverride   = sys.r_override();
+    sample.spindleOverride = sys.spindle_speed_ovr();
+
+    SpindleState sp_state      = spindle->get_state();
+    CoolantState coolant_state = config->_coolant->get_state();
+    sample.accessories         = 0;
+    if (sp_state == SpindleState::Cw) {
+        sample.accessories |= BinaryReport::SpindleCw;
+    } else if (sp_state == SpindleState::Ccw) {
+        sample.accessories |= BinaryReport::SpindleCcw;
+    }
+    if (coolant_state.Flood) {
+        sample.accessories |= BinaryReport::Flood;
+    }
+    if (coolant_state.Mist) {
+        sample.accessories |= BinaryReport::Mist;
+    }
+
+    sample.plannerAvailable = plan_get_block_buffer_available();
+    sample.rxAvailable      = channel.rx_buffer_available();
+    plan_block_t* cur_block = plan_get_current_block();
+    sample.lineNumber       = cur_block ? cur_block->line_number : 0;
+    sample.limits           = limits_get_state();
+    sample.probe            = config->_probe->get_state();
+
+    sample.hasBelts = !Maslow.using_default_config;
+    if (sample.hasBelts) {
+        MotorUnit* motors[BinaryReport::beltCount] = { &Maslow.axisTL, &Maslow.axisTR, &Maslow.axisBL, &Maslow.axisBR };
+        for (int i = 0; i < BinaryReport::beltCount; i++) {
+            sample.belt[i]    = micrometers(motors[i]->getPosition());
+            sample.current[i] = int32_t(lround(motors[i]->getMotorCurrent()));
+        }
+    }
 }
 
 void hex_msg(uint8_t* buf, const char* prefix, int len) {
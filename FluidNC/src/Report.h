@@ -11,6 +11,7 @@
 #include "Error.h"
 #include "Config.h"
 #include "Serial.h"  // CLIENT_xxx
+#include "BinaryReport.h"
 
 #include <cstdint>
 #include <freertos/FreeRTOS.h>  // UBaseType_t
@@ -62,6 +63,9 @@ void report_echo_line_received(char* line, Channel& channel);
 // Prints realtime status report
 void report_realtime_status(Channel& channel);
 
+// Collects the values that a binary report sends, in its integer units
+void report_binary_sample(BinaryReport::Sample& sample, Channel& channel);
+
 // Prints recorded probe position
 void report_probe_parameters(Channel& channel);
 
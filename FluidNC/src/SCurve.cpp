@@ -0,0 +1,240 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "SCurve.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Bisection steps for the peak; 24 halvings reach float precision
+static const int searchSteps = 24;
+
+// The positive root of t^3 + p*t = q, for p and q at least zero
+static float cubicRoot(float p, float q) {
+    if (p <= 0.0f) {
+        return cbrtf(q);
+    }
+    float k = 2.0f * sqrtf(p / 3.0f);
+    return k * sinhf(asinhf(3.0f * q / (p * k)) / 3.0f);
+}
+
+float SCurveRamp::rampTime(float dv, float maxAccel, float jerk) {
+    if (dv <= 0.0f) {
+        return 0.0f;
+    }
+    if (jerk <= 0.0f) {
+        return dv / maxAccel;
+    }
+    if (dv >= maxAccel * maxAccel / jerk) {
+        // Reaches the acceleration limit and holds it for a while
+        return dv / maxAccel + maxAccel / jerk;
+    }
+    // Too small a change to reach the acceleration limit
+    return 2.0f * sqrtf(dv / jerk);
+}
+
+float SCurveRamp::rampDistance(float v0, float v1, float maxAccel, float jerk) {
+    // The ramp is symmetric in time, so it runs at the mean of the two speeds
+    return (v0 + v1) / 2.0f * rampTime(fabsf(v1 - v0), maxAccel, jerk);
+}
+
+float SCurveRamp::reachableSpeed(float v0, float mm, float maxAccel, float jerk) {
+    if (mm <= 0.0f) {
+        return v0;
+    }
+    if (jerk <= 0.0f) {
+        return sqrtf(v0 * v0 + 2.0f * maxAccel * mm);
+    }
+    float knee = maxAccel * maxAccel / jerk;  // The smallest change that reaches maxAccel
+    if (mm <= rampDistance(v0, v0 + knee, maxAccel, jerk)) {
+        // mm = (2*v0 + dv) * sqrt(dv/jerk), a cubic in sqrt(dv)
+        float s = cubicRoot(2.0f * v0, mm * sqrtf(jerk));
+        return v0 + s * s;
+    }
+    // mm = (v0 + dv/2) * (dv/maxAccel + maxAccel/jerk), a quadratic in dv
+    float b = 2.0f * v0 + knee;
+    float c = 2.0f * maxAccel * mm - 2.0f * v0 * knee;
+    return v0 + 2.0f * c / (b + sqrtf(b * b + 4.0f * c));
+}
+
+float SCurveRamp::ceilingSpeed(float v0, float mm, float maxAccel, float jerk) {
+    if (mm <= 0.0f) {
+        return v0;
+    }
+    if (jerk <= 0.0f) {
+        return sqrtf(v0 * v0 + 2.0f * maxAccel * mm);
+    }
+    // The fastest motion raises the acceleration at the jerk limit until it
+    // reaches maxAccel, then holds it
+    float t1 = maxAccel / jerk;
+    float d1 = v0 * t1 + jerk * t1 * t1 * t1 / 6.0f;
+    if (mm <= d1) {
+        // mm = v0*t + jerk*t^3/6
+        float t = cubicRoot(6.0f * v0 / jerk, 6.0f * mm / jerk);
+        return v0 + jerk * t * t / 2.0f;
+    }
+    float v1 = v0 + maxAccel * t1 / 2.0f;
+    return sqrtf(v1 * v1 + 2.0f * maxAccel * (mm - d1));
+}
+
+float SCurveRamp::averageAcceleration(float speed, float maxAccel, float jerk) {
+    if (speed <= 0.0f || jerk <= 0.0f) {
+        return maxAccel;
+    }
+    return speed / rampTime(speed, maxAccel, jerk);
+}
+
+// Lays out a rising ramp through dv with the given peak and jerk, and returns
+// the distance it covers
+float SCurveRamp::shape(float dv, float peak, float jerk) {
+    _peak = peak;
+    _jerk = jerk;
+    _t1   = fabsf(peak - _as) / jerk;
+    _t2   = fabsf(peak - _ae) / jerk;
+    _th   = std::max((dv - (_as + peak) * _t1 / 2.0f - (peak + _ae) * _t2 / 2.0f) / peak, 0.0f);
+
+    _u1     = _u0 + (_as + peak) * _t1 / 2.0f;
+    _d1     = _u0 * _t1 + _as * _t1 * _t1 / 2.0f + (peak - _as) * _t1 * _t1 / 6.0f;
+    _u2     = _u1 + peak * _th;
+    _d2     = _d1 + _u1 * _th + peak * _th * _th / 2.0f;
+    _time   = _t1 + _th + _t2;
+    _length = _d2 + _u2 * _t2 + peak * _t2 * _t2 / 2.0f + (_ae - peak) * _t2 * _t2 / 6.0f;
+    return _length;
+}
+
+void SCurveRamp::begin(float v0, float v1, float a0, float a1, float maxAccel) {
+    _falling = v1 < v0;
+    _u0      = std::min(v0, v1);
+    _as      = std::clamp(_falling ? a1 : a0, 0.0f, maxAccel);
+    _ae      = std::clamp(_falling ? a0 : a1, 0.0f, maxAccel);
+}
+
+// Holds the speed over the distance
+void SCurveRamp::hold(float mm) {
+    _as = _ae = _peak = _jerk = 0.0f;
+    _t1 = _t2 = 0.0f;
+    _th       = _u0 > 0.0f ? mm / _u0 : 0.0f;
+    _u1 = _u2 = _u0;
+    _d1       = 0.0f;
+    _d2 = _length = std::max(mm, 0.0f);
+    _time         = _th;
+}
+
+bool SCurveRamp::plan(float v0, float v1, float mm, float a0, float a1, float maxAccel, float jerk) {
+    begin(v0, v1, a0, a1, maxAccel);
+
+    float dv = fabsf(v1 - v0);
+    if (dv <= 0.0f || mm <= 0.0f || maxAccel <= 0.0f) {
+        hold(mm);
+        return dv <= 0.0f;
+    }
+
+    if (jerk <= 0.0f) {
+        // No jerk limit, so the ramp is linear
+        _as = _ae = dv * (2.0f * _u0 + dv) / (2.0f * mm);
+        shape(dv, _as, 1.0f);
+        _jerk = 0.0f;
+        return _as <= maxAccel;
+    }
+
+    // A higher peak covers less distance, so the bounds on the peak bound the distance
+    float sum    = _as * _as + _ae * _ae;
+    float spread = fabsf(_as * _as - _ae * _ae);
+    float lo     = std::max(sqrtf(std::max((sum - 2.0f * jerk * dv) / 2.0f, 0.0f)), maxAccel * 1e-6f);
+    float hi     = std::min(sqrtf((sum + 2.0f * jerk * dv) / 2.0f), maxAccel);
+    if (spread > 2.0f * jerk * dv || hi < lo) {
+        shape(dv, std::max(hi, lo), jerk);  // Cannot even get from _as to _ae
+        return false;
+    }
+    if (shape(dv, hi, jerk) > mm) {
+        return false;  // Too short, even at the highest peak
+    }
+    if (shape(dv, lo, jerk) < mm) {
+        return false;  // Too long, even at the lowest peak
+    }
+
+    // Search for the peak that covers mm, keeping the one that does not overshoot
+    for (int i = 0; i < searchSteps; i++) {
+        float mid = (lo + hi) / 2.0f;
+        if (shape(dv, mid, jerk) > mm) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    shape(dv, hi, jerk);
+    return true;
+}
+
+bool SCurveRamp::fastest(float v0, float v1, float a0, float maxAccel, float jerk) {
+    begin(v0, v1, a0, 0.0f, maxAccel);
+
+    float dv = fabsf(v1 - v0);
+    if (dv <= 0.0f || jerk <= 0.0f || maxAccel <= 0.0f) {
+        hold(0.0f);
+        return dv <= 0.0f && a0 <= 0.0f;
+    }
+
+    float sum    = _as * _as + _ae * _ae;
+    float spread = fabsf(_as * _as - _ae * _ae);
+    float top    = std::min(sqrtf((sum + 2.0f * jerk * dv) / 2.0f), maxAccel);
+    shape(dv, std::max(top, std::max(_as, _ae)), jerk);
+    return spread <= 2.0f * jerk * dv;
+}
+
+float SCurveRamp::risingAcceleration(float t) const {
+    if (t < _t1) {
+        return _as + (_peak - _as) * t / _t1;
+    }
+    t -= _t1;
+    if (t < _th || _t2 <= 0.0f) {
+        return _peak;
+    }
+    t = std::min(t - _th, _t2);
+    return _peak + (_ae - _peak) * t / _t2;
+}
+
+float SCurveRamp::risingSpeed(float t) const {
+    if (t < _t1) {
+        return _u0 + _as * t + (_peak - _as) * t * t / (2.0f * _t1);
+    }
+    t -= _t1;
+    if (t < _th) {
+        return _u1 + _peak * t;
+    }
+    t = std::min(t - _th, _t2);
+    if (_t2 <= 0.0f) {
+        return _u2;
+    }
+    return _u2 + _peak * t + (_ae - _peak) * t * t / (2.0f * _t2);
+}
+
+float SCurveRamp::risingDistance(float t) const {
+    if (t < _t1) {
+        return _u0 * t + _as * t * t / 2.0f + (_peak - _as) * t * t * t / (6.0f * _t1);
+    }
+    t -= _t1;
+    if (t < _th) {
+        return _d1 + _u1 * t + _peak * t * t / 2.0f;
+    }
+    t = std::min(t - _th, _t2);
+    if (_t2 <= 0.0f) {
+        return _d2;
+    }
+    return _d2 + _u2 * t + _peak * t * t / 2.0f + (_ae - _peak) * t * t * t / (6.0f * _t2);
+}
+
+float SCurveRamp::speed(float t) const {
+    t = std::clamp(t, 0.0f, _time);
+    return _falling ? risingSpeed(_time - t) : risingSpeed(t);
+}
+
+float SCurveRamp::distance(float t) const {
+    t = std::clamp(t, 0.0f, _time);
+    return _falling ? _length - risingDistance(_time - t) : risingDistance(t);
+}
+
+float SCurveRamp::acceleration(float t) const {
+    t = std::clamp(t, 0.0f, _time);
+    return _falling ? -risingAcceleration(_time - t) : risingAcceleration(t);
+}
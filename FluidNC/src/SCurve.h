@@ -0,0 +1,99 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  SCurveRamp shapes one velocity ramp of a jerk-limited motion.
+
+  Its acceleration changes linearly from its value at the start to a peak,
+  holds there, and changes linearly to its value at the end:
+
+      a0 --jerk--> peak ----------> peak --jerk--> a1
+
+  The peak never exceeds the acceleration limit and the acceleration never
+  changes faster than the jerk limit.  A ramp that cannot meet its speeds and
+  distance within both limits is reported as not fitting rather than made to
+  fit by breaking one of them, so the planner has to leave room for it.
+
+  The static functions give the planner that room.  They are exact for ramps
+  that start and end at zero acceleration, which is how the planner treats
+  the junctions it anchors a jerk-limited profile to.
+
+  Units are mm and minutes, as in the segment generator.  Accelerations passed
+  to plan() are magnitudes in the direction of the speed change; acceleration()
+  returns the signed value.
+*/
+
+class SCurveRamp {
+public:
+    // Lays out the ramp from v0 at acceleration a0 to v1 at a1 that covers
+    // exactly mm.  Returns false if no ramp within maxAccel and jerk does, in
+    // which case the ramp is the nearest one that stays within both.
+    bool plan(float v0, float v1, float mm, float a0, float a1, float maxAccel, float jerk);
+
+    // Lays out the shortest ramp from v0 at acceleration a0 to v1 at zero
+    // acceleration.  Returns false if the jerk limit cannot bring a0 to zero
+    // within the change of speed.
+    bool fastest(float v0, float v1, float a0, float maxAccel, float jerk);
+
+    float duration() const { return _time; }
+    float length() const { return _length; }
+    float peak() const { return _peak; }
+    float jerk() const { return _jerk; }
+
+    // At time t from the start of the ramp
+    float speed(float t) const;
+    float distance(float t) const;
+    float acceleration(float t) const;
+
+    // The time and distance of the shortest ramp between two speeds that
+    // starts and ends at zero acceleration
+    static float rampTime(float dv, float maxAccel, float jerk);
+    static float rampDistance(float v0, float v1, float maxAccel, float jerk);
+
+    // The highest speed that such a ramp can reach from v0 within mm, or fall
+    // from to v0.  It bounds the speed at a junction mm from another junction
+    // where the acceleration is zero.
+    static float reachableSpeed(float v0, float mm, float maxAccel, float jerk);
+
+    // The highest speed that any motion can have mm from a point where it runs
+    // at v0 with zero acceleration.  Below it a junction does not limit the
+    // motion around it, so the planner need not hold zero acceleration there.
+    static float ceilingSpeed(float v0, float mm, float maxAccel, float jerk);
+
+    // The average acceleration of the shortest ramp from rest to speed.
+    // Forced decelerations, which stay linear, use it.
+    static float averageAcceleration(float speed, float maxAccel, float jerk);
+
+private:
+    // The ramp is stored rising, from _u0 to a higher speed.  A falling ramp
+    // is the same ramp run backwards in time.  Everything is set by plan()
+    // or fastest(), and the class stays trivial so that Stepper can clear it with memset.
+    bool _falling;
+
+    float _u0;
+    float _as;  // Acceleration at the start
+    float _ae;  // Acceleration at the end
+    float _peak;
+    float _jerk;
+
+    float _t1;  // Change from _as to _peak
+    float _th;  // Hold at _peak
+    float _t2;  // Change from _peak to _ae
+
+    float _u1;  // Speed and distance at the end of each phase
+    float _d1;
+    float _u2;
+    float _d2;
+
+    float _time;
+    float _length;
+
+    void  begin(float v0, float v1, float a0, float a1, float maxAccel);
+    void  hold(float mm);
+    float shape(float dv, float peak, float jerk);
+    float risingSpeed(float t) const;
+    float risingDistance(float t) const;
+    float risingAcceleration(float t) const;
+};
@@ -48,6 +48,7 @@
 #include "System.h"
 #include "Protocol.h"  // *Event
 #include "InputFile.h"
+#include "LineQueue.h"
 #include "WebUI/InputBuffer.h"  // XXX could this be a StringStream ?
 #include "Main.h"               // display()
 #include "StartupLog.h"         // startupLog
@@ -265,10 +266,37 @@ size_t AllChannels::write(const uint8_t* buffer, size_t length) {
     return length;
 }
 Channel* AllChannels::pollLine(char* line) {
+    // A killed channel is no longer polled, but it is only deleted once the
+    // main loop has executed and acked every line it queued, such as the last
+    // lines of a file job.  The channels that can go are chosen before taking
+    // new kills, because an ack that kills its channel does so before the line
+    // leaves the queue, so that kill is always seen before the delete.
+    std::vector<Channel*> done;
+    for (auto it = _dying.begin(); it != _dying.end();) {
+        if (lineQueue.holds(*it)) {
+            ++it;
+        } else {
+            done.push_back(*it);
+            it = _dying.erase(it);
+        }
+    }
+
     Channel* deadChannel;
     while (xQueueReceive(_killQueue, &deadChannel, 0)) {
+        if (std::find(done.begin(), done.end(), deadChannel) != done.end() ||
+            std::find(_dying.begin(), _dying.end(), deadChannel) != _dying.end()) {
+            continue;  // Already killed
+        }
         deregistration(deadChannel);
-        delete deadChannel;
+        if (lineQueue.holds(deadChannel)) {
+            _dying.push_back(deadChannel);
+        } else {
+            done.push_back(deadChannel);
+        }
+    }
+
+    for (auto channel : done) {
+        delete channel;
     }
 
     // To avoid starving other channels when one has a lot
@@ -76,6 +76,9 @@ class AllChannels : public Channel {
     Channel*     _lastChannel = nullptr;
     xQueueHandle _killQueue;
 
+    // Killed channels whose lines are still in lineQueue, only used by the polling task
+    std::vector<Channel*> _dying;
+
     static std::mutex _mutex;
 
 public:
@@ -10,6 +10,7 @@
 #include <limits>
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <nvs.h>
 
 bool anyState() {
@@ -28,6 +29,56 @@ bool cycleOrHold() {
 Word::Word(type_t type, permissions_t permissions, const char* description, const char* grblName, const char* fullName) :
     _description(description), _grblName(grblName), _fullName(fullName), _type(type), _permissions(permissions) {}
 
+std::vector<WordIndex::Entry> WordIndex::_entries;
+std::mutex                    WordIndex::_mutex;
+bool                          WordIndex::_stale = true;
+
+static bool nameLess(const WordIndex::Entry& entry, const char* key) {
+    return strcasecmp(entry.name, key) < 0;
+}
+
+static bool keyLess(const char* key, const WordIndex::Entry& entry) {
+    return strcasecmp(key, entry.name) < 0;
+}
+
+void WordIndex::build() {
+    // Each entry goes after any with the same name, so that those are in
+    // order of precedence.  This runs only a few times, during startup.
+    _entries.clear();
+    auto add = [](const char* name, Word* word, Kind kind) {
+        _entries.insert(std::upper_bound(_entries.begin(), _entries.end(), name, keyLess), { name, word, kind });
+    };
+    for (Setting* s = Setting::List; s; s = s->next()) {
+        add(s->getName(), s, Kind::Setting);
+    }
+    for (Setting* s = Setting::List; s; s = s->next()) {
+        if (s->getGrblName()) {
+            add(s->getGrblName(), s, Kind::GrblSetting);
+        }
+    }
+    for (Command* cp = Command::List; cp; cp = cp->next()) {
+        add(cp->getName(), cp, Kind::Command);
+        if (cp->getGrblName()) {
+            add(cp->getGrblName(), cp, Kind::Command);
+        }
+    }
+    _entries.shrink_to_fit();
+    _stale = false;
+}
+
+bool WordIndex::find(const char* key, Entry& entry) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_stale) {
+        build();
+    }
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), key, nameLess);
+    if (it == _entries.end() || strcasecmp(it->name, key) != 0) {
+        return false;
+    }
+    entry = *it;
+    return true;
+}
+
 Command* Command::List = NULL;
 
 Command::Command(
@@ -36,6 +87,7 @@ Command::Command(
     _cmdChecker(cmdChecker) {
     link = List;
     List = this;
+    WordIndex::invalidate();
 }
 
 Setting* Setting::List = NULL;
@@ -46,6 +98,7 @@ Setting::Setting(
     _checker(checker) {
     link = List;
     List = this;
+    WordIndex::invalidate();
 
     // NVS keys are limited to 15 characters, so if the setting name is longer
     // than that, we derive a 15-character name from a hash function
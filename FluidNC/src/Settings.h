@@ -6,6 +6,8 @@
 #include "GCode.h"   // CoordIndex
 
 #include <map>
+#include <mutex>
+#include <vector>
 #include <nvs.h>
 
 // Initialize the configuration subsystem
@@ -76,6 +78,44 @@ public:
     const char*   getDescription() { return _description; }
 };
 
+// WordIndex finds settings and commands by name for do_command_or_setting(),
+// with a binary search of a sorted table instead of scans of Setting::List
+// and Command::List.  Names are compared ignoring case.  A key can match the
+// full name of a setting, the Grbl name of a setting, or either name of a
+// command, and where names collide that is the order of precedence, as when
+// the lists were searched in turn.  Settings and commands are created at
+// several points during startup, so the table is rebuilt by the first lookup
+// after any of them is created.
+class WordIndex {
+public:
+    enum class Kind : uint8_t {
+        Setting,      // Full name of a setting
+        GrblSetting,  // Grbl name of a setting
+        Command,      // Either name of a command
+    };
+
+    struct Entry {
+        const char* name;
+        Word*       word;
+        Kind        kind;
+    };
+
+    // Returns false if nothing has the name key
+    static bool find(const char* key, Entry& entry);
+
+    // Called when a setting or command is created
+    static void invalidate() { _stale = true; }
+
+    static size_t size() { return _entries.size(); }
+
+private:
+    static std::vector<Entry> _entries;
+    static std::mutex         _mutex;
+    static bool               _stale;
+
+    static void build();
+};
+
 class Command : public Word {
 protected:
     Command* link;  // linked list of setting objects
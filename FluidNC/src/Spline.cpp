@@ -0,0 +1,76 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Spline.h"
+
+#include <cmath>
+
+CubicSpline::CubicSpline(const float* start, const float* first, const float* second, const float* end, float tolerance) :
+    _tolerance(tolerance) {
+    for (int i = 0; i < 2; i++) {
+        _p[0][i] = start[i];
+        _p[1][i] = first[i];
+        _p[2][i] = second[i];
+        _p[3][i] = end[i];
+        _a[i]    = _p[0][i] - 2 * _p[1][i] + _p[2][i];
+        _b[i]    = _p[1][i] - 2 * _p[2][i] + _p[3][i];
+    }
+}
+
+void CubicSpline::fromQuadratic(const float* start, const float* control, const float* end, float* first, float* second) {
+    for (int i = 0; i < 2; i++) {
+        first[i]  = start[i] + 2.0f / 3.0f * (control[i] - start[i]);
+        second[i] = end[i] + 2.0f / 3.0f * (control[i] - end[i]);
+    }
+}
+
+float CubicSpline::bend(float t) const {
+    float x = (1 - t) * _a[0] + t * _b[0];
+    float y = (1 - t) * _a[1] + t * _b[1];
+    return sqrtf(x * x + y * y);
+}
+
+// The step after which the chord error is tolerance, given |B''| / 6:
+// dt^2 / 8 * 6 * bend == tolerance
+float CubicSpline::stepFor(float bend) const {
+    if (bend <= 0.0f) {
+        return 1.0f;
+    }
+    float dt = sqrtf(_tolerance / (0.75f * bend));
+    return dt < minStep ? minStep : dt;
+}
+
+bool CubicSpline::next(float& t, float& x, float& y) {
+    if (_t >= 1.0f) {
+        return false;
+    }
+    float b0 = bend(_t);
+    float dt = stepFor(b0);
+    if (_t + dt < 1.0f) {
+        // The bend may be larger at the far end of the step
+        float b1 = bend(_t + dt);
+        if (b1 > b0) {
+            dt = stepFor(b1);
+        }
+    }
+    _t += dt;
+    if (_t >= 1.0f) {
+        // Finish exactly on the end point
+        _t = 1.0f;
+        t  = 1.0f;
+        x  = _p[3][0];
+        y  = _p[3][1];
+        return true;
+    }
+
+    float s  = 1 - _t;
+    float c0 = s * s * s;
+    float c1 = 3 * s * s * _t;
+    float c2 = 3 * s * _t * _t;
+    float c3 = _t * _t * _t;
+
+    t = _t;
+    x = c0 * _p[0][0] + c1 * _p[1][0] + c2 * _p[2][0] + c3 * _p[3][0];
+    y = c0 * _p[0][1] + c1 * _p[1][1] + c2 * _p[2][1] + c3 * _p[3][1];
+    return true;
+}
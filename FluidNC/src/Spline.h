@@ -0,0 +1,46 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  CubicSpline flattens a cubic Bezier curve in a plane, for G5 and G5.1.
+
+  It steps along the curve parameter t, choosing each step so that the chord
+  to the next point is within a tolerance of the curve.  A chord over a step
+  dt is never farther from the curve than dt^2/8 times the largest |B''| over
+  the step, and for a cubic B'' is linear in t, so that largest value is at
+  one end of the step.  Steps are therefore long where the curve is nearly
+  straight and short where it bends, and the points are produced one at a
+  time, so that mc_spline() plans each segment as it is computed.
+*/
+
+class CubicSpline {
+public:
+    // Points are { x, y } in the plane of the curve
+    CubicSpline(const float* start, const float* first, const float* second, const float* end, float tolerance);
+
+    // Moves to the next point, returning false once the end point has been returned
+    bool next(float& t, float& x, float& y);
+
+    // Goes back to the start, to step along the curve again
+    void restart() { _t = 0.0f; }
+
+    // A quadratic curve, as for G5.1, is the cubic whose control points are
+    // two thirds of the way from each end to the quadratic control point
+    static void fromQuadratic(const float* start, const float* control, const float* end, float* first, float* second);
+
+private:
+    // Never step more finely than this, so that a tiny tolerance cannot
+    // produce millions of segments
+    static constexpr float minStep = 1.0f / 4096;
+
+    float _p[4][2];
+    float _a[2];  // B''(0) / 6
+    float _b[2];  // B''(1) / 6
+    float _tolerance;
+    float _t = 0.0f;
+
+    float bend(float t) const;  // |B''(t)| / 6
+    float stepFor(float bend) const;
+};
@@ -0,0 +1,110 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "StatusReport.h"
+
+#include "Config.h"     // A_AXIS, C_AXIS
+#include "NutsBolts.h"  // MM_PER_INCH
+
+#include <cmath>
+
+static StatusReport pool[StatusReport::poolSize];
+
+StatusReport* StatusReport::claim() {
+    for (auto& report : pool) {
+        bool inUse = false;
+        if (report._inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+            report.clear();
+            return &report;
+        }
+    }
+    return nullptr;
+}
+
+void StatusReport::release() {
+    _inUse.store(false, std::memory_order_release);
+}
+
+void StatusReport::clear() {
+    _length  = 0;
+    _text[0] = '\0';
+}
+
+// Anything beyond maxLength is dropped
+size_t StatusReport::write(uint8_t c) {
+    if (_length == maxLength) {
+        return 0;
+    }
+    _text[_length++] = c;
+    _text[_length]   = '\0';
+    return 1;
+}
+
+size_t StatusReport::write(const uint8_t* buffer, size_t length) {
+    if (length > maxLength - _length) {
+        length = maxLength - _length;
+    }
+    memcpy(_text + _length, buffer, length);
+    _length += length;
+    _text[_length] = '\0';
+    return length;
+}
+
+// Formats with integer arithmetic, which is much faster than Print::print(float)
+// and std::ostringstream.  Values that round to zero are shown without a sign.
+void StatusReport::fixed(float value, int decimals) {
+    static const uint32_t scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    const int             maxDecimals = sizeof(scales) / sizeof(scales[0]) - 1;
+    if (decimals > maxDecimals) {
+        decimals = maxDecimals;
+    }
+
+    double scaled = double(value) * scales[decimals];
+    if (!(fabs(scaled) < 1e18)) {
+        print(value, decimals);  // nan, inf or ovf
+        return;
+    }
+    bool negative = scaled < 0;
+    if (negative) {
+        scaled = -scaled;
+    }
+    // The product is exact, so rounding half to even gives the same digits as printf
+    uint64_t units = uint64_t(nearbyint(scaled));
+
+    // Digits are produced from the right
+    char  digits[24];
+    char* p        = digits + sizeof(digits);
+    auto  whole    = units / scales[decimals];
+    auto  fraction = uint32_t(units % scales[decimals]);
+    for (int i = 0; i < decimals; i++) {
+        *--p = '0' + fraction % 10;
+        fraction /= 10;
+    }
+    if (decimals) {
+        *--p = '.';
+    }
+    do {
+        *--p = '0' + whole % 10;
+        whole /= 10;
+    } while (whole);
+    if (negative && units) {
+        *--p = '-';
+    }
+    write(reinterpret_cast<const uint8_t*>(p), digits + sizeof(digits) - p);
+}
+
+void StatusReport::axes(const float* values, size_t n_axis, bool inches) {
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        if (idx) {
+            write(',');
+        }
+        // Rotary axes are in degrees so mm vs inch is not relevant.  Three decimal
+        // places is probably overkill for rotary axes but we use 3 in case somebody
+        // wants to use ABC as linear axes in mm.
+        if (inches && (idx < A_AXIS || idx > C_AXIS)) {
+            fixed(values[idx] / MM_PER_INCH, 4);
+        } else {
+            fixed(values[idx], 3);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  StatusReport is a Print that builds a realtime status report in a fixed
+  buffer, so that reports can be sent several times a second to every client
+  without using the heap.
+
+  A small pool of reports is shared by the tasks that send them.  A report is
+  claimed, built, and handed to the output task with send_line(), which
+  releases it after it has been sent.
+*/
+
+#include <Print.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+class StatusReport : public Print {
+public:
+    static const size_t maxLength = 400;
+    static const int    poolSize  = 4;
+
+    StatusReport() = default;
+
+    // Returns a cleared report from the pool, or nullptr if all of them
+    // are still waiting for the output task
+    static StatusReport* claim();
+    void                 release();
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
+
+    // A number with a fixed number of decimals, like printf("%.*f")
+    void fixed(float value, int decimals);
+
+    // Comma separated axis values, in the units and precision of status reports
+    void axes(const float* values, size_t n_axis, bool inches);
+
+    const char* c_str() const { return _text; }
+    size_t      length() const { return _length; }
+    void        clear();
+
+private:
+    char   _text[maxLength + 1] = "";
+    size_t _length              = 0;
+
+    std::atomic<bool> _inUse { false };
+};
+
+// A piece of a status report that is only formatted again when the values
+// that it shows change.  Key must have no padding, because it is compared
+// with memcmp().  If two tasks build reports at the same time, the one that
+// finds the cache busy formats the piece itself.
+template <typename Key, size_t Size>
+class CachedReportText {
+public:
+    template <typename Format>
+    void print(StatusReport& report, const Key& key, Format format) {
+        if (_busy.exchange(true, std::memory_order_acquire)) {
+            format(report);
+            return;
+        }
+        if (_length && memcmp(&key, &_key, sizeof(Key)) == 0) {
+            report.write(reinterpret_cast<const uint8_t*>(_text), _length);
+        } else {
+            size_t start = report.length();
+            format(report);
+            size_t length = report.length() - start;
+            if (length <= Size) {
+                memcpy(_text, report.c_str() + start, length);
+                memcpy(&_key, &key, sizeof(Key));
+                _length = length;
+            } else {
+                _length = 0;
+            }
+        }
+        _busy.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> _busy { false };
+    Key               _key;
+    char              _text[Size];
+    size_t            _length = 0;
+};
@@ -15,6 +15,7 @@
 #include "StepperPrivate.h"
 #include "Planner.h"
 #include "Protocol.h"
+#include "SCurve.h"
 #include <esp_attr.h>  // IRAM_ATTR
 #include <cmath>
 
@@ -33,6 +34,7 @@ struct st_block_t {
     uint32_t step_event_count;
     uint8_t  direction_bits;
     bool     is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
+    float    unit_vec[MAX_N_AXIS];  // Motor travel in mm per mm of the block, for get_exec_motion()
 };
 static volatile st_block_t* st_block_buffer = nullptr;
 
@@ -47,6 +49,8 @@ struct segment_t {
     uint8_t      amass_level;        // AMASS level for the ISR to execute this segment
     uint32_t     spindle_dev_speed;  // Spindle speed scaled to the device
     SpindleSpeed spindle_speed;      // Spindle speed in GCode units
+    float        speed;              // Average speed over the segment (mm/min)
+    float        acceleration;       // Rate of change of speed over the segment (mm/min^2)
 };
 static segment_t* segment_buffer = nullptr;
 
@@ -90,6 +94,18 @@ static uint32_t          segment_next_head;
 static plan_block_t*        pl_block;       // Pointer to the planner block being prepped
 static volatile st_block_t* st_prep_block;  // Pointer to the stepper block data being prepped
 
+// A jerk-limited velocity profile from the end of the segment buffer to the next junction that the planner
+// anchors at zero acceleration, which may be several blocks ahead: a ramp, a hold and a ramp, with a ramp
+// before them to ease off a deceleration still under way. The pieces run one after the other in time,
+// across block junctions.
+typedef struct {
+    SCurveRamp piece[4];
+    uint8_t    pieces;
+    uint8_t    current;  // Index of the piece in progress
+    float      elapsed;  // Time into it (min)
+    float      top;      // Highest speed of the profile (mm/min)
+} scurve_profile_t;
+
 // Segment preparation data struct. Contains all the necessary information to compute new segments
 // based on the current executing planner block.
 typedef struct {
@@ -115,6 +131,13 @@ typedef struct {
     float accelerate_until;  // Acceleration ramp end measured from end of block (mm)
     float decelerate_after;  // Deceleration ramp start measured from end of block (mm)
 
+    float            current_accel;  // Acceleration at the end of the segment buffer, negative when slowing (mm/min^2)
+    bool             s_curve;        // Jerk-limited block, following the profile
+    bool             linear;         // No jerk-limited profile fits the block, so its ramps are linear
+    bool             profiled;       // The profile is valid
+    uint32_t         plan_revision;  // Of the plan that the profile was made from
+    scurve_profile_t profile;
+
     float        inv_rate;  // Used by PWM laser mode to speed up segment calculations.
     SpindleSpeed current_spindle_speed;
 
@@ -374,6 +397,222 @@ static uint8_t next_block_index(uint8_t block_index) {
     return block_index == (config->_stepping->_segments - 1) ? 0 : block_index;
 }
 
+// Lets a profile run this much past its planned distance, for float rounding
+static const float scurve_slack = 1.0001f;
+
+static void scurve_add(scurve_profile_t* profile, const SCurveRamp& ramp) {
+    if (ramp.duration() > 0.0f) {
+        profile->piece[profile->pieces++] = ramp;
+    }
+}
+
+// Adds a rise from speed at accel_now to the highest speed, up to cap, that leaves room to fall to end_speed
+// within mm, a hold there, and the fall.
+static bool scurve_climb(scurve_profile_t* profile, float speed, float accel_now, float end_speed, float mm, float cap, float accel, float jerk) {
+    SCurveRamp rise, fall, hold;
+    auto       length = [&](float top) {
+        rise.fastest(speed, top, accel_now, accel, jerk);
+        return rise.length() + SCurveRamp::rampDistance(top, MIN(end_speed, top), accel, jerk);
+    };
+
+    float lowest = speed + accel_now * accel_now / (2.0f * jerk);  // Where the acceleration under way eases off
+    if (lowest > cap || length(lowest) > mm * scurve_slack) {
+        return false;
+    }
+    float top = cap;
+    if (length(cap) > mm) {
+        float lo = lowest;
+        float hi = cap;
+        for (int i = 0; i < 24; i++) {
+            float mid = (lo + hi) / 2.0f;
+            if (length(mid) > mm) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        top = lo;
+    }
+    rise.fastest(speed, top, accel_now, accel, jerk);
+    fall.fastest(top, MIN(end_speed, top), 0.0f, accel, jerk);
+    hold.plan(top, top, MAX(mm - rise.length() - fall.length(), 0.0f), 0.0f, 0.0f, accel, jerk);
+    scurve_add(profile, rise);
+    scurve_add(profile, hold);
+    scurve_add(profile, fall);
+    profile->top = MAX(profile->top, top);
+    return true;
+}
+
+// Falls from speed at accel_now to end_speed within mm, for when there is no room to level off at end_speed, as a
+// plan changed under the profile can ask. The fall arrives with as little deceleration as fits, and carries that on
+// past the junction, where the next profile eases it off.
+static bool scurve_overrun(scurve_profile_t* profile, float speed, float accel_now, float end_speed, float mm, float cap, float accel, float jerk) {
+    if (speed > cap) {
+        return false;
+    }
+    profile->top = speed;
+    if (accel_now > 0.0f) {
+        // Level off first
+        SCurveRamp rise;
+        float      top = speed + accel_now * accel_now / (2.0f * jerk);
+        if (top > cap || !rise.fastest(speed, top, accel_now, accel, jerk) || rise.length() >= mm) {
+            return false;
+        }
+        scurve_add(profile, rise);
+        profile->top = speed = top;
+        mm -= rise.length();
+        accel_now = 0.0f;
+    }
+    if (end_speed >= speed) {
+        return false;
+    }
+    SCurveRamp fall;
+    if (!fall.plan(speed, end_speed, mm, -accel_now, 0.0f, accel, jerk)) {
+        // Any more deceleration at the end would carry on down past a stop
+        float lo = 0.0f;
+        float hi = MIN(accel, sqrtf(2.0f * jerk * end_speed));
+        if (!fall.plan(speed, end_speed, mm, -accel_now, hi, accel, jerk)) {
+            return false;
+        }
+        for (int i = 0; i < 24; i++) {
+            float mid = (lo + hi) / 2.0f;
+            if (fall.plan(speed, end_speed, mm, -accel_now, mid, accel, jerk)) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        fall.plan(speed, end_speed, mm, -accel_now, hi, accel, jerk);
+    }
+    scurve_add(profile, fall);
+    return true;
+}
+
+// Plans a profile from the current speed and acceleration, mm before the end of the executing block, to the
+// next anchored junction, or to a stop at the end of the buffer. Leaves the profile alone and returns false if
+// none fits within the limits of the blocks it covers, the lowest of whose speed limits is returned in cap.
+static bool scurve_profile(float mm, float* cap) {
+    float end_speed = 0.0f;
+    float accel     = pl_block->max_acceleration;
+    float jerk      = pl_block->jerk;
+    *cap            = plan_compute_profile_nominal_speed(pl_block);
+    if (!sys.step_control.executeSysMotion) {
+        for (plan_index_t ahead = 1;; ahead++) {
+            plan_block_t* block = plan_get_exec_block_ahead(ahead);
+            if (block == NULL) {
+                break;
+            }
+            if (block->anchor || block->jerk <= 0.0f) {
+                end_speed = sqrtf(block->entry_speed_sqr);
+                break;
+            }
+            mm += block->millimeters;
+            *cap  = MIN(*cap, plan_compute_profile_nominal_speed(block));
+            accel = MIN(accel, block->max_acceleration);
+            jerk  = MIN(jerk, block->jerk);
+        }
+    }
+
+    scurve_profile_t profile = {};
+    float            speed   = prep.current_speed;
+    float            a       = prep.current_accel;
+    bool             planned;
+    if (a >= 0.0f) {
+        planned = scurve_climb(&profile, speed, a, end_speed, mm, *cap, accel, jerk);
+    } else {
+        // Ease off the deceleration under way and plan on from there
+        SCurveRamp ease;
+        float      eased = speed - a * a / (2.0f * jerk);
+        planned          = eased > 0.0f && ease.fastest(speed, eased, -a, accel, jerk) && ease.length() < mm;
+        if (planned) {
+            scurve_add(&profile, ease);
+            profile.top = speed;
+            planned     = scurve_climb(&profile, eased, 0.0f, end_speed, mm - ease.length(), *cap, accel, jerk);
+        }
+    }
+    if (!planned) {
+        profile = {};
+        planned = scurve_overrun(&profile, speed, a, end_speed, mm, *cap, accel, jerk);
+    }
+    if (planned) {
+        prep.profile = profile;
+    }
+    return planned;
+}
+
+// Replans the profile for a changed plan. If no new profile fits, the old one stays as long as it keeps
+// within the speed limits of the new plan. Returns false if neither will do.
+static bool scurve_replan(float mm) {
+    float cap;
+    prep.plan_revision = plan_get_revision();
+    if (scurve_profile(mm, &cap)) {
+        prep.profiled = true;
+        return true;
+    }
+    return prep.profiled && prep.profile.current < prep.profile.pieces && prep.profile.top <= cap;
+}
+
+// Follows the profile for up to time_var, or until mm_remaining reaches the end of the block, and returns the
+// time taken.
+static float scurve_advance(float time_var, float* mm_remaining) {
+    float taken = 0.0f;
+    while (taken < time_var && *mm_remaining > 0.0f) {
+        if (prep.profile.current >= prep.profile.pieces) {
+            // At the junction the profile was planned to. If that is the end of the block, give or take a
+            // fraction of a step, the next block plans on from there.
+            if (*mm_remaining * prep.step_per_mm < 0.5f) {
+                *mm_remaining = 0.0f;
+                break;
+            }
+            // Otherwise plan on from here. Should that fail, which rounding alone can cause, hold the speed
+            // to the end of the block.
+            float cap;
+            if (!scurve_profile(*mm_remaining, &cap) || prep.profile.pieces == 0) {
+                if (prep.current_speed <= 0.0f) {
+                    *mm_remaining = 0.0f;
+                    break;
+                }
+                prep.profile        = {};
+                prep.profile.pieces = 1;
+                prep.profile.top    = prep.current_speed;
+                prep.profile.piece[0].plan(
+                    prep.current_speed, prep.current_speed, *mm_remaining, 0.0f, 0.0f, pl_block->max_acceleration, pl_block->jerk);
+            }
+        }
+        SCurveRamp& piece = prep.profile.piece[prep.profile.current];
+        float       start = prep.profile.elapsed;
+        float       stop  = MIN(start + time_var - taken, piece.duration());
+        if (stop <= start && stop < piece.duration()) {
+            return time_var;  // Too little time left to move at all
+        }
+        float mm = piece.distance(stop) - piece.distance(start);
+        if (mm >= *mm_remaining) {
+            // The block ends within this piece. Find when.
+            float lo = start;
+            for (int i = 0; i < 24; i++) {
+                float mid = (lo + stop) / 2.0f;
+                if (piece.distance(mid) - piece.distance(start) < *mm_remaining) {
+                    lo = mid;
+                } else {
+                    stop = mid;
+                }
+            }
+            mm = *mm_remaining;
+        }
+        *mm_remaining -= mm;
+        taken += stop - start;
+        prep.current_speed = piece.speed(stop);
+        prep.current_accel = piece.acceleration(stop);
+        if (stop >= piece.duration()) {
+            prep.profile.current++;
+            prep.profile.elapsed = 0.0f;
+        } else {
+            prep.profile.elapsed = stop;
+        }
+    }
+    return taken;
+}
+
 /* Prepares step segment buffer. Continuously called from main program.
 
    The segment buffer is an intermediary buffer interface between the execution of steps
@@ -430,6 +669,9 @@ void Stepper::prep_buffer() {
                 // If the original data is divided, we can lose a step from integer roundoff.
                 for (idx = 0; idx < n_axis; idx++) {
                     st_prep_block->steps[idx] = pl_block->steps[idx] << maxAmassLevel;
+
+                    float mm                     = steps_to_mpos(pl_block->steps[idx], idx) / pl_block->millimeters;
+                    st_prep_block->unit_vec[idx] = bitnum_is_true(pl_block->direction_bits, idx) ? -mm : mm;
                 }
                 st_prep_block->step_event_count = pl_block->step_event_count << maxAmassLevel;
 
@@ -443,9 +685,13 @@ void Stepper::prep_buffer() {
                     prep.current_speed                  = prep.exit_speed;
                     pl_block->entry_speed_sqr           = prep.exit_speed * prep.exit_speed;
                     prep.recalculate_flag.decelOverride = 0;
+                } else if (pl_block->jerk > 0.0f && prep.profiled && !sys.step_control.executeSysMotion) {
+                    // The jerk-limited profile runs on through the junction, at whatever speed it has there
+                    pl_block->entry_speed_sqr = prep.current_speed * prep.current_speed;
                 } else {
                     prep.current_speed = sqrtf(pl_block->entry_speed_sqr);
                 }
+                prep.linear = false;
 
                 // prep.inv_rate is only used if is_pwm_rate_adjusted is true
                 st_prep_block->is_pwm_rate_adjusted = false;  // set default value
@@ -543,15 +789,41 @@ void Stepper::prep_buffer() {
                 }
             }
 
+            // Forced decelerations, for a feed hold or a reduced override, stay linear, as do blocks that
+            // no jerk-limited profile fits. The others follow the profile, planned anew if the plan changed.
+            prep.s_curve = pl_block->jerk > 0 && !sys.step_control.executeHold && prep.ramp_type != RAMP_DECEL_OVERRIDE &&
+                           !prep.recalculate_flag.decelOverride && !prep.linear;
+            if (prep.s_curve) {
+                if ((prep.profiled && prep.plan_revision == plan_get_revision()) || scurve_replan(pl_block->millimeters)) {
+                    prep.ramp_type = RAMP_SCURVE;
+                } else {
+                    prep.s_curve = false;
+                    prep.linear  = true;
+                }
+            }
+            if (!prep.s_curve) {
+                prep.profiled = false;
+            }
+
             sys.step_control.updateSpindleSpeed = true;  // Force update whenever updating block.
         }
 
+        // A plan changed under the profile is replanned from where the segment buffer ends. If nothing fits,
+        // reload the block with linear ramps.
+        if (prep.s_curve && prep.plan_revision != plan_get_revision() && !scurve_replan(pl_block->millimeters)) {
+            prep.linear = true;
+            update_plan_block_parameters();
+            continue;
+        }
+
         // Initialize new segment
         volatile segment_t* prep_segment = &segment_buffer[segment_buffer_head];
 
         // Set new segment to point to the current segment data block.
         prep_segment->st_block_index = prep.st_block_index;
 
+        float segment_start_speed = prep.current_speed;
+
         /*------------------------------------------------------------------------------------
             Compute the average velocity of this new segment by determining the total distance
           traveled over the segment time DT_SEGMENT. The following code first attempts to create
@@ -590,8 +862,10 @@ void Stepper::prep_buffer() {
                         time_var           = 2.0f * (pl_block->millimeters - mm_remaining) / (prep.current_speed + prep.maximum_speed);
                         prep.ramp_type     = RAMP_CRUISE;
                         prep.current_speed = prep.maximum_speed;
+                        prep.current_accel = 0.0f;
                     } else {  // Mid-deceleration override ramp.
                         prep.current_speed -= speed_var;
+                        prep.current_accel = -pl_block->acceleration;
                     }
                     break;
                 case RAMP_ACCEL:
@@ -605,18 +879,21 @@ void Stepper::prep_buffer() {
                         if (mm_remaining == prep.decelerate_after) {
                             prep.ramp_type = RAMP_DECEL;
                         } else {
-                            prep.ramp_type = RAMP_CRUISE;
+                            prep.ramp_type     = RAMP_CRUISE;
+                            prep.current_accel = 0.0f;
                         }
                         prep.current_speed = prep.maximum_speed;
                     } else {  // Acceleration only.
                         prep.current_speed += speed_var;
+                        prep.current_accel = pl_block->acceleration;
                     }
                     break;
                 case RAMP_CRUISE:
                     // NOTE: mm_var used to retain the last mm_remaining for incomplete segment time_var calculations.
                     // NOTE: If maximum_speed*time_var value is too low, round-off can cause mm_var to not change. To
                     //   prevent this, simply enforce a minimum speed threshold in the planner.
-                    mm_var = mm_remaining - prep.maximum_speed * time_var;
+                    mm_var             = mm_remaining - prep.maximum_speed * time_var;
+                    prep.current_accel = 0.0f;
                     if (mm_var < prep.decelerate_after) {  // End of cruise.
                         // Cruise-deceleration junction or end of block.
                         time_var       = (mm_remaining - prep.decelerate_after) / prep.maximum_speed;
@@ -626,6 +903,9 @@ void Stepper::prep_buffer() {
                         mm_remaining = mm_var;
                     }
                     break;
+                case RAMP_SCURVE:
+                    time_var = scurve_advance(time_var, &mm_remaining);
+                    break;
                 default:  // case RAMP_DECEL:
                     // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
                     speed_var = pl_block->acceleration * time_var;  // Used as delta speed (mm/min)
@@ -635,6 +915,7 @@ void Stepper::prep_buffer() {
                         if (mm_var > prep.mm_complete) {                                             // Typical case. In deceleration ramp.
                             mm_remaining = mm_var;
                             prep.current_speed -= speed_var;
+                            prep.current_accel = -pl_block->acceleration;
                             break;  // Segment complete. Exit switch-case statement. Continue do-while loop.
                         }
                     }
@@ -642,6 +923,7 @@ void Stepper::prep_buffer() {
                     time_var           = 2.0f * (mm_remaining - prep.mm_complete) / (prep.current_speed + prep.exit_speed);
                     mm_remaining       = prep.mm_complete;
                     prep.current_speed = prep.exit_speed;
+                    prep.current_accel = prep.exit_speed > 0.0f ? -pl_block->acceleration : 0.0f;
             }
 
             dt += time_var;  // Add computed ramp time to total segment time.
@@ -684,6 +966,14 @@ void Stepper::prep_buffer() {
         prep_segment->spindle_speed     = prep.current_spindle_speed;
         prep_segment->spindle_dev_speed = spindle->mapSpeed(prep.current_spindle_speed);  // Reload segment PWM value
 
+        if (dt > 0.0f) {
+            prep_segment->speed        = (pl_block->millimeters - mm_remaining) / dt;
+            prep_segment->acceleration = (prep.current_speed - segment_start_speed) / dt;
+        } else {
+            prep_segment->speed        = prep.current_speed;
+            prep_segment->acceleration = 0.0f;
+        }
+
         /* -----------------------------------------------------------------------------------
            Compute segment step rate, steps to execute, and apply necessary rate corrections.
            NOTE: Steps are computed by direct scalar conversion of the millimeter distance
@@ -778,6 +1068,27 @@ void Stepper::prep_buffer() {
     }
 }
 
+bool Stepper::get_exec_motion(float* unit_vec, float& speed, float& acceleration) {
+    // The ISR may retire the segment at any time, so work from a copy of the pointer. Between
+    // segments, the next one in the buffer is about to start.
+    volatile segment_t* segment = st.exec_segment;
+    if (segment == NULL) {
+        if (!awake || segment_buffer_head == segment_buffer_tail) {
+            return false;
+        }
+        segment = &segment_buffer[segment_buffer_tail];
+    }
+    volatile st_block_t* block = &st_block_buffer[segment->st_block_index];
+
+    auto n_axis = config->_axes->_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        unit_vec[axis] = block->unit_vec[axis];
+    }
+    speed        = segment->speed;
+    acceleration = segment->acceleration;
+    return true;
+}
+
 // Called by realtime status reporting to fetch the current speed being executed. This value
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
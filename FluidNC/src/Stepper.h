@@ -45,5 +45,9 @@ namespace Stepper {
     // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
     float get_realtime_rate();
 
+    // Motion of the segment being executed, for feed-forward control: the motor travel per mm along the
+    // path, the average speed in mm/min and its rate of change in mm/min^2. Returns false if not moving.
+    bool get_exec_motion(float* unit_vec, float& speed, float& acceleration);
+
     extern uint32_t isr_count;
 }
@@ -10,6 +10,7 @@ const int   RAMP_ACCEL              = 0;
 const int   RAMP_CRUISE             = 1;
 const int   RAMP_DECEL              = 2;
 const int   RAMP_DECEL_OVERRIDE     = 3;
+const int   RAMP_SCURVE             = 4;  // Following the jerk-limited profile, which may span several blocks
 
 struct PrepFlag {
     uint8_t recalculate : 1;
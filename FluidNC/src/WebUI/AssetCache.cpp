@@ -0,0 +1,115 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "AssetCache.h"
+
+#ifdef ENABLE_WIFI
+
+#    include "../HashFS.h"
+#    include "../FileStream.h"
+
+#    include <algorithm>
+#    include <cstdlib>
+
+#    ifdef ESP32
+#        include <sdkconfig.h>  // CONFIG_IDF_TARGET_*
+#        include <esp_heap_caps.h>
+#    endif
+
+namespace WebUI {
+    std::vector<AssetCache::Asset> AssetCache::_assets;
+    size_t                         AssetCache::_used = 0;
+
+    // The whole WebUI, whose index.html.gz alone is well over 100 KB, fits
+    // easily in PSRAM.  Internal RAM cannot spare that much, and a budget it
+    // could spare would never hold index.html.gz, so without PSRAM there is
+    // no cache at all.
+    static const size_t psramBudget = 1024 * 1024;
+
+    size_t AssetCache::budget() {
+        static size_t bytes = 0;
+#    ifdef CONFIG_IDF_TARGET_ESP32S3
+        if (!bytes) {
+            bytes = std::min(psramBudget, heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 2);
+        }
+#    endif
+        return bytes;
+    }
+
+    uint8_t* AssetCache::allocate(size_t size) {
+        void* data = nullptr;
+#    ifdef CONFIG_IDF_TARGET_ESP32S3
+        data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#    endif
+        return static_cast<uint8_t*>(data);
+    }
+
+    void AssetCache::drop(const std::string& name) {
+        for (auto it = _assets.begin(); it != _assets.end(); ++it) {
+            if (it->name == name) {
+                _used -= it->size;
+                free(it->data);
+                _assets.erase(it);
+                return;
+            }
+        }
+    }
+
+    void AssetCache::clear() {
+        for (auto& asset : _assets) {
+            free(asset.data);
+        }
+        _assets.clear();
+        _used = 0;
+    }
+
+    void AssetCache::load() {
+        clear();
+        if (!budget()) {
+            log_info("No PSRAM, so WebUI files are not cached and cannot be served during motion");
+            return;
+        }
+        for (const auto& [name, hash] : HashFS::localFsHashes) {
+            if (name.length() > 3 && name.compare(name.length() - 3, 3, ".gz") == 0) {
+                refresh(name, hash);
+            }
+        }
+        log_debug("Cached " << _assets.size() << " WebUI files in " << _used << " bytes");
+    }
+
+    const AssetCache::Asset* AssetCache::find(const std::string& name, const std::string& hash) {
+        for (const auto& asset : _assets) {
+            if (asset.name == name) {
+                return asset.hash == hash ? &asset : nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    const AssetCache::Asset* AssetCache::refresh(const std::string& name, const std::string& hash) {
+        drop(name);
+        if (!budget()) {
+            return nullptr;
+        }
+        try {
+            FileStream file(std::string("/localfs") + name, "r");
+            size_t     size = file.size();
+            if (size == 0 || _used + size > budget()) {
+                return nullptr;
+            }
+            uint8_t* data = allocate(size);
+            if (!data) {
+                return nullptr;
+            }
+            if (file.read(data, size) != size) {
+                free(data);
+                return nullptr;
+            }
+            _used += size;
+            _assets.push_back({ name, hash, data, size });
+            return &_assets.back();
+        } catch (const Error err) { return nullptr; }
+    }
+}
+
+#endif
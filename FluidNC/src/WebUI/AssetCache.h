@@ -0,0 +1,56 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Config.h"  // ENABLE_*
+
+#ifdef ENABLE_WIFI
+
+#    include <cstddef>
+#    include <cstdint>
+#    include <string>
+#    include <vector>
+
+namespace WebUI {
+    // AssetCache keeps the gzipped WebUI files from localfs in PSRAM, so that
+    // they can be served without reading flash.
+    // Reading flash is what makes serving files during motion risky, so a
+    // cached asset can be sent while a job runs.  Each asset is stored with
+    // the HashFS hash it had when it was read, and is only used while that is
+    // still the file's hash, so a new upload is never shadowed by an old copy.
+    // Boards without PSRAM have no cache, because internal RAM cannot hold the
+    // WebUI, and their files are blocked during motion as before.
+    class AssetCache {
+    public:
+        struct Asset {
+            std::string name;  // Like /index.html.gz
+            std::string hash;
+            uint8_t*    data;
+            size_t      size;
+        };
+
+        // Reads every .gz file in localfs that fits in what remains of the budget,
+        // which is zero without PSRAM
+        static void load();
+
+        // Returns the asset if it is cached with this hash, else null
+        static const Asset* find(const std::string& name, const std::string& hash);
+
+        // Reads the file again, replacing any copy with another hash.  Returns
+        // the new asset, or null if it does not fit or cannot be read.
+        static const Asset* refresh(const std::string& name, const std::string& hash);
+
+        static void clear();
+
+    private:
+        static std::vector<Asset> _assets;
+        static size_t             _used;
+
+        static size_t   budget();
+        static uint8_t* allocate(size_t size);
+        static void     drop(const std::string& name);
+    };
+}
+
+#endif
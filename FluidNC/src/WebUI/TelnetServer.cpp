@@ -1,6 +1,5 @@
 // Copyright (c) 2014 Luc Lebosse. All rights reserved.
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
-#include <ESPmDNS.h>
 #include "../Machine/MachineConfig.h"
 #include "TelnetClient.h"
 #include "TelnetServer.h"
@@ -19,6 +18,7 @@ namespace WebUI {
 #    include "Commands.h"   // COMMANDS
 
 #    include <WiFi.h>
+#    include <ESPmDNS.h>
 
 namespace WebUI {
 
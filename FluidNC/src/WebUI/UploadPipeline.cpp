@@ -0,0 +1,195 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "UploadPipeline.h"
+
+#ifdef ENABLE_WIFI
+
+#    include <algorithm>
+#    include <cstring>
+
+namespace WebUI {
+    UploadPipeline::Buffer*  UploadPipeline::_pool    = nullptr;
+    UploadPipeline::Buffer*  UploadPipeline::_filling = nullptr;
+    QueueHandle_t            UploadPipeline::_free    = nullptr;
+    QueueHandle_t            UploadPipeline::_full    = nullptr;
+    QueueHandle_t            UploadPipeline::_done    = nullptr;
+    TaskHandle_t             UploadPipeline::_task    = nullptr;
+    FileStream*              UploadPipeline::_file    = nullptr;
+    HashFS::Hasher           UploadPipeline::_hasher;
+    std::atomic<bool>        UploadPipeline::_failed(false);
+    std::string              UploadPipeline::_name;
+    size_t                   UploadPipeline::_bytes      = 0;
+    uint32_t                 UploadPipeline::_startTime  = 0;
+    uint32_t                 UploadPipeline::_reportTime = 0;
+
+    // How often progress is logged during a long upload
+    static const uint32_t reportInterval = 5000;
+
+    // If the writer has not freed a buffer in this long, the medium has stalled
+    static const TickType_t stallTimeout = 10000 / portTICK_RATE_MS;
+
+    // After a failure the writer only skips buffers, unless it is stuck in a write
+    static const TickType_t failedTimeout = 100 / portTICK_RATE_MS;
+
+    bool UploadPipeline::ready() {
+        if (_file) {
+            // The writer stalled on the last upload and still has its file.  It has
+            // caught up once it answers that upload's end marker.
+            bool done;
+            if (!xQueueReceive(_done, &done, 0)) {
+                log_info("Upload writer is still busy with " << _name);
+                return false;
+            }
+            close();
+        }
+        return true;
+    }
+
+    void UploadPipeline::begin(FileStream* file, const char* name) {
+        if (!_task) {
+            _pool = new Buffer[poolSize];
+            _free = xQueueCreate(poolSize, sizeof(Buffer*));
+            _full = xQueueCreate(poolSize + 1, sizeof(Buffer*));  // Room for the end marker
+            _done = xQueueCreate(1, sizeof(bool));
+            for (int i = 0; i < poolSize; i++) {
+                Buffer* buffer = &_pool[i];
+                xQueueSend(_free, &buffer, 0);
+            }
+            xTaskCreatePinnedToCore(writerLoop,        // task
+                                    "uploadWriter",    // name for task
+                                    4096,              // size of task stack
+                                    0,                 // parameters
+                                    1,                 // priority
+                                    &_task,            // task handle
+                                    SUPPORT_TASK_CORE  // core
+            );
+        }
+        _file    = file;
+        _name    = name;
+        _filling = nullptr;
+        _failed  = false;
+        _bytes   = 0;
+        _hasher.start();
+        _startTime = _reportTime = millis();
+    }
+
+    // Runs in the writer task.  This is the only place that writes the file.
+    // A null buffer marks the end of the upload.
+    void UploadPipeline::writerLoop(void* unused) {
+        Buffer* buffer;
+        while (true) {
+            if (!xQueueReceive(_full, &buffer, portMAX_DELAY)) {
+                continue;
+            }
+            if (!buffer) {
+                bool done = true;
+                xQueueSend(_done, &done, portMAX_DELAY);
+                continue;
+            }
+            if (!_failed) {
+                _hasher.update(buffer->data, buffer->length);
+                if (_file->write(buffer->data, buffer->length) != buffer->length) {
+                    _failed = true;
+                }
+            }
+            xQueueSend(_free, &buffer, portMAX_DELAY);
+        }
+    }
+
+    // _full has room for the whole pool and the end marker, so this only times
+    // out if the queues are broken
+    bool UploadPipeline::hand(Buffer* buffer) {
+        if (xQueueSend(_full, &buffer, stallTimeout)) {
+            return true;
+        }
+        if (buffer) {
+            xQueueSend(_free, &buffer, 0);
+        }
+        _failed = true;
+        return false;
+    }
+
+    bool UploadPipeline::write(const uint8_t* data, size_t length) {
+        while (length && !_failed) {
+            if (!_filling) {
+                if (!xQueueReceive(_free, &_filling, stallTimeout)) {
+                    log_info("Upload writer stalled");
+                    _failed = true;
+                    break;
+                }
+                _filling->length = 0;
+            }
+            size_t count = std::min(length, bufferSize - _filling->length);
+            memcpy(_filling->data + _filling->length, data, count);
+            _filling->length += count;
+            data += count;
+            length -= count;
+            _bytes += count;
+            if (_filling->length == bufferSize) {
+                hand(_filling);
+                _filling = nullptr;
+            }
+        }
+        if (millis() - _reportTime >= reportInterval) {
+            _reportTime = millis();
+            report("Uploading");
+        }
+        return !_failed;
+    }
+
+    // Hands over what remains and waits for the writer to reach the end marker.
+    // Returns false if the writer stalled, in which case it still has the file.
+    bool UploadPipeline::finish() {
+        if (_filling) {
+            if (_filling->length) {
+                hand(_filling);
+            } else {
+                xQueueSend(_free, &_filling, 0);
+            }
+            _filling = nullptr;
+        }
+        bool done;
+        if (hand(nullptr) && xQueueReceive(_done, &done, _failed ? failedTimeout : stallTimeout)) {
+            return true;
+        }
+        // The writer skips what is left once _failed is set, so it catches up as
+        // soon as the write it is stuck in returns
+        log_info("Upload writer stalled");
+        _failed = true;
+        return false;
+    }
+
+    void UploadPipeline::close() {
+        delete _file;
+        _file = nullptr;
+    }
+
+    bool UploadPipeline::end(std::string& hash) {
+        if (!finish()) {
+            return false;
+        }
+        hash = _hasher.finish();
+        report("Uploaded");
+        close();
+        return !_failed;
+    }
+
+    void UploadPipeline::abort() {
+        _failed = true;
+        if (finish()) {
+            _hasher.finish();
+            close();
+        }
+    }
+
+    void UploadPipeline::report(const char* what) {
+        uint32_t ms = millis() - _startTime;
+        if (!ms) {
+            ms = 1;
+        }
+        log_info(what << " " << _name << " " << _bytes << " bytes in " << ms << " ms, " << (_bytes / ms) << " kB/s");
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 -  Maslow CNC
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Config.h"  // ENABLE_*
+
+#ifdef ENABLE_WIFI
+
+#    include "../FileStream.h"
+#    include "../HashFS.h"
+
+#    include <atomic>
+#    include <freertos/FreeRTOS.h>
+#    include <freertos/queue.h>
+
+namespace WebUI {
+    // UploadPipeline writes an HTTP upload to its file from a task of its own,
+    // so that the web server can go back to the network while flash or the SD
+    // card is busy.  Incoming data is packed into a small pool of buffers and
+    // each full buffer is passed to the writer by pointer.  The writer hashes
+    // each buffer before writing it, so the SHA-256 of the file is known at
+    // the end without reading it back.  When the pool is empty, write() waits
+    // for the writer, which holds the sender back to the speed of the medium.
+    //
+    // No wait is unbounded.  If the writer stalls, the upload fails without
+    // waiting for it, and the writer keeps the file until it catches up;
+    // ready() checks for that when the next upload starts.
+    class UploadPipeline {
+    public:
+        static const size_t bufferSize = 4096;
+        static const int    poolSize   = 4;
+
+        // Returns false while the writer is still stuck in a write of an
+        // earlier upload.  Call it before opening the file for a new one.
+        static bool ready();
+
+        // Starts an upload into file, which the pipeline then owns and deletes
+        // once the writer is done with it.  Call it only after ready().
+        static void begin(FileStream* file, const char* name);
+
+        // Returns false once any write has failed
+        static bool write(const uint8_t* data, size_t length);
+
+        // Writes what remains, waits for the writer and closes the file.
+        // Returns false if any write failed or the writer stalled; hash is the
+        // quoted hex SHA-256 of the data.
+        static bool end(std::string& hash);
+
+        // Discards anything not yet written and closes the file
+        static void abort();
+
+    private:
+        struct Buffer {
+            uint8_t data[bufferSize];
+            size_t  length;
+        };
+
+        static Buffer*           _pool;
+        static Buffer*           _filling;
+        static QueueHandle_t     _free;
+        static QueueHandle_t     _full;
+        static QueueHandle_t     _done;
+        static TaskHandle_t      _task;
+        static FileStream*       _file;
+        static HashFS::Hasher    _hasher;
+        static std::atomic<bool> _failed;
+        static std::string       _name;
+        static size_t            _bytes;
+        static uint32_t          _startTime;
+        static uint32_t          _reportTime;
+
+        static void writerLoop(void* unused);
+        static bool hand(Buffer* buffer);
+        static bool finish();
+        static void close();
+        static void report(const char* what);
+    };
+}
+
+#endif
@@ -7,8 +7,10 @@
 #    include "WebServer.h"
 #    include <WebSocketsServer.h>
 #    include <WiFi.h>
+#    include <algorithm>
 
 #    include "../Serial.h"  // is_realtime_command
+#    include "../Report.h"  // report_binary_sample
 
 namespace WebUI {
     class WSChannels;
@@ -88,16 +90,25 @@ namespace WebUI {
         }
         return true;
     }
+    bool WSChannel::sendBIN(uint8_t* data, size_t length) {
+        bool sent;
+        {
+            std::lock_guard<std::mutex> lock(_sendMutex);
+            sent = _server->sendBIN(_clientNum, data, length);
+        }
+        if (!sent) {
+            _dead = true;
+            log_debug("WebSocket is unresponsive; closing");
+            WSChannels::removeChannel(this);
+        }
+        return sent;
+    }
     void WSChannel::flush(void) {
         if (_TXbufferSize > 0) {
             if (_dead) {
                 return;
             }
-            if (!_server->sendBIN(_clientNum, _TXbuffer, _TXbufferSize)) {
-                _dead = true;
-                log_debug("WebSocket is unresponsive; closing");
-                WSChannels::removeChannel(this);
-            }
+            sendBIN(_TXbuffer, _TXbufferSize);
 
             //refresh timout
             _lastflush = millis();
@@ -107,6 +118,30 @@ namespace WebUI {
         }
     }
 
+    uint32_t WSChannel::setBinaryReportInterval(uint32_t ms) {
+        if (ms) {
+            ms = std::max(ms, uint32_t(20));
+        }
+        _binaryInterval = ms;
+        _nextBinaryTime = int32_t(xTaskGetTickCount());
+        _binaryReport.restart();  // The client needs a keyframe to start from
+        return ms;
+    }
+
+    // Binary reports go out at the rate the client asked for, whatever the
+    // machine is doing, so the time field also serves as a heartbeat
+    void WSChannel::autoReportBinary() {
+        if (!_binaryInterval || _dead || (int32_t(xTaskGetTickCount()) - _nextBinaryTime) < 0) {
+            return;
+        }
+        _nextBinaryTime = int32_t(xTaskGetTickCount()) + _binaryInterval;
+
+        BinaryReport::Sample sample = {};
+        uint8_t              frame[BinaryReport::maxLength];
+        report_binary_sample(sample, *this);
+        sendBIN(frame, _binaryReport.encode(sample, frame));
+    }
+
     WSChannel::~WSChannel() {}
 
     std::map<uint8_t, WSChannel*> WSChannels::_wsChannels;
@@ -26,6 +26,9 @@ namespace WebUI {
 #else
 
 #    include "../Channel.h"
+#    include "../BinaryReport.h"
+
+#    include <mutex>
 
 namespace WebUI {
     class WSChannel : public Channel {
@@ -66,6 +69,10 @@ namespace WebUI {
         int read() override;
         int available() override { return _rtchar == -1 ? 0 : 1; }
 
+        uint32_t setBinaryReportInterval(uint32_t ms) override;
+        uint32_t getBinaryReportInterval() override { return _binaryInterval; }
+        void     autoReportBinary() override;
+
     private:
         bool _dead = false;
 
@@ -84,6 +91,15 @@ namespace WebUI {
         // so they can be processed immediately during operations like
         // homing where GCode handling is blocked.
         int _rtchar = -1;
+
+        // Binary reports are sent from the polling task while text is
+        // flushed from the output task, so the two take turns at the socket
+        std::mutex _sendMutex;
+        bool       sendBIN(uint8_t* data, size_t length);
+
+        uint32_t     _binaryInterval = 0;
+        int32_t      _nextBinaryTime = 0;
+        BinaryReport _binaryReport;
     };
 
     class WSChannels {
@@ -35,6 +35,8 @@
 #    include "Driver/localfs.h"
 
 #    include "src/HashFS.h"
+#    include "AssetCache.h"
+#    include "UploadPipeline.h"
 #    include <list>
 
 namespace WebUI {
@@ -191,6 +193,7 @@ namespace WebUI {
         }
 
         HashFS::rehash();
+        AssetCache::load();
 
         _setupdone = true;
         return no_error;
@@ -228,11 +231,13 @@ namespace WebUI {
     bool Web_Server::myStreamFile(const char* path, bool download) {
         std::string spath(path);
         std::string hash;
+        bool        cacheable = false;  // Only the .gz form is cached
         // Check for brower cache match
 
         hash = HashFS::hash(spath);
         if (!hash.length()) {
-            hash = HashFS::hash(spath + ".gz");
+            hash      = HashFS::hash(spath + ".gz");
+            cacheable = hash.length();
         }
 
         if (hash.length() && std::string(_webserver->header("If-None-Match").c_str()) == hash) {
@@ -240,6 +245,20 @@ namespace WebUI {
             _webserver->send(304);
             return true;
         }
+
+        // A cached copy can be sent without reading flash, even during motion.
+        // A file that changed since it was cached is read again when that is safe.
+        if (cacheable) {
+            auto asset = AssetCache::find(spath + ".gz", hash);
+            if (!asset && !inMotionState()) {
+                asset = AssetCache::refresh(spath + ".gz", hash);
+            }
+            if (asset) {
+                sendAsset(*asset, path, hash, download);
+                return true;
+            }
+        }
+
         // If you load or reload WebUI while a program is running, there is a high
         // risk of stalling the motion because serving a file from
         // the local FLASH filesystem takes away a lot of CPU cycles.  If we get
@@ -289,6 +308,35 @@ namespace WebUI {
         delete file;
         return true;
     }
+    // Send a cached asset.  During motion it goes out in TCP-segment sized
+    // pieces with a pause after each, which caps the rate at about 70
+    // KB/s so that the network stack never takes much CPU from stepping.
+    void Web_Server::sendAsset(const AssetCache::Asset& asset, const char* path, const std::string& hash, bool download) {
+        const size_t     chunk       = 1460;
+        const TickType_t motionPause = 20 / portTICK_RATE_MS;
+
+        if (download) {
+            _webserver->sendHeader("Content-Disposition", "attachment");
+        }
+        _webserver->sendHeader("ETag", hash.c_str());
+        _webserver->setContentLength(asset.size);
+        _webserver->sendHeader("Content-Encoding", "gzip");
+        _webserver->send(200, getContentType(path), "");
+
+        auto client = _webserver->client();
+        for (size_t sent = 0; sent < asset.size;) {
+            size_t written = client.write(asset.data + sent, std::min(chunk, asset.size - sent));
+            if (!written) {
+                log_debug(path << " send failed after " << sent << " bytes");
+                return;
+            }
+            sent += written;
+            if (inMotionState()) {
+                vTaskDelay(motionPause);
+            }
+        }
+    }
+
     void Web_Server::sendWithOurAddress(const char* content, int code) {
         auto        ip    = WiFi.getMode() == WIFI_STA ? WiFi.localIP() : WiFi.softAPIP();
         std::string ipstr = IP_string(ip);
@@ -707,8 +755,11 @@ namespace WebUI {
                 } else if (upload.status == UPLOAD_FILE_END) {
                     std::string sizeargname(upload.filename.c_str());
                     sizeargname += "S";
-                    size_t filesize = _webserver->hasArg(sizeargname.c_str()) ? _webserver->arg(sizeargname.c_str()).toInt() : 0;
-                    uploadEnd(filesize);
+                    size_t      filesize = _webserver->hasArg(sizeargname.c_str()) ? _webserver->arg(sizeargname.c_str()).toInt() : 0;
+                    std::string digestargname(upload.filename.c_str());
+                    digestargname += "SHA256";
+                    std::string digest(_webserver->hasArg(digestargname.c_str()) ? _webserver->arg(digestargname.c_str()).c_str() : "");
+                    uploadEnd(filesize, digest);
                 } else {  //Upload cancelled
                     uploadStop();
                     return;
@@ -1009,11 +1060,19 @@ namespace WebUI {
             }
         }
 
+        if (!UploadPipeline::ready()) {
+            _upload_status = UploadStatus::FAILED;
+            log_info("Upload writer busy");
+            pushError(ESP_ERROR_FILE_CREATION, "Upload rejected, previous upload still writing");
+            return;
+        }
+
         if (_upload_status != UploadStatus::FAILED) {
             //Create file for writing
             try {
                 _uploadFile    = new FileStream(fpath, "w");
                 _upload_status = UploadStatus::ONGOING;
+                UploadPipeline::begin(_uploadFile, filename);
             } catch (const Error err) {
                 _uploadFile    = nullptr;
                 _upload_status = UploadStatus::FAILED;
@@ -1024,10 +1083,9 @@ namespace WebUI {
     }
 
     void Web_Server::uploadWrite(uint8_t* buffer, size_t length) {
-        vTaskDelay(1 / portTICK_RATE_MS);
         if (_uploadFile && _upload_status == UploadStatus::ONGOING) {
-            //no error write post data
-            if (length != _uploadFile->write(buffer, length)) {
+            // The writer task writes the data; this only waits when its buffers are all full
+            if (!UploadPipeline::write(buffer, length)) {
                 _upload_status = UploadStatus::FAILED;
                 log_info("Upload failed - file write failed");
                 pushError(ESP_ERROR_FILE_WRITE, "File write failed");
@@ -1039,16 +1097,34 @@ namespace WebUI {
         }
     }
 
-    void Web_Server::uploadEnd(size_t filesize) {
+    void Web_Server::uploadEnd(size_t filesize, const std::string& digest) {
         //if file is open close it
         if (_uploadFile) {
-            //            delete _uploadFile;
-            // _uploadFile = nullptr;
+            auto        fpath = _uploadFile->fpath();
+            std::string hash;
+            bool        written = UploadPipeline::end(hash);  // Closes the file
+            _uploadFile         = nullptr;
 
-            auto fpath = _uploadFile->fpath();
-            fpath.rehash_fs();
-            delete _uploadFile;
-            _uploadFile = nullptr;
+            if (!written && _upload_status == UploadStatus::ONGOING) {
+                _upload_status = UploadStatus::FAILED;
+                log_info("Upload failed - file write failed");
+                pushError(ESP_ERROR_FILE_WRITE, "File write failed");
+            }
+
+            // The hash is quoted, as for an ETag, and the client's digest is not
+            if (digest.length() && _upload_status == UploadStatus::ONGOING &&
+                (hash.length() != digest.length() + 2 || strncasecmp(hash.c_str() + 1, digest.c_str(), digest.length()))) {
+                _upload_status = UploadStatus::FAILED;
+                pushError(ESP_ERROR_UPLOAD, "File upload checksum mismatch");
+                log_info("Upload failed - SHA-256 mismatch - exp " << digest << " got " << hash);
+            }
+
+            // The file was hashed as it arrived, so it need not be read again
+            if (!fpath.isSD() && _upload_status == UploadStatus::ONGOING) {
+                HashFS::rehash_file(fpath, hash);
+            } else {
+                fpath.rehash_fs();
+            }
 
             // Check size
             if (filesize) {
@@ -1079,9 +1155,10 @@ namespace WebUI {
         _upload_status = UploadStatus::FAILED;
         log_info("Upload cancelled");
         if (_uploadFile) {
-            _uploadFile->fpath().rehash_fs();
-            delete _uploadFile;
+            auto fpath = _uploadFile->fpath();
+            UploadPipeline::abort();  // Closes the file
             _uploadFile = nullptr;
+            fpath.rehash_fs();
         }
     }
     void Web_Server::uploadCheck() {
@@ -1090,7 +1167,7 @@ namespace WebUI {
             cancelUpload();
             if (_uploadFile) {
                 auto fpath = _uploadFile->fpath();
-                delete _uploadFile;
+                UploadPipeline::abort();  // Closes the file
                 _uploadFile = nullptr;
                 stdfs::remove(fpath, error_code);
                 fpath.rehash_fs();
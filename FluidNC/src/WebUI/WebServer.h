@@ -11,6 +11,7 @@
 #    include "../Settings.h"
 #    include "Authentication.h"  // AuthenticationLevel
 #    include "Commands.h"
+#    include "AssetCache.h"
 
 class WebSocketsServer;
 class WebServer;
@@ -89,6 +90,7 @@ namespace WebUI {
         static void WebUpdateUpload();
 
         static bool myStreamFile(const char* path, bool download = false);
+        static void sendAsset(const AssetCache::Asset& asset, const char* path, const std::string& hash, bool download);
 
         static void pushError(int code, const char* st, bool web_error = 500, uint16_t timeout = 1000);
 
@@ -99,7 +101,7 @@ namespace WebUI {
         static void SDFileUpload();
         static void uploadStart(const char* filename, size_t filesize, const char* fs);
         static void uploadWrite(uint8_t* buffer, size_t length);
-        static void uploadEnd(size_t filesize);
+        static void uploadEnd(size_t filesize, const std::string& digest);
         static void uploadStop();
         static void uploadCheck();
 
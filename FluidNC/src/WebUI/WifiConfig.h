@@ -17,6 +17,7 @@ namespace WebUI {
         static std::string webInfo() { return std::string(); }
         static std::string station_info() { return std::string(); }
         static std::string ap_info() { return std::string(); }
+        static std::string getIP() { return std::string(); }
 
         static bool isPasswordValid(const char* password) { return false; }
         static bool begin() { return false; }
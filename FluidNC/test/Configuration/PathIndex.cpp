@@ -0,0 +1,83 @@
+#include "../TestFramework.h"
+
+#include <src/Configuration/Configurable.h>
+#include <src/Configuration/PathIndex.h>
+
+namespace Configuration {
+    class TestMotor : public Configurable {
+    public:
+        float pulse = 0;
+
+        void group(HandlerBase& handler) override { handler.item("pulse_us", pulse); }
+    };
+
+    class TestAxis : public Configurable {
+    public:
+        TestMotor* motor0 = new TestMotor();
+        TestMotor* motor1 = nullptr;  // Absent sections are not indexed
+        float      rate   = 0;
+
+        ~TestAxis() { delete motor0; }
+
+        void group(HandlerBase& handler) override {
+            handler.item("max_rate_mm_per_min", rate);
+            handler.section("motor0", motor0);
+            handler.section("motor1", motor1);
+        }
+    };
+
+    class TestAxes : public Configurable {
+    public:
+        TestAxis x;
+        TestAxis y;
+
+        void group(HandlerBase& handler) override {
+            handler.enterFactory("x", x);
+            handler.enterFactory("y", y);
+        }
+    };
+
+    class TestMachine : public Configurable {
+    public:
+        TestAxes axes;
+        float    tolerance = 0;
+
+        void group(HandlerBase& handler) override {
+            handler.item("arc_tolerance_mm", tolerance);
+            handler.enterFactory("axes", axes);
+        }
+    };
+
+    Test(PathIndex, Sections) {
+        PathIndex::invalidate();  // Another test's tree may have had the same address
+        TestMachine machine;
+        const char* leaf;
+
+        Assert(PathIndex::find(&machine, "axes/y/motor0", leaf) == machine.axes.y.motor0 && leaf == nullptr, "Section not found");
+        Assert(PathIndex::size() == 6, "Wrong number of sections");
+        Assert(PathIndex::find(&machine, "/Axes/X/", leaf) == &machine.axes.x && leaf == nullptr, "Case or slashes not ignored");
+        Assert(PathIndex::find(&machine, "axes/y/motor1", leaf) == &machine.axes.y && !strcmp(leaf, "motor1"), "Absent section not left to its parent");
+        Assert(PathIndex::find(&machine, "", leaf) == nullptr, "Empty path found");
+        Assert(PathIndex::find(&machine, "axes/z/motor0", leaf) == nullptr, "Item in a missing section found");
+    }
+
+    Test(PathIndex, Items) {
+        PathIndex::invalidate();  // Another test's tree may have had the same address
+        TestMachine machine;
+        const char* leaf;
+
+        Assert(PathIndex::find(&machine, "axes/x/motor0/Pulse_us", leaf) == machine.axes.x.motor0 && !strcmp(leaf, "Pulse_us"),
+               "Item not resolved to its section");
+        Assert(PathIndex::find(&machine, "arc_tolerance_mm", leaf) == &machine && !strcmp(leaf, "arc_tolerance_mm"), "Top level item not resolved");
+    }
+
+    Test(PathIndex, NewTree) {
+        PathIndex::invalidate();
+        TestMachine first;
+        const char* leaf;
+        Assert(PathIndex::find(&first, "axes/x", leaf) == &first.axes.x, "Section not found");
+
+        TestMachine second;
+        Assert(PathIndex::find(&second, "axes/x", leaf) == &second.axes.x, "Index not rebuilt for another tree");
+    }
+}
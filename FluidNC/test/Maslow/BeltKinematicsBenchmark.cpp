@@ -0,0 +1,164 @@
+#include "../TestFramework.h"
+
+#include <src/Machine/MachineConfig.h>
+#include <src/Maslow/BeltKinematics.h>
+#include <src/Maslow/Maslow.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Checks BeltKinematics against the per-belt Maslow_::computeTL/TR/BL/BR
+// functions, and compares their cost.  The reference below is a copy of
+// those functions, which cannot be built for the host.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Anchors from the default M4 configuration, in TL, TR, BL, BR order
+    const float cornerX[] = { -27.6f, 2924.3f, 0.0f, 2953.2f };
+    const float cornerY[] = { 2064.9f, 2066.5f, 0.0f, 0.0f };
+    const float cornerZ[] = { 100.0f, 56.0f, 34.0f, 78.0f };
+
+    const float beltEndExtension = 30;
+    const float armLength        = 123.4f;
+
+    struct Reference {
+        float centerX;
+        float centerY;
+
+        // Same as Maslow_::updateCenterXY()
+        Reference() {
+            double A = (cornerY[1] - cornerY[2]) / (cornerX[1] - cornerX[2]);
+            double B = (cornerY[3] - cornerY[0]) / (cornerX[3] - cornerX[0]);
+            centerX  = (cornerY[3] - (B * cornerX[3]) + (A * cornerX[1]) - cornerY[1]) / (A - B);
+            centerY  = A * (centerX - cornerX[1]) + cornerY[1];
+        }
+
+        // Same as Maslow_::computeTL() and friends, for corner i
+        float compute(int i, float x, float y, float z) const {
+            x       = x + centerX;
+            y       = y + centerY;
+            float a = cornerX[i] - x;
+            float b = cornerY[i] - y;
+            float c = 0.0 - (z + cornerZ[i]);
+
+            float XYlength = sqrt(a * a + b * b);
+
+            float XYBeltLength = XYlength - (beltEndExtension + armLength);
+
+            float length = sqrt(XYBeltLength * XYBeltLength + c * c);
+
+            return length;
+        }
+    };
+
+    // Targets on a grid covering most of the frame, at a few Z heights
+    template <typename F>
+    void forEachTarget(F f) {
+        for (float z = -20; z <= 20; z += 10) {
+            for (float y = -900; y <= 900; y += 7.3f) {
+                for (float x = -1300; x <= 1300; x += 9.1f) {
+                    f(x, y, z);
+                }
+            }
+        }
+    }
+
+    Test(BeltKinematics, MatchesReference) {
+        Reference      reference;
+        BeltKinematics kinematics;
+        kinematics.setAnchors(cornerX, cornerY, cornerZ, reference.centerX, reference.centerY, beltEndExtension, armLength);
+
+        float worst = 0;
+        forEachTarget([&](float x, float y, float z) {
+            float lengths[BeltKinematics::nBelts];
+            kinematics.compute(x, y, z, lengths);
+            for (int i = 0; i < BeltKinematics::nBelts; i++) {
+                worst = std::max(worst, fabsf(lengths[i] - reference.compute(i, x, y, z)));
+            }
+        });
+        Debug("BeltKinematics: worst difference from reference %.6f mm", worst);
+        Assert(worst < 0.002f, "Belt lengths differ from Maslow_::computeTL() and friends");
+    }
+
+    Test(BeltKinematics, PositionInvertsCompute) {
+        Reference      reference;
+        BeltKinematics kinematics;
+        kinematics.setAnchors(cornerX, cornerY, cornerZ, reference.centerX, reference.centerY, beltEndExtension, armLength);
+
+        float worst = 0;
+        forEachTarget([&](float x, float y, float z) {
+            float lengths[BeltKinematics::nBelts];
+            float px, py;
+            kinematics.compute(x, y, z, lengths);
+            kinematics.position(lengths[0], lengths[1], z, px, py);
+            worst = std::max(worst, std::max(fabsf(px - x), fabsf(py - y)));
+        });
+        Debug("BeltKinematics: worst position error %.6f mm", worst);
+        Assert(worst < 0.01f, "position() does not invert compute()");
+    }
+
+    Test(BeltKinematics, RebuiltOnConfigChange) {
+        // A $/ command runs afterParse() on the machine configuration, which must rebuild the table
+        Machine::MachineConfig machine;
+        machine._axes = new Machine::Axes();
+        config        = &machine;
+
+        Maslow.tlX = cornerX[0], Maslow.trX = cornerX[1], Maslow.blX = cornerX[2], Maslow.brX = cornerX[3];
+        Maslow.tlY = cornerY[0], Maslow.trY = cornerY[1], Maslow.blY = cornerY[2], Maslow.brY = cornerY[3];
+        Maslow.tlZ = cornerZ[0], Maslow.trZ = cornerZ[1], Maslow.blZ = cornerZ[2], Maslow.brZ = cornerZ[3];
+        Maslow._beltEndExtension = beltEndExtension;
+        Maslow._armLength        = armLength;
+        machine.afterParse();
+
+        Reference reference;
+        float     before[BeltKinematics::nBelts], after[BeltKinematics::nBelts];
+        Maslow.belts().compute(100, 200, 0, before);
+        Assert(fabsf(before[0] - reference.compute(0, 100, 200, 0)) < 0.002f, "Table not built from the configuration");
+
+        Maslow._armLength = armLength + 10;
+        machine.afterParse();
+        Maslow.belts().compute(100, 200, 0, after);
+        for (int i = 0; i < BeltKinematics::nBelts; i++) {
+            Assert(after[i] < before[i] - 9, "Table not rebuilt after the arm length changed");
+        }
+
+        Maslow._armLength = armLength;
+        config            = nullptr;
+    }
+
+    Test(BeltKinematics, Benchmark) {
+        Reference      reference;
+        BeltKinematics kinematics;
+        kinematics.setAnchors(cornerX, cornerY, cornerZ, reference.centerX, reference.centerY, beltEndExtension, armLength);
+
+        // Accumulate the results so that the work is not optimized away
+        size_t targets = 0;
+        float  sum     = 0;
+
+        auto start = Clock::now();
+        forEachTarget([&](float x, float y, float z) {
+            for (int i = 0; i < BeltKinematics::nBelts; i++) {
+                sum += reference.compute(i, x, y, z);
+            }
+            ++targets;
+        });
+        double referenceTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        forEachTarget([&](float x, float y, float z) {
+            float lengths[BeltKinematics::nBelts];
+            kinematics.compute(x, y, z, lengths);
+            sum -= lengths[0] + lengths[1] + lengths[2] + lengths[3];
+        });
+        double batchedTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+        Debug("BeltKinematics: %u targets, per-belt %.1f ns/target, batched %.1f ns/target, residual %.3f",
+              unsigned(targets),
+              referenceTime / targets * 1e9,
+              batchedTime / targets * 1e9,
+              sum);
+        Assert(targets > 0, "No targets");
+    }
+}
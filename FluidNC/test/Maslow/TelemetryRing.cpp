@@ -0,0 +1,78 @@
+#include "../TestFramework.h"
+
+#include <src/Maslow/Telemetry.h>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+    struct Numbered {
+        uint32_t n;
+        uint32_t check;
+    };
+
+    Test(TelemetryRing, FillAndDrain) {
+        TelemetryRing<Numbered, 8> ring;
+        Numbered                   out[16];
+        for (uint32_t i = 0; i < 10; i++) {
+            ring.push({ i, ~i });
+        }
+        Assert(ring.size() == 8, "Ring holds more than its size");
+        Assert(ring.takeDropped() == 2, "Dropped records were not counted");
+        Assert(ring.takeDropped() == 0, "Dropped count was not reset");
+
+        Assert(ring.pop(out, 3) == 3 && out[0].n == 0 && out[2].n == 2, "Records out of order");
+        Assert(ring.pop(out, 16) == 5 && out[4].n == 7, "Ring did not drain");
+        Assert(ring.pop(out, 16) == 0, "Empty ring returned records");
+
+        ring.push({ 20, ~20u });
+        ring.clear();
+        Assert(ring.size() == 0, "clear() left records");
+    }
+
+    // A producer that is sometimes faster than the consumer, as when the SD card stalls
+    Test(TelemetryRing, Threads) {
+        const uint32_t              count = 1000000;
+        TelemetryRing<Numbered, 64> ring;
+        std::atomic<bool>           finished { false };
+
+        std::thread producer([&ring, &finished]() {
+            for (uint32_t i = 0; i < count; i++) {
+                ring.push({ i, ~i });
+                if (i % 16 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            finished = true;
+        });
+
+        Numbered block[16];
+        uint32_t received = 0;
+        uint32_t last     = 0;
+        bool     ordered  = true;
+        bool     intact   = true;
+        while (true) {
+            bool   stopping = finished;
+            size_t n        = ring.pop(block, 16);
+            for (size_t i = 0; i < n; i++) {
+                intact  = intact && block[i].check == ~block[i].n;
+                ordered = ordered && (received == 0 || block[i].n > last);
+                last    = block[i].n;
+                ++received;
+            }
+            if (!n) {
+                if (stopping) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+
+        uint32_t dropped = ring.takeDropped();
+        Debug("TelemetryRing: %u received, %u dropped", received, dropped);
+        Assert(intact, "Record was torn");
+        Assert(ordered, "Records out of order");
+        Assert(received + dropped == count, "Records lost without being counted");
+    }
+}
@@ -0,0 +1,205 @@
+#include "../TestFramework.h"
+#include "../TestMachine.h"
+
+#include <src/Planner.h>
+#include <src/System.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Look-ahead planner benchmarks.  Each workload feeds a stream of short moves
+// to plan_buffer_line(), which runs planner_recalculate() on every new block.
+// The stepper is modeled rather than run: whenever the buffer is full, the
+// oldest block is "executed" by computing the time its trapezoid profile
+// takes, then discarded.  That is the same point at which mc_move_motors()
+// would wait for the stepper, so the sequence of plans does not depend on
+// timing.  The measured planning cost of each block is then replayed against
+// the execution times to count how often the stepper would have finished a
+// block before the next one was planned, i.e. how often the segment buffer
+// in Stepper::prep_buffer() would have run dry.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        bool   append;   // true: block planned, false: oldest block executed
+        double seconds;  // planning cost or execution time
+    };
+
+    struct Result {
+        std::vector<Event> events;
+        size_t             blocks      = 0;
+        double             planTime    = 0;
+        double             worstPlan   = 0;
+        double             executeTime = 0;
+    };
+
+    class PlannerBench {
+        TestMachine _machine;
+        Result      _result;
+
+        // Execution time of a trapezoid (or triangle) profile for the block at the tail
+        double executionTime(plan_block_t* block) {
+            float v0 = sqrtf(block->entry_speed_sqr);
+            float v1 = sqrtf(plan_get_exec_block_exit_speed_sqr());
+            float vn = plan_compute_profile_nominal_speed(block);
+            float a  = block->acceleration;
+            float L  = block->millimeters;
+
+            float accel_mm = (vn * vn - v0 * v0) / (2 * a);
+            float decel_mm = (vn * vn - v1 * v1) / (2 * a);
+            float minutes;
+            if (accel_mm + decel_mm <= L) {
+                minutes = (vn - v0) / a + (vn - v1) / a + (L - accel_mm - decel_mm) / vn;
+            } else {
+                float vp = sqrtf((2 * a * L + v0 * v0 + v1 * v1) / 2);
+                minutes  = (vp - v0) / a + (vp - v1) / a;
+            }
+            return minutes * 60.0;
+        }
+
+        void executeOldest() {
+            double seconds = executionTime(plan_get_current_block());
+            _result.executeTime += seconds;
+            _result.events.push_back({ false, seconds });
+            plan_discard_current_block();
+        }
+
+    public:
+        void line(float x, float y, float z, float feed) {
+            float target[MAX_N_AXIS] = { x, y, z };
+
+            plan_line_data_t pl_data = {};
+            pl_data.feed_rate        = feed;
+
+            while (plan_check_full_buffer()) {
+                executeOldest();
+            }
+
+            auto start   = Clock::now();
+            bool planned = plan_buffer_line(target, &pl_data);
+            auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (planned) {
+                _result.blocks++;
+                _result.planTime += seconds;
+                _result.worstPlan = std::max(_result.worstPlan, seconds);
+                _result.events.push_back({ true, seconds });
+            }
+        }
+
+        // Same segmentation as mc_arc(), in the XY plane
+        void arc(float cx, float cy, float radius, float start, float sweep, float z, float feed) {
+            float tolerance = config->_arcTolerance;
+            int   segments  = int(floorf(fabsf(0.5f * sweep * radius) / sqrtf(tolerance * (2 * radius - tolerance))));
+            for (int i = 1; i <= segments; i++) {
+                float theta = start + sweep * i / segments;
+                line(cx + radius * cosf(theta), cy + radius * sinf(theta), z, feed);
+            }
+        }
+
+        const Result& finish() {
+            while (plan_get_current_block()) {
+                executeOldest();
+            }
+            return _result;
+        }
+    };
+
+    // Number of times the stepper would have been idle waiting for the planner,
+    // if planning were `slowdown` times slower than on this host.
+    size_t dryCount(const Result& result, double slowdown) {
+        size_t              dry     = 0;
+        double              planned = 0;  // Time at which the planner finished the latest block
+        double              stepper = 0;  // Time at which the stepper finishes its current block
+        bool                started = false;
+        std::vector<double> ready;  // Time at which each block became available
+        size_t              next = 0;
+
+        for (auto& event : result.events) {
+            if (event.append) {
+                planned += event.seconds * slowdown;
+                ready.push_back(planned);
+            } else {
+                double available = ready[next++];
+                if (started && available > stepper) {
+                    ++dry;
+                }
+                started = true;
+                stepper = std::max(stepper, available) + event.seconds;
+                // The planner was waiting for this slot
+                planned = std::max(planned, stepper);
+            }
+        }
+        return dry;
+    }
+
+    void report(const char* name, const Result& result) {
+        // Smallest power-of-two CPU slowdown at which the stepper first runs dry, capped at 4096
+        double critical = 1;
+        while (critical < 4096 && dryCount(result, critical) == 0) {
+            critical *= 2;
+        }
+
+        Debug("%s: %u blocks, %.0f blocks/sec, worst plan %.2f us, mean plan %.2f us",
+              name,
+              unsigned(result.blocks),
+              result.blocks / result.planTime,
+              result.worstPlan * 1e6,
+              result.planTime / result.blocks * 1e6);
+        Debug("%s: %.1f s of motion, %u dry at host speed, first dry at %.0fx slowdown",
+              name,
+              result.executeTime,
+              unsigned(dryCount(result, 1)),
+              critical);
+    }
+
+    Test(PlannerBenchmark, Surfacing) {
+        PlannerBench bench;
+
+        // 3D surfacing: 0.25 mm points along raster rows of a wavy surface, 0.5 mm stepover
+        for (int row = 0; row < 100; row++) {
+            float y = row * 0.5f;
+            for (int col = 0; col <= 400; col++) {
+                float x = (row & 1) ? (400 - col) * 0.25f : col * 0.25f;
+                float z = 2.0f * sinf(x * 0.1f) * cosf(y * 0.1f);
+                bench.line(x, y, z, 3000);
+            }
+        }
+        auto& result = bench.finish();
+        report("Surfacing", result);
+        Assert(result.blocks > 0, "No blocks planned");
+    }
+
+    Test(PlannerBenchmark, Arcs) {
+        PlannerBench bench;
+
+        // Arc-heavy output: concentric circles, each broken into chords by mc_arc's rule
+        for (int ring = 1; ring <= 40; ring++) {
+            float radius = ring * 1.5f;
+            bench.line(radius, 0, 0, 2000);
+            bench.arc(0, 0, radius, 0, 2 * M_PI, 0, 2000);
+        }
+        auto& result = bench.finish();
+        report("Arcs", result);
+        Assert(result.blocks > 0, "No blocks planned");
+    }
+
+    Test(PlannerBenchmark, LaserRaster) {
+        PlannerBench bench;
+
+        // Laser raster: 0.1 mm pixels at high feed, bidirectional scan lines
+        for (int row = 0; row < 100; row++) {
+            float y = row * 0.1f;
+            for (int col = 1; col <= 500; col++) {
+                float x = (row & 1) ? (500 - col) * 0.1f : col * 0.1f;
+                bench.line(x, y, 0, 6000);
+            }
+        }
+        auto& result = bench.finish();
+        report("LaserRaster", result);
+        Assert(result.blocks > 0, "No blocks planned");
+    }
+}
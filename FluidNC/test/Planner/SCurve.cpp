@@ -0,0 +1,175 @@
+#include "../TestFramework.h"
+#include "../TestMachine.h"
+
+#include <src/Planner.h>
+#include <src/SCurve.h>
+#include <src/System.h>
+
+#include <cmath>
+
+namespace {
+    // 500 mm/sec^2 and 5000 mm/sec^3 in the planner's mm/min units
+    const float maxAccel = 500.0f * 3600.0f;
+    const float maxJerk  = 5000.0f * 3600.0f * 60.0f;
+
+    struct Profile {
+        float endSpeed;
+        float length;
+        float peak;      // Largest acceleration magnitude, sampled
+        float jerk;      // Largest rate of change of acceleration, sampled
+        float mismatch;  // Largest difference between distance and the integral of speed
+    };
+
+    Profile sample(const SCurveRamp& ramp) {
+        const int steps = 2000;
+        float     dt    = ramp.duration() / steps;
+        Profile   p     = { ramp.speed(ramp.duration()), ramp.distance(ramp.duration()), 0, 0, 0 };
+        for (int i = 1; i <= steps; i++) {
+            float t0 = (i - 1) * dt, t1 = i * dt;
+            float a0 = ramp.acceleration(t0), a1 = ramp.acceleration(t1);
+            p.peak     = fmaxf(p.peak, fmaxf(fabsf(a0), fabsf(a1)));
+            p.jerk     = fmaxf(p.jerk, fabsf(a1 - a0) / dt);
+            float step = ramp.distance(t1) - ramp.distance(t0);
+            p.mismatch = fmaxf(p.mismatch, fabsf(step - (ramp.speed(t0) + ramp.speed(t1)) * dt / 2));
+        }
+        return p;
+    }
+
+    bool near(float a, float b, float tolerance) { return fabsf(a - b) <= tolerance * fmaxf(fabsf(b), 1.0f); }
+
+    Test(SCurve, FullRamp) {
+        // From rest to 6000 mm/min, planned as the planner does for a jerk-limited block
+        float speed = 6000.0f;
+        float accel = SCurveRamp::averageAcceleration(speed, maxAccel, maxJerk);
+        float mm    = speed * speed / (2 * accel);
+        Assert(accel < maxAccel, "Average acceleration should leave room for the S-curve");
+
+        for (int falling = 0; falling < 2; falling++) {
+            SCurveRamp ramp;
+            Assert(ramp.plan(falling ? speed : 0, falling ? 0 : speed, mm, 0, 0, maxAccel, maxJerk), "Full ramp did not fit");
+            Profile p = sample(ramp);
+            Debug("Full ramp: %.3f mm, peak %.0f mm/min^2, jerk %.3g mm/min^3", p.length, p.peak, p.jerk);
+            Assert(near(p.endSpeed, falling ? 0 : speed, 1e-4f), "Wrong end speed");
+            Assert(near(p.length, mm, 1e-4f), "Wrong ramp length");
+            Assert(p.peak <= maxAccel * 1.0001f, "Peak acceleration over the limit");
+            Assert(p.jerk <= maxJerk * 1.01f, "Jerk over the limit");
+            Assert(fabsf(ramp.acceleration(0)) < maxAccel * 1e-3f, "Did not start at zero acceleration");
+            Assert(fabsf(ramp.acceleration(ramp.duration())) < maxAccel * 1e-3f, "Did not end at zero acceleration");
+            Assert(p.mismatch < 1e-5f, "Distance does not follow speed");
+        }
+    }
+
+    Test(SCurve, ShortRamp) {
+        // A ramp through only part of the speed range fits the distance that the planner allows
+        // for it within both limits, and refuses a shorter one rather than raising the jerk.
+        for (float dv : { 3000.0f, 300.0f, 10.0f }) {
+            float      mm = SCurveRamp::rampDistance(1000.0f, 1000.0f + dv, maxAccel, maxJerk);
+            SCurveRamp ramp;
+            Assert(ramp.plan(1000.0f, 1000.0f + dv, mm, 0, 0, maxAccel, maxJerk), "Ramp did not fit its planned distance");
+            Profile p = sample(ramp);
+            Debug("Short ramp of %.0f mm/min: peak %.0f mm/min^2, jerk %.3g mm/min^3", dv, p.peak, p.jerk);
+            Assert(near(p.endSpeed, 1000.0f + dv, 1e-4f), "Wrong end speed");
+            Assert(near(p.length, mm, 1e-3f), "Wrong ramp length");
+            Assert(p.peak <= maxAccel * 1.0001f, "Peak acceleration over the limit");
+            Assert(ramp.jerk() <= maxJerk && p.jerk <= maxJerk * 1.01f, "Jerk over the limit");
+
+            Assert(!ramp.plan(1000.0f, 1000.0f + dv, mm * 0.9f, 0, 0, maxAccel, maxJerk), "Ramp fit a distance that is too short");
+            p = sample(ramp);
+            Assert(ramp.jerk() <= maxJerk && p.jerk <= maxJerk * 1.01f, "Jerk raised to fit");
+            Assert(p.peak <= maxAccel * 1.0001f, "Peak acceleration over the limit");
+        }
+    }
+
+    Test(SCurve, ReachableSpeed) {
+        // The reachable speed is the inverse of the ramp distance, on both sides of the speed
+        // change that first reaches the acceleration limit
+        for (float v0 : { 0.0f, 500.0f, 4000.0f }) {
+            for (float mm : { 0.01f, 0.5f, 5.0f, 50.0f }) {
+                float speed = SCurveRamp::reachableSpeed(v0, mm, maxAccel, maxJerk);
+                float back  = SCurveRamp::rampDistance(v0, speed, maxAccel, maxJerk);
+                Debug("From %.0f over %.2f mm: %.1f mm/min, %.4f mm back", v0, mm, speed, back);
+                Assert(near(back, mm, 1e-3f), "Reachable speed does not invert the ramp distance");
+                Assert(SCurveRamp::ceilingSpeed(v0, mm, maxAccel, maxJerk) >= speed, "Ceiling below a reachable speed");
+            }
+        }
+        Assert(SCurveRamp::reachableSpeed(1000.0f, 0.0f, maxAccel, maxJerk) == 1000.0f, "Speed changed over no distance");
+    }
+
+    Test(SCurve, CarriedAcceleration) {
+        // A ramp that carries on from the previous piece keeps the acceleration under way, rather
+        // than easing it to zero
+        float accel = SCurveRamp::averageAcceleration(6000.0f, maxAccel, maxJerk);
+        float mm    = (2000.0f + 2100.0f) / 2 * 100.0f / accel;
+
+        SCurveRamp through;
+        Assert(through.plan(2000.0f, 2100.0f, mm, accel, accel, maxAccel, maxJerk), "Carried ramp did not fit");
+        Profile p = sample(through);
+        Assert(near(p.length, mm, 1e-4f), "Wrong ramp length");
+        Assert(near(p.peak, accel, 1e-3f), "Carried ramp did not hold the planned acceleration");
+
+        // Easing the carried deceleration to zero takes a change of speed of its own, which a short
+        // ramp does not have
+        SCurveRamp last;
+        Assert(!last.plan(2100.0f, 2000.0f, mm, accel, 0, maxAccel, maxJerk), "Eased off faster than the jerk limit allows");
+        Assert(last.fastest(4000.0f, 2000.0f, accel, maxAccel, maxJerk), "No room to ease off");
+        p = sample(last);
+        Assert(near(last.acceleration(0), -accel, 1e-3f), "Did not start from the carried deceleration");
+        Assert(fabsf(last.acceleration(last.duration())) < maxAccel * 1e-3f, "Did not end at zero acceleration");
+        Assert(near(p.endSpeed, 2000.0f, 1e-4f), "Wrong end speed");
+        Assert(p.peak <= maxAccel * 1.0001f && p.jerk <= maxJerk * 1.01f, "Over the limits");
+    }
+
+    Test(SCurve, PlannedAcceleration) {
+        float accels[2];
+        int   index = 0;
+        for (float length : { 0.1f, 100.0f }) {
+            TestMachine machine(5000.0f);
+            auto        block = machine.line(length, 0, 6000.0f);
+            Assert(block->max_acceleration == maxAccel, "Wrong acceleration limit");
+            accels[index++] = block->acceleration;
+        }
+        Assert(accels[0] == accels[1], "Planned acceleration depends on the block length");
+        Assert(near(accels[0], SCurveRamp::averageAcceleration(6000.0f, maxAccel, maxJerk), 1e-5f), "Wrong planned acceleration");
+
+        // A feed override changes the nominal speed, and so the acceleration that the ramps average
+        {
+            TestMachine machine(5000.0f);
+            auto        block = machine.line(100.0f, 0, 6000.0f);
+            sys.set_f_override(50);
+            plan_update_velocity_profile_parameters();
+            sys.set_f_override(FeedOverride::Default);
+            Assert(near(block->acceleration, SCurveRamp::averageAcceleration(3000.0f, maxAccel, maxJerk), 1e-5f),
+                   "Planned acceleration did not follow the override");
+        }
+
+        TestMachine trapezoid(0.0f);
+        auto        block = trapezoid.line(10.0f, 0, 6000.0f);
+        Assert(block->jerk == 0 && block->acceleration == maxAccel, "Trapezoid block changed");
+    }
+
+    Test(SCurve, RunThroughJunctions) {
+        // Short collinear blocks from rest: the ramps run through the junctions between them, so the
+        // speed at each one is bounded by its distance from the start and the end, not by its block
+        TestMachine machine(5000.0f);
+        for (int i = 1; i <= 10; i++) {
+            machine.line(i * 0.5f, 0, 6000.0f);
+        }
+        for (plan_index_t k = 1; k < 10; k++) {
+            auto  block    = plan_get_exec_block_ahead(k);
+            float expected = fminf(SCurveRamp::reachableSpeed(0, k * 0.5f, maxAccel, maxJerk),
+                                   SCurveRamp::reachableSpeed(0, 5.0f - k * 0.5f, maxAccel, maxJerk));
+            Debug("Junction %d: %.1f mm/min, expected %.1f", k, sqrtf(block->entry_speed_sqr), expected);
+            Assert(!block->anchor, "Collinear junction anchored");
+            Assert(near(sqrtf(block->entry_speed_sqr), expected, 1e-3f), "Wrong junction speed");
+        }
+        Assert(sqrtf(plan_get_exec_block_ahead(5)->entry_speed_sqr) > 2 * SCurveRamp::reachableSpeed(0, 0.5f, maxAccel, maxJerk),
+               "Short blocks held back to their own ramps");
+        Assert(plan_get_exec_block_ahead(10) == nullptr, "Block past the end");
+
+        // A sharp corner limits the speed, so the plan levels off there
+        machine.line(5.0f, 0.5f, 6000.0f);
+        auto corner = plan_get_exec_block_ahead(10);
+        Assert(corner->anchor, "Corner not anchored");
+        Assert(corner->entry_speed_sqr <= corner->max_entry_speed_sqr, "Corner over its speed limit");
+    }
+}
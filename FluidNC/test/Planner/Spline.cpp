@@ -0,0 +1,69 @@
+#include "../TestFramework.h"
+
+#include <src/Spline.h>
+
+#include <cmath>
+
+namespace {
+    // Exact point on the curve, for checking the chords
+    void bezier(const float p[4][2], float t, float& x, float& y) {
+        float s = 1 - t;
+        x       = s * s * s * p[0][0] + 3 * s * s * t * p[1][0] + 3 * s * t * t * p[2][0] + t * t * t * p[3][0];
+        y       = s * s * s * p[0][1] + 3 * s * s * t * p[1][1] + 3 * s * t * t * p[2][1] + t * t * t * p[3][1];
+    }
+
+    // Largest distance from the curve to the chords, sampled along each step
+    float flatten(const float p[4][2], float tolerance, int& segments) {
+        CubicSpline spline(p[0], p[1], p[2], p[3], tolerance);
+        float       t0 = 0, x0 = p[0][0], y0 = p[0][1];
+        float       t, x, y;
+        float       worst = 0;
+        segments          = 0;
+        while (spline.next(t, x, y)) {
+            for (int i = 1; i < 16; i++) {
+                float f = i / 16.0f;
+                float cx, cy;
+                bezier(p, t0 + f * (t - t0), cx, cy);
+                float dx = x - x0, dy = y - y0;
+                float d  = fabsf((cx - x0) * dy - (cy - y0) * dx) / sqrtf(dx * dx + dy * dy);
+                worst    = fmaxf(worst, d);
+            }
+            t0 = t, x0 = x, y0 = y;
+            ++segments;
+        }
+        Assert(t0 == 1.0f && x0 == p[3][0] && y0 == p[3][1], "Did not finish on the end point");
+        return worst;
+    }
+
+    Test(Spline, Tolerance) {
+        const float tolerance     = 0.002f;
+        const float s_curve[4][2] = { { 0, 0 }, { 100, 0 }, { 0, 100 }, { 100, 100 } };
+        int         segments;
+        float       worst = flatten(s_curve, tolerance, segments);
+
+        // A uniform division with the same guarantee needs sqrt(max|B''| / 8 / tolerance) steps,
+        // and here max|B''| = 6 * |P0 - 2 P1 + P2| = 6 * |(-200, 100)|
+        float uniform = ceilf(sqrtf(6 * hypotf(200, 100) / 8 / tolerance));
+        Debug("S curve: %d segments, uniform would need %.0f, %.5f mm from the curve", segments, uniform, worst);
+        Assert(worst <= tolerance * 1.01f, "Chord is farther from the curve than the tolerance");
+        Assert(segments < uniform, "Adaptive steps are no better than uniform ones");
+    }
+
+    Test(Spline, Straight) {
+        const float line[4][2] = { { 0, 0 }, { 10, 10 }, { 20, 20 }, { 30, 30 } };
+        int         segments;
+        flatten(line, 0.002f, segments);
+        Assert(segments == 1, "Straight curve was divided");
+    }
+
+    Test(Spline, Quadratic) {
+        // The quadratic through (0,0), control (50,100), (100,0) peaks at y = 50
+        float start[2] = { 0, 0 }, control[2] = { 50, 100 }, end[2] = { 100, 0 };
+        float first[2], second[2];
+        CubicSpline::fromQuadratic(start, control, end, first, second);
+        const float p[4][2] = { { start[0], start[1] }, { first[0], first[1] }, { second[0], second[1] }, { end[0], end[1] } };
+        float       x, y;
+        bezier(p, 0.5f, x, y);
+        Assert(fabsf(x - 50) < 1e-4 && fabsf(y - 50) < 1e-4, "Quadratic converted to the wrong cubic");
+    }
+}
@@ -0,0 +1,130 @@
+#include "../TestFramework.h"
+
+#include <src/EventQueue.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Records the order in which events run
+    std::string ran;
+
+    class Recorder : public Event {
+        char _name;
+
+    public:
+        Recorder(char name, EventPriority priority) : Event(priority), _name(name) {}
+        void run(void* arg) override {
+            ran += _name;
+            if (arg) {
+                ran += char('0' + intptr_t(arg));
+            }
+        }
+    };
+
+    Recorder start('S', EventPriority::Control);
+    Recorder hold('H', EventPriority::Control);
+    Recorder reset('R', EventPriority::Control);
+    Recorder feed('F', EventPriority::Normal);
+    Recorder macro('M', EventPriority::Normal);
+
+    void* arg(int n) { return reinterpret_cast<void*>(intptr_t(n)); }
+
+    void dispatchAll(EventQueue& queue) {
+        ran.clear();
+        while (queue.dispatch()) {}
+    }
+
+    Test(EventQueue, ControlFirst) {
+        EventQueue queue;
+        queue.send(&feed, arg(1));
+        queue.send(&macro, arg(2));
+        queue.send(&hold, nullptr);
+        queue.send(&feed, arg(3));
+        queue.send(&reset, nullptr);
+        dispatchAll(queue);
+        Assert(ran == "HRF1M2F3", "Events ran in the wrong order");
+    }
+
+    // ~ then ! must leave the machine held, so state changes keep their order
+    Test(EventQueue, ControlOrder) {
+        EventQueue queue;
+        queue.send(&start, nullptr);
+        queue.send(&feed, arg(1));
+        queue.send(&hold, nullptr);
+        queue.send(&start, nullptr);
+        queue.send(&reset, nullptr);
+        dispatchAll(queue);
+        Assert(ran == "SHSRF1", "Control events ran out of order");
+    }
+
+    Test(EventQueue, Coalesce) {
+        EventQueue queue;
+        for (int i = 0; i < 100; i++) {
+            queue.send(&feed, arg(1));
+        }
+        queue.send(&feed, arg(2));
+        queue.send(&feed, arg(1));
+        auto stats = queue.stats(EventPriority::Normal, false);
+        Assert(stats.sent == 102 && stats.coalesced == 99 && stats.highWater == 3, "Repeats were not coalesced");
+
+        dispatchAll(queue);
+        std::string expected;
+        for (int i = 0; i < 100; i++) {
+            expected += "F1";
+        }
+        expected += "F2F1";
+        Assert(ran == expected, "Coalesced events did not all run, in order");
+        Assert(queue.stats(EventPriority::Normal, true).dispatched == 3, "Entries were not counted");
+        Assert(queue.stats(EventPriority::Normal, false).sent == 0, "Counters were not reset");
+    }
+
+    Test(EventQueue, FullLane) {
+        EventQueue queue;
+        int        accepted = 0;
+        for (int i = 0; i < 100; i++) {
+            accepted += queue.send(&macro, arg(i % 2));
+        }
+        Assert(queue.send(&hold, nullptr), "A full normal lane blocked a control event");
+        auto stats = queue.stats(EventPriority::Normal, false);
+        Assert(stats.dropped == uint32_t(100 - accepted) && stats.dropped > 0, "Drops were not counted");
+        dispatchAll(queue);
+        Assert(ran[0] == 'H', "Control event did not run first");
+    }
+
+    // Several senders, as from the poller, the web server and pin interrupts
+    Test(EventQueue, Threads) {
+        EventQueue               queue;
+        const int                perThread = 20000;
+        std::atomic<int>         finished { 0 };
+        std::vector<std::thread> senders;
+        for (int t = 0; t < 3; t++) {
+            senders.emplace_back([&queue, &finished, t]() {
+                for (int i = 0; i < perThread; i++) {
+                    while (!queue.send(&feed, arg(t + 1))) {
+                        std::this_thread::yield();
+                    }
+                }
+                ++finished;
+            });
+        }
+        size_t runs = 0;
+        while (true) {
+            bool stopping = finished == 3;
+            ran.clear();
+            if (queue.dispatch()) {
+                runs += ran.size() / 2;
+            } else if (stopping) {
+                break;
+            }
+        }
+        for (auto& sender : senders) {
+            sender.join();
+        }
+        auto stats = queue.stats(EventPriority::Normal, false);
+        Debug("EventQueue: %u sent, %u coalesced, %u dropped and sent again", stats.sent, stats.coalesced, stats.dropped);
+        Assert(runs == 3 * perThread, "Events were lost");
+    }
+}
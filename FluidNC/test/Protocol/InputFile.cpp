@@ -0,0 +1,102 @@
+#include "../TestFramework.h"
+
+#include <src/InputFile.h>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+    class NullChannel : public Channel {
+    public:
+        NullChannel() : Channel("test") {}
+        size_t write(uint8_t c) override { return 1; }
+    };
+
+    class Capture : public Print {
+    public:
+        std::string text;
+        size_t      write(uint8_t c) override {
+            text += char(c);
+            return 1;
+        }
+    };
+
+    Test(InputFile, ProgressOutlivesFile) {
+        const char* path = "/tmp/fluidnc_progress_test.nc";
+        FILE*       fp   = fopen(path, "w");
+        fputs("G0 X1\nG0 X2\n", fp);
+        fclose(fp);
+
+        NullChannel out;
+        char        line[Channel::maxLine];
+        auto        file = new InputFile("", path, WebUI::AuthenticationLevel::LEVEL_ADMIN, out);
+        Assert(file->pollLine(line) != nullptr, "First line not read");
+
+        Capture running;
+        InputFile::reportProgress(running);
+        Debug("Running: %s", running.text.c_str());
+        Assert(running.text.find("|SD:50") == 0, "Wrong progress");
+        Assert(running.text.find(path) != std::string::npos, "Path missing from progress");
+
+        // A status report after the job is gone must not touch the deleted file
+        delete file;
+        Capture done;
+        InputFile::reportProgress(done);
+        Assert(done.text.empty(), "Progress reported for a deleted file");
+
+        remove(path);
+    }
+
+    Test(InputFile, DoneAfterLastAck) {
+        const char* path = "/tmp/fluidnc_done_test.nc";
+        FILE*       fp   = fopen(path, "w");
+        fputs("G0 X1\nG0 X2\n", fp);
+        fclose(fp);
+
+        NullChannel out;
+        char        line[Channel::maxLine];
+        auto        file = new InputFile("", path, WebUI::AuthenticationLevel::LEVEL_ADMIN, out);
+        Assert(file->pollLine(line) != nullptr && file->pollLine(line) != nullptr, "Lines not read");
+
+        // The poller reaches the end of the file while both lines are still waiting to run
+        Assert(file->pollLine(line) == nullptr, "Line read past the end");
+        Assert(file->pollLine(line) == nullptr, "Line read past the end");
+        Capture drained;
+        InputFile::reportProgress(drained);
+        Assert(drained.text.find("|SD:100") == 0, "Job ended before its lines ran");
+
+        file->ack(Error::Ok);
+        Capture running;
+        InputFile::reportProgress(running);
+        Assert(!running.text.empty(), "Job ended before its last line ran");
+
+        file->ack(Error::Ok);
+        Capture done;
+        InputFile::reportProgress(done);
+        Assert(done.text.empty(), "Job did not end with its last line");
+        Assert(!file->stopped(), "Successful job stopped");
+
+        delete file;
+        remove(path);
+    }
+
+    Test(InputFile, LastLineFails) {
+        const char* path = "/tmp/fluidnc_fail_test.nc";
+        FILE*       fp   = fopen(path, "w");
+        fputs("G0 X1\n", fp);
+        fclose(fp);
+
+        NullChannel out;
+        char        line[Channel::maxLine];
+        auto        file = new InputFile("", path, WebUI::AuthenticationLevel::LEVEL_ADMIN, out);
+        Assert(file->pollLine(line) != nullptr, "Line not read");
+        Assert(file->pollLine(line) == nullptr, "Line read past the end");
+
+        // A failure after the end of the file has been read is still the job's result
+        file->ack(Error::GcodeUnusedWords);
+        Assert(file->stopped(), "Failed job not stopped");
+
+        delete file;
+        remove(path);
+    }
+}
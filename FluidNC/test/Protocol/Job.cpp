@@ -0,0 +1,89 @@
+#include "../TestFramework.h"
+#include "../TestMachine.h"
+
+#include <src/Channel.h>
+#include <src/GCode.h>
+#include <src/Job.h>
+#include <src/Planner.h>
+#include <src/Protocol.h>
+#include <src/System.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+    class NullChannel : public Channel {
+    public:
+        NullChannel() : Channel("test") {}
+        size_t write(uint8_t c) override { return 1; }
+    };
+
+    // A test machine with the parser reset as gc_init() would leave it, without the
+    // coordinate settings, and a job file to compile
+    class JobMachine {
+        TestMachine _machine;
+        std::string _path;
+
+    public:
+        NullChannel out;
+
+        JobMachine(const char* gcode) {
+            sys.set_abort(false);
+            sys.set_state(State::Idle);
+            memset(&gc_state, 0, sizeof(gc_state));
+            gc_state.modal.coord_select = CoordIndex::G54;
+            gc_set_spline_control(nullptr);
+
+            _path    = "/tmp/fluidnc_job_test.nc";
+            FILE* fp = fopen(_path.c_str(), "w");
+            fputs(gcode, fp);
+            fclose(fp);
+        }
+
+        Error compile() { return job_compile("", _path.c_str(), WebUI::AuthenticationLevel::LEVEL_ADMIN, out); }
+        Error run() { return job_run("", (_path + ".job").c_str(), out); }
+
+        ~JobMachine() {
+            remove(_path.c_str());
+            remove((_path + ".job").c_str());
+            sys.set_abort(false);
+        }
+    };
+
+    const char* splineJob = "G21 G90 G0 X1\n"
+                            "G1 X2 F300\n"
+                            "G91 G1 X1 F400\n"
+                            "G90 G5 X6 Y0 I1 J0 P-1 Q0\n"
+                            "G5 X9 Y0 P-1 Q0 S100\n";  // The speed word makes the parser handle this one at run time
+
+    Test(Job, StateAfterMotion) {
+        JobMachine machine(splineJob);
+        Assert(machine.compile() == Error::Ok, "Job did not compile");
+        Assert(gc_state.position[X_AXIS] == 0.0f, "Compiling moved the parser");
+
+        // The last G5 continues the compiled one, so it needs the control point that the compiled one left behind
+        Error err = machine.run();
+        Debug("Run: %s, X %.3f", errorString(err), gc_state.position[X_AXIS]);
+        Assert(err == Error::Ok, "Parsed block did not see the state of the compiled motion before it");
+        Assert(fabsf(gc_state.position[X_AXIS] - 9.0f) < 1e-4f, "Wrong end position");
+        Assert(gc_state.modal.motion == Motion::CubicSpline && gc_state.feed_rate == 400.0f, "Wrong end modes");
+        Assert(gc_state.spindle_speed == 100.0f, "Wrong end speed");
+    }
+
+    void abortJob() { sys.set_abort(true); }
+
+    NoArgEvent abortEvent { abortJob };
+
+    Test(Job, RealtimeBetweenRecords) {
+        JobMachine machine(splineJob);
+        Assert(machine.compile() == Error::Ok, "Job did not compile");
+
+        // Events are handled before the first record, and the abort keeps the rest from being planned
+        protocol_send_event(&abortEvent);
+        machine.run();
+        Assert(sys.abort(), "Event was not handled during the run");
+        Assert(plan_get_current_block() == nullptr, "Records were planned after the abort");
+        Assert(gc_state.position[X_AXIS] == 0.0f, "Parser moved after the abort");
+    }
+}
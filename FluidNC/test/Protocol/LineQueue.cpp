@@ -0,0 +1,136 @@
+#include "../TestFramework.h"
+
+#include <src/LineQueue.h>
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace {
+    // Channel is abstract, but the queue only stores and compares the pointers
+    Channel* const first  = reinterpret_cast<Channel*>(0x1000);
+    Channel* const second = reinterpret_cast<Channel*>(0x2000);
+
+    bool add(LineQueue& queue, const char* text, Channel* channel) {
+        char* line = queue.reserve();
+        if (!line) {
+            return false;
+        }
+        strcpy(line, text);
+        queue.push(channel);
+        return true;
+    }
+
+    Test(LineQueue, InOrder) {
+        LineQueue queue;
+        char*     line;
+        Channel*  channel;
+
+        Assert(!queue.front(line, channel), "New queue is not empty");
+        Assert(add(queue, "G0X1", first));
+        Assert(add(queue, "$I", second));
+
+        Assert(queue.front(line, channel));
+        Assert(!strcmp(line, "G0X1") && channel == first, "Lines out of order");
+        queue.pop();
+        Assert(queue.front(line, channel));
+        Assert(!strcmp(line, "$I") && channel == second, "Lines out of order");
+        queue.pop();
+        Assert(!queue.front(line, channel), "Queue is not empty");
+    }
+
+    Test(LineQueue, Full) {
+        LineQueue queue;
+        int       added = 0;
+        while (add(queue, "G1X1", first)) {
+            ++added;
+        }
+        Assert(added == LineQueue::depth - 1, "Queue holds the wrong number of lines");
+
+        char*    line;
+        Channel* channel;
+        Assert(queue.front(line, channel));
+        queue.pop();
+        Assert(add(queue, "G1X2", first), "No room after a line was executed");
+    }
+
+    Test(LineQueue, EndOfFile) {
+        // A file that reaches its end is killed while its last lines are
+        // queued; every one of them must still be delivered
+        LineQueue queue;
+        add(queue, "G1X1", first);
+        add(queue, "G1X2", first);
+        add(queue, "G1X3", first);
+
+        char*    line;
+        Channel* channel;
+        int      delivered = 0;
+        while (queue.front(line, channel)) {
+            Assert(channel == first, "Line delivered for the wrong channel");
+            Assert(queue.holds(first), "Channel released while a line is executing");
+            queue.pop();
+            ++delivered;
+        }
+        Assert(delivered == 3, "Last lines of the file were lost");
+        Assert(!queue.holds(first), "Channel still held after its lines were acked");
+    }
+
+    Test(LineQueue, Kill) {
+        LineQueue queue;
+        add(queue, "G1X1", first);
+        add(queue, "$I", second);
+        add(queue, "G1X2", first);
+
+        char*    line;
+        Channel* channel;
+        Assert(queue.holds(first) && queue.holds(second));
+        queue.front(line, channel);
+        queue.pop();
+        Assert(queue.holds(first), "Killed channel released with a line still queued");
+        queue.front(line, channel);
+        queue.pop();
+        Assert(!queue.holds(second), "Channel held after its only line was popped");
+        Assert(queue.holds(first));
+        queue.front(line, channel);
+        Assert(channel == first && !strcmp(line, "G1X2"));
+        queue.pop();
+        Assert(!queue.holds(first), "Channel held after its last line was popped");
+
+        add(queue, "G1X3", second);
+        queue.flush();
+        Assert(!queue.front(line, channel), "Flush left lines in the queue");
+        Assert(!queue.holds(second), "Flush left a channel held");
+    }
+
+    Test(LineQueue, ProducerConsumer) {
+        LineQueue queue;
+        const int count = 100000;
+
+        std::thread producer([&]() {
+            char text[20];
+            for (int i = 0; i < count; ++i) {
+                snprintf(text, sizeof(text), "N%d", i);
+                while (!add(queue, text, first)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        bool inOrder = true;
+        for (int i = 0; i < count;) {
+            char*    line;
+            Channel* channel;
+            if (!queue.front(line, channel)) {
+                std::this_thread::yield();
+                continue;
+            }
+            char expected[20];
+            snprintf(expected, sizeof(expected), "N%d", i);
+            inOrder = inOrder && !strcmp(line, expected) && channel == first;
+            queue.pop();
+            ++i;
+        }
+        producer.join();
+        Assert(inOrder, "Lines were lost, repeated or reordered");
+    }
+}
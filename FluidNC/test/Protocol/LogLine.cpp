@@ -0,0 +1,37 @@
+#include "../TestFramework.h"
+
+#include <src/LogLine.h>
+
+#include <cstring>
+#include <string>
+
+namespace {
+    Test(LogLine, Pool) {
+        LogLine* lines[LogLine::poolSize];
+        for (int i = 0; i < LogLine::poolSize; i++) {
+            lines[i] = LogLine::claim();
+            Assert(lines[i] != nullptr, "Pool ran out early");
+        }
+        Assert(LogLine::claim() == nullptr, "Pool gave out more lines than it has");
+
+        lines[3]->print("stale");
+        lines[3]->release();
+        LogLine* again = LogLine::claim();
+        Assert(again == lines[3] && again->length() == 0 && !strcmp(again->c_str(), ""), "Released line was not reused empty");
+
+        for (auto line : lines) {
+            line->release();
+        }
+    }
+
+    Test(LogLine, Overflow) {
+        LogLine* line = LogLine::claim();
+        line->print("[MSG:");
+        std::string fill(LogLine::maxLength - 5, 'x');
+        Assert(line->write(fill.c_str(), fill.length()) == fill.length(), "Line did not take its full length");
+        Assert(line->length() == LogLine::maxLength, "Wrong length");
+        Assert(line->write(']') == 0, "Line took more than it holds");
+        Assert(line->length() == LogLine::maxLength && line->c_str()[5] == 'x', "Failed write changed the line");
+        line->release();
+    }
+}
@@ -0,0 +1,185 @@
+#include "../TestFramework.h"
+
+#include <src/BinaryReport.h>
+
+#include <cstring>
+
+namespace {
+    // Decodes frames as a client would, following the layout in BinaryReport.h
+    class Decoder {
+    public:
+        // Returns false if the frame cannot be decoded, like a delta frame
+        // that follows a lost frame
+        bool decode(const uint8_t* frame, size_t length) {
+            _p   = frame;
+            _end = frame + length;
+            if (length < 4 || _p[0] != BinaryReport::magic) {
+                return false;
+            }
+            uint8_t flags    = _p[1];
+            uint8_t sequence = _p[2];
+            bool    keyframe = flags & BinaryReport::Keyframe;
+            if (!keyframe && (!_synced || sequence != uint8_t(_sequence + 1))) {
+                _synced = false;
+                return false;
+            }
+            if (keyframe) {
+                _sample = {};
+            }
+            _sequence        = sequence;
+            _sample.n_axis   = _p[3];
+            _sample.hasBelts = flags & BinaryReport::Belts;
+            _p += 4;
+            _sample.time += varint();
+
+            delta(_sample.state);
+            deltas(_sample.mpos, _sample.n_axis);
+            deltas(_sample.wco, _sample.n_axis);
+            delta(_sample.feed);
+            delta(_sample.spindle);
+            delta(_sample.feedOverride);
+            delta(_sample.rapidOverride);
+            delta(_sample.spindleOverride);
+            delta(_sample.accessories);
+            delta(_sample.plannerAvailable);
+            delta(_sample.rxAvailable);
+            delta(_sample.lineNumber);
+            delta(_sample.limits);
+            delta(_sample.probe);
+            if (_sample.hasBelts) {
+                deltas(_sample.belt, BinaryReport::beltCount);
+                deltas(_sample.current, BinaryReport::beltCount);
+            }
+            _synced = _p == _end;
+            return _synced;
+        }
+
+        const BinaryReport::Sample& sample() const { return _sample; }
+
+    private:
+        uint32_t varint() {
+            uint32_t value = 0;
+            for (int shift = 0; _p < _end; shift += 7) {
+                uint8_t c = *_p++;
+                value |= uint32_t(c & 0x7f) << shift;
+                if (!(c & 0x80)) {
+                    break;
+                }
+            }
+            return value;
+        }
+
+        void delta(int32_t& value) {
+            uint32_t zigzag = varint();
+            value += int32_t((zigzag >> 1) ^ -(zigzag & 1));
+        }
+
+        void deltas(int32_t* values, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                delta(values[i]);
+            }
+        }
+
+        BinaryReport::Sample _sample = {};
+        const uint8_t*       _p;
+        const uint8_t*       _end;
+        uint8_t              _sequence = 0;
+        bool                 _synced   = false;
+    };
+
+    // A Maslow running a job
+    BinaryReport::Sample sample(int i) {
+        BinaryReport::Sample s = {};
+        s.time                 = 100000 + 50 * i;
+        s.n_axis               = 3;
+        s.hasBelts             = true;
+        s.state                = 2;
+        for (int axis = 0; axis < 3; axis++) {
+            s.mpos[axis] = -412500 + 137 * i * (axis + 1);
+            s.wco[axis]  = 10000 * axis - 3250;
+        }
+        s.feed             = 1200 + (i % 50);
+        s.spindle          = 12000;
+        s.feedOverride     = 100;
+        s.rapidOverride    = 100;
+        s.spindleOverride  = 100;
+        s.accessories      = BinaryReport::SpindleCw;
+        s.plannerAvailable = 15 - (i % 3);
+        s.rxAvailable      = 255;
+        s.lineNumber       = 1000 + i / 4;
+        for (int belt = 0; belt < BinaryReport::beltCount; belt++) {
+            s.belt[belt]    = 1800000 + (belt & 1 ? -90 : 90) * i;
+            s.current[belt] = 400 + (i * 7 + belt * 13) % 60;
+        }
+        return s;
+    }
+
+    bool same(const BinaryReport::Sample& a, const BinaryReport::Sample& b) {
+        return a.time == b.time && a.n_axis == b.n_axis && a.hasBelts == b.hasBelts && a.state == b.state &&
+               !memcmp(a.mpos, b.mpos, a.n_axis * sizeof(int32_t)) && !memcmp(a.wco, b.wco, a.n_axis * sizeof(int32_t)) &&
+               a.feed == b.feed && a.spindle == b.spindle && a.feedOverride == b.feedOverride && a.rapidOverride == b.rapidOverride &&
+               a.spindleOverride == b.spindleOverride && a.accessories == b.accessories && a.plannerAvailable == b.plannerAvailable &&
+               a.rxAvailable == b.rxAvailable && a.lineNumber == b.lineNumber && a.limits == b.limits && a.probe == b.probe &&
+               (!a.hasBelts || (!memcmp(a.belt, b.belt, sizeof(a.belt)) && !memcmp(a.current, b.current, sizeof(a.current))));
+    }
+
+    Test(BinaryReport, RoundTrip) {
+        BinaryReport encoder;
+        Decoder      decoder;
+        uint8_t      frame[BinaryReport::maxLength];
+        size_t       keyframes = 0;
+        size_t       bytes     = 0;
+        for (int i = 0; i < 500; i++) {
+            auto   s      = sample(i);
+            size_t length = encoder.encode(s, frame);
+            Assert(length <= BinaryReport::maxLength, "Frame overflow");
+            keyframes += frame[1] & BinaryReport::Keyframe;
+            bytes += length;
+            Assert(decoder.decode(frame, length), "Frame did not decode");
+            Assert(same(decoder.sample(), s), "Decoded sample differs");
+        }
+        Assert(keyframes == 500 / BinaryReport::keyframeInterval, "Unexpected number of keyframes");
+        Debug("BinaryReport: %.1f bytes/frame", double(bytes) / 500);
+    }
+
+    Test(BinaryReport, Extremes) {
+        BinaryReport         encoder;
+        Decoder              decoder;
+        uint8_t              frame[BinaryReport::maxLength];
+        BinaryReport::Sample s = {};
+        s.n_axis               = MAX_N_AXIS;
+        s.hasBelts             = true;
+        for (int32_t value : { INT32_MAX, INT32_MIN, INT32_MAX, -1, 0 }) {
+            s.time = uint32_t(value);
+            for (auto p : { &s.state, &s.feed, &s.spindle, &s.lineNumber }) {
+                *p = value;
+            }
+            for (size_t i = 0; i < MAX_N_AXIS; i++) {
+                s.mpos[i] = s.wco[i] = value;
+            }
+            for (size_t i = 0; i < BinaryReport::beltCount; i++) {
+                s.belt[i] = s.current[i] = value;
+            }
+            size_t length = encoder.encode(s, frame);
+            Assert(length <= BinaryReport::maxLength, "Frame overflow");
+            Assert(decoder.decode(frame, length) && same(decoder.sample(), s), "Extreme values did not survive");
+        }
+    }
+
+    Test(BinaryReport, LostFrame) {
+        BinaryReport encoder;
+        Decoder      decoder;
+        uint8_t      frame[BinaryReport::maxLength];
+        size_t       length = encoder.encode(sample(0), frame);
+        Assert(decoder.decode(frame, length), "Keyframe did not decode");
+
+        encoder.encode(sample(1), frame);  // Lost
+        length = encoder.encode(sample(2), frame);
+        Assert(!decoder.decode(frame, length), "Decoded a frame after a lost one");
+
+        encoder.restart();
+        length = encoder.encode(sample(3), frame);
+        Assert(frame[1] & BinaryReport::Keyframe, "restart() did not send a keyframe");
+        Assert(decoder.decode(frame, length) && same(decoder.sample(), sample(3)), "Did not recover at the keyframe");
+    }
+}
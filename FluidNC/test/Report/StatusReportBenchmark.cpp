@@ -0,0 +1,253 @@
+#include "../TestFramework.h"
+
+#include <src/Config.h>
+#include <src/MyIOStream.h>
+#include <src/NutsBolts.h>
+#include <src/StatusReport.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+
+// Compares the fixed buffer status report with the way report_realtime_status()
+// used to build it: a LogStream that grows a heap std::string, with another
+// std::string for each axis list and one for the pin letters.  The reference
+// below is a copy of that code, which cannot be built for the host.
+
+namespace {
+    std::atomic<size_t> allocations { 0 };
+}
+
+// Counts every allocation in the test program; only the differences across
+// a benchmark loop are used.
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const size_t n_axis = 4;
+
+    // Same as report_util_axis_values() in Report.cpp
+    std::string referenceAxes(const float* axis_value, bool inches) {
+        std::ostringstream msg;
+        for (size_t idx = 0; idx < n_axis; idx++) {
+            int   decimals;
+            float value = axis_value[idx];
+            if (idx >= A_AXIS && idx <= C_AXIS) {
+                decimals = 3;
+            } else {
+                if (inches) {
+                    value /= MM_PER_INCH;
+                    decimals = 4;
+                } else {
+                    decimals = 3;
+                }
+            }
+            msg << std::fixed << std::setprecision(decimals) << value;
+            if (idx < (n_axis - 1)) {
+                msg << ",";
+            }
+        }
+        return msg.str();
+    }
+
+    // Same as pinString() in Report.cpp, with a limit on X and the feed hold pin active
+    std::string referencePins() {
+        std::string msg;
+        msg += "|Pn:";
+        msg += 'X';
+        std::string ctrl_pin_report;
+        ctrl_pin_report += 'H';
+        msg += ctrl_pin_report;
+        return msg;
+    }
+
+    // Same as LogStream
+    class ReferenceStream : public Print {
+    public:
+        std::string* _line = new std::string();
+        size_t       write(uint8_t c) override {
+            *_line += (char)c;
+            return 1;
+        }
+    };
+
+    struct Sample {
+        float    mpos[MAX_N_AXIS];
+        float    wco[MAX_N_AXIS];
+        float    rate;
+        uint32_t speed;
+    };
+
+    Sample sample(int i) {
+        Sample s;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            s.mpos[axis] = -412.5f + 0.0137f * i * (axis + 1);
+            s.wco[axis]  = 10.0f * axis - 3.25f;
+        }
+        s.rate  = 1200.0f + (i % 50);
+        s.speed = 12000;
+        return s;
+    }
+
+    std::string* referenceReport(const Sample& s) {
+        ReferenceStream msg;
+        msg << "<"
+            << "Run";
+        msg << "|MPos:";
+        msg << referenceAxes(s.mpos, false).c_str();
+        msg << "|Bf:" << 15 << "," << 127;
+        msg << "|FS:" << setprecision(0) << s.rate << "," << s.speed;
+        msg << referencePins();
+        msg << "|WCO:" << referenceAxes(s.wco, false).c_str();
+        msg << "|Ov:" << 100 << "," << 100 << "," << 100;
+        msg << "|A:"
+            << "S";
+        msg << ">";
+        return msg._line;
+    }
+
+    struct WcoKey {
+        float    wco[MAX_N_AXIS];
+        uint32_t n_axis;
+        uint32_t inches;
+    };
+
+    CachedReportText<WcoKey, StatusReport::maxLength / 2> wcoText;
+
+    void fixedReport(StatusReport& msg, const Sample& s) {
+        msg << "<"
+            << "Run";
+        msg << "|MPos:";
+        msg.axes(s.mpos, n_axis, false);
+        msg << "|Bf:" << 15 << "," << 127;
+        msg << "|FS:";
+        msg.fixed(s.rate, 0);
+        msg << "," << s.speed;
+        msg << "|Pn:"
+            << "XH";
+        WcoKey key;
+        memcpy(key.wco, s.wco, sizeof(key.wco));
+        key.n_axis = n_axis;
+        key.inches = false;
+        wcoText.print(msg, key, [&s](StatusReport& msg) {
+            msg << "|WCO:";
+            msg.axes(s.wco, n_axis, false);
+        });
+        msg << "|Ov:" << 100 << "," << 100 << "," << 100;
+        msg << "|A:"
+            << "S";
+        msg << ">";
+    }
+
+    // Values that round to zero have no sign, where printf shows -0.000
+    std::string withoutNegativeZero(const std::string& text) {
+        std::string        result;
+        std::istringstream values(text);
+        std::string        value;
+        while (std::getline(values, value, ',')) {
+            if (value[0] == '-' && strtod(value.c_str(), nullptr) == 0) {
+                value.erase(0, 1);
+            }
+            result += result.empty() ? value : "," + value;
+        }
+        return result;
+    }
+
+    Test(StatusReport, AxesMatchReference) {
+        StatusReport report;
+        int          mismatches = 0;
+        for (int i = -200000; i <= 200000; i += 7) {
+            float values[MAX_N_AXIS] = { i * 0.0011f, i * -0.00037f, i * 0.13f, i * 0.0009f };
+            for (bool inches : { false, true }) {
+                report.clear();
+                report.axes(values, n_axis, inches);
+                if (withoutNegativeZero(referenceAxes(values, inches)) != report.c_str()) {
+                    if (mismatches++ < 5) {
+                        Debug("StatusReport: %s != %s", report.c_str(), referenceAxes(values, inches).c_str());
+                    }
+                }
+            }
+        }
+        Assert(mismatches == 0, "Axis values differ from report_util_axis_values()");
+    }
+
+    Test(StatusReport, SameAsReference) {
+        for (int i = 0; i < 1000; i++) {
+            auto         s         = sample(i);
+            std::string* reference = referenceReport(s);
+            StatusReport report;
+            fixedReport(report, s);
+            if (*reference != report.c_str()) {
+                Debug("StatusReport: %s != %s", report.c_str(), reference->c_str());
+            }
+            Assert(*reference == report.c_str(), "Report differs from reference");
+            delete reference;
+        }
+    }
+
+    Test(StatusReport, Pool) {
+        StatusReport* claimed[StatusReport::poolSize];
+        for (auto& report : claimed) {
+            report = StatusReport::claim();
+            Assert(report != nullptr, "Pool is short of reports");
+        }
+        Assert(StatusReport::claim() == nullptr, "Claimed report handed out twice");
+        claimed[1]->release();
+        Assert(StatusReport::claim() == claimed[1], "Released report was not reused");
+        for (auto& report : claimed) {
+            report->release();
+        }
+    }
+
+    Test(StatusReport, Benchmark) {
+        const int reports = 200000;
+        size_t    bytes   = 0;
+
+        size_t allocationsBefore = allocations;
+        auto   start             = Clock::now();
+        for (int i = 0; i < reports; i++) {
+            std::string* line = referenceReport(sample(i));
+            bytes += line->size();
+            delete line;
+        }
+        double referenceTime        = std::chrono::duration<double>(Clock::now() - start).count();
+        size_t referenceAllocations = allocations - allocationsBefore;
+
+        size_t fixedBytes = 0;
+        allocationsBefore = allocations;
+        start             = Clock::now();
+        for (int i = 0; i < reports; i++) {
+            StatusReport* report = StatusReport::claim();
+            fixedReport(*report, sample(i));
+            fixedBytes += report->length();
+            report->release();
+        }
+        double fixedTime        = std::chrono::duration<double>(Clock::now() - start).count();
+        size_t fixedAllocations = allocations - allocationsBefore;
+
+        Debug("StatusReport: LogStream %.1f MB/s, %.1f allocations/report; fixed buffer %.1f MB/s, %.1f allocations/report",
+              bytes / referenceTime / 1e6,
+              double(referenceAllocations) / reports,
+              fixedBytes / fixedTime / 1e6,
+              double(fixedAllocations) / reports);
+        Assert(bytes == fixedBytes, "Reports differ in length");
+        Assert(fixedAllocations == 0, "Fixed buffer report allocated memory");
+    }
+}
@@ -0,0 +1,152 @@
+#include "../TestFramework.h"
+
+#include <src/Settings.h>
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+// Compares WordIndex::find() with the way do_command_or_setting() used to find
+// a $ key: a scan of Setting::List by full name, another by Grbl name, then a
+// scan of Command::List.  The reference below is a copy of those loops.  The
+// names are made up, in about the numbers that a build with WiFi and the
+// Maslow commands registers, and the keys are all of them plus some misses,
+// as when a UI asks for everything on connect.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    class BenchSetting : public Setting {
+    public:
+        BenchSetting(const char* grblName, const char* fullName) : Setting(nullptr, WEBSET, WG, grblName, fullName, nullptr) {}
+        Error       setStringValue(char* value) override { return Error::Ok; }
+        const char* getStringValue() override { return ""; }
+        const char* getDefaultString() override { return ""; }
+    };
+
+    class BenchCommand : public Command {
+    public:
+        BenchCommand(const char* grblName, const char* fullName) : Command(nullptr, GRBLCMD, WG, grblName, fullName, nullptr) {}
+        Error action(char* value, WebUI::AuthenticationLevel auth_level, Channel& out) override { return Error::Ok; }
+    };
+
+    std::deque<std::string> names;  // Words keep pointers to their names
+
+    const char* keep(const std::string& name) {
+        names.push_back(name);
+        return names.back().c_str();
+    }
+
+    void registerWords() {
+        if (!names.empty()) {
+            return;
+        }
+        char buf[40];
+        for (int i = 0; i < 40; i++) {
+            snprintf(buf, sizeof(buf), "Sta/Setting%02d", i);
+            const char* full = keep(buf);
+            snprintf(buf, sizeof(buf), "%d", 10 + i);
+            new BenchSetting(i % 4 ? nullptr : keep(buf), full);
+        }
+        for (int i = 0; i < 120; i++) {
+            snprintf(buf, sizeof(buf), "%s/Command%03d", i < 60 ? "Maslow" : "Job", i);
+            const char* full = keep(buf);
+            snprintf(buf, sizeof(buf), "C%d", i);
+            new BenchCommand(i < 100 ? keep(buf) : nullptr, full);
+        }
+    }
+
+    Word* referenceFind(const char* key, WordIndex::Kind& kind) {
+        for (Setting* s = Setting::List; s; s = s->next()) {
+            if (strcasecmp(s->getName(), key) == 0) {
+                kind = WordIndex::Kind::Setting;
+                return s;
+            }
+        }
+        for (Setting* s = Setting::List; s; s = s->next()) {
+            if (s->getGrblName() && strcasecmp(s->getGrblName(), key) == 0) {
+                kind = WordIndex::Kind::GrblSetting;
+                return s;
+            }
+        }
+        for (Command* cp = Command::List; cp; cp = cp->next()) {
+            if ((strcasecmp(cp->getName(), key) == 0) || (cp->getGrblName() && strcasecmp(cp->getGrblName(), key) == 0)) {
+                kind = WordIndex::Kind::Command;
+                return cp;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> keys() {
+        std::vector<std::string> result;
+        for (auto& name : names) {
+            std::string key = name;
+            for (size_t i = 0; i < key.size(); i += 2) {
+                key[i] = tolower(key[i]);  // Case must not matter
+            }
+            result.push_back(key);
+        }
+        for (int i = 0; i < 20; i++) {
+            result.push_back("Missing/Key" + std::to_string(i));
+        }
+        return result;
+    }
+
+    Test(Settings, IndexMatchesScan) {
+        registerWords();
+        int mismatches = 0;
+        for (auto& key : keys()) {
+            WordIndex::Kind  kind;
+            Word*            expected = referenceFind(key.c_str(), kind);
+            WordIndex::Entry entry;
+            bool             found = WordIndex::find(key.c_str(), entry);
+            if (found != (expected != nullptr) || (found && (entry.word != expected || entry.kind != kind))) {
+                Debug("Settings: %s found differently", key.c_str());
+                ++mismatches;
+            }
+        }
+        Assert(mismatches == 0, "Index disagrees with the list scans");
+    }
+
+    Test(Settings, LateRegistration) {
+        registerWords();
+        WordIndex::Entry entry;
+        Assert(!WordIndex::find("Late/Command", entry), "Found a command that does not exist");
+        new BenchCommand(nullptr, "Late/Command");
+        Assert(WordIndex::find("late/command", entry), "Index was not rebuilt for a new command");
+    }
+
+    Test(Settings, LookupBenchmark) {
+        registerWords();
+        auto      lookups = keys();
+        const int rounds  = 2000;
+
+        size_t found = 0;
+        auto   start = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (auto& key : lookups) {
+                WordIndex::Kind kind;
+                found += referenceFind(key.c_str(), kind) != nullptr;
+            }
+        }
+        double scanTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+        size_t indexed = 0;
+        start          = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (auto& key : lookups) {
+                WordIndex::Entry entry;
+                indexed += WordIndex::find(key.c_str(), entry);
+            }
+        }
+        double indexTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+        double n = double(rounds) * lookups.size();
+        Debug("Settings: %zu names; list scans %.0f ns/lookup, index %.0f ns/lookup", WordIndex::size(), scanTime / n * 1e9, indexTime / n * 1e9);
+        Assert(found == indexed, "Index found a different number of keys");
+    }
+}
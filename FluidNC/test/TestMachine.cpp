@@ -0,0 +1,48 @@
+#include "TestMachine.h"
+#include "TestFramework.h"
+
+#include <src/System.h>
+
+TestMachine::TestMachine(float jerk) {
+    _config._axes              = new Machine::Axes();
+    _config._axes->_numberAxis = 3;
+    for (int i = 0; i < 3; i++) {
+        auto axis               = new Machine::Axis(i);
+        axis->_stepsPerMm       = 100.0f;
+        axis->_maxRate          = 6000.0f;
+        axis->_acceleration     = 500.0f;
+        axis->_jerk             = jerk;
+        _config._axes->_axis[i] = axis;
+    }
+    _config.afterParse();
+    _config._kinematics->afterParse();
+    config = &_config;
+
+    system_reset();
+    plan_init();
+    plan_reset();
+    plan_sync_position();
+}
+
+plan_block_t* TestMachine::line(float x, float y, float feed) {
+    float            target[MAX_N_AXIS] = { x, y, 0 };
+    plan_line_data_t pl_data            = {};
+    pl_data.feed_rate                   = feed;
+    Assert(plan_buffer_line(target, &pl_data), "Line not planned");
+    return plan_get_current_block();
+}
+
+TestMachine::~TestMachine() {
+    plan_reset();
+    config = nullptr;
+
+    // The MachineConfig destructor frees the axes, but not these, which afterParse() made
+    delete _config._kinematics;
+    delete _config._stepping;
+    delete _config._userOutputs;
+    delete _config._start;
+    delete _config._parking;
+    for (auto spindle : _config._spindles) {
+        delete spindle;
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <src/Machine/MachineConfig.h>
+#include <src/Planner.h>
+
+// A Cartesian machine for tests that plan motion but never step it: three axes
+// at 100 steps/mm, 6000 mm/min and 500 mm/sec^2, jerk-limited if jerk (in
+// mm/sec^3) is not zero.  It is the global config while it exists, with the
+// planner empty at the origin, and it frees the configuration when it goes.
+class TestMachine {
+    Machine::MachineConfig _config;
+
+public:
+    explicit TestMachine(float jerk = 0.0f);
+
+    TestMachine(const TestMachine&) = delete;
+    TestMachine& operator=(const TestMachine&) = delete;
+
+    // Plans a feed move to x, y and returns the oldest block, which is that move if the planner was empty
+    plan_block_t* line(float x, float y, float feed);
+
+    ~TestMachine();
+};
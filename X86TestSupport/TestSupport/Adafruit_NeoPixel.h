@@ -0,0 +1,21 @@
+#pragma once
+
+// Stand-in for the Adafruit NeoPixel library, with the part of its interface
+// that FluidNC uses.  Nothing is lit.
+
+#include <cstdint>
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type = NEO_GRB + NEO_KHZ800) {}
+
+    void begin() {}
+    void clear() {}
+    void show() {}
+    void setPixelColor(uint16_t n, uint32_t c) {}
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return (uint32_t(r) << 16) | (uint32_t(g) << 8) | b; }
+};
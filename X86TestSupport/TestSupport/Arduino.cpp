@@ -1,4 +1,5 @@
 #include "Arduino.h"
+#include "esp_timer.h"
 
 #include "SoftwareGPIO.h"
 #include "Capture.h"
@@ -10,6 +11,28 @@ int64_t esp_timer_get_time() {
     return Capture::instance().current();
 }
 
+struct esp_timer {
+    esp_timer_create_args_t args;
+};
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    *out_handle = new esp_timer { *create_args };
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    delete timer;
+    return ESP_OK;
+}
+
 void attachInterrupt(uint8_t pin, void (*callback)(void), int mode) {
     attachInterruptArg(
         pin,
@@ -21,7 +44,7 @@ void attachInterrupt(uint8_t pin, void (*callback)(void), int mode) {
         mode);
 }
 
-void attachInterruptArg(uint8_t pin, void (*callback)(void*, bool), void* arg, int mode) {
+void attachInterruptArg(uint8_t pin, void (*callback)(void*), void* arg, int mode) {
     SoftwareGPIO::instance().attachISR(pin, callback, arg, mode);
 }
 
@@ -44,10 +67,50 @@ extern "C" void __digitalWrite(uint8_t pin, uint8_t val) {
     return io.writeOutput(pin, val ? true : false);
 }
 
+#if !defined(_WIN32) && !defined(_WIN64)
+char* itoa(int value, char* str, int base) {
+    const char*  digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+    char*        p      = str;
+    unsigned int v      = (value < 0 && base == 10) ? -unsigned(value) : unsigned(value);
+    do {
+        *p++ = digits[v % base];
+        v /= base;
+    } while (v);
+    if (value < 0 && base == 10) {
+        *p++ = '-';
+    }
+    *p = '\0';
+    for (char* q = str; q < --p; ++q) {
+        char c = *q;
+        *q     = *p;
+        *p     = c;
+    }
+    return str;
+}
+#endif
+
 void delay(int ms) {
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
+long random(long howbig) {
+    return howbig ? std::rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return 0;
+}
+
 int temperatureRead(void) {
     return 22;  // Nobody cares
 }
@@ -62,6 +125,9 @@ uint64_t EspClass::getEfuseMac() {
 uint32_t EspClass::getCpuFreqMHz() {
     return 240;
 }
+uint8_t EspClass::getChipCores() {
+    return 2;
+}
 const char* EspClass::getSdkVersion() {
     return "v1.0-UnitTest-foobar";
 }
@@ -77,3 +143,7 @@ void EspClass::restart() {
 }
 
 EspClass ESP;
+
+const char* esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
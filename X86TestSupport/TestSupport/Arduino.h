@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <cmath>
+#include <algorithm>
 
 #include "esp_err.h"
 
@@ -12,6 +14,11 @@ class SystemRestartException {};
 
 void delay(int ms);
 
+unsigned long millis();
+unsigned long micros();
+
+uint16_t analogRead(uint8_t pin);
+
 // Get time in microseconds since boot.
 int64_t esp_timer_get_time();
 
@@ -22,6 +29,30 @@ int64_t esp_timer_get_time();
 
 #define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
 
+#define PI 3.1415926535897932384626433832795
+
+using std::max;
+using std::min;
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// From stdlib_noniso.h; the Windows C library has its own
+char* itoa(int value, char* str, int base);
+#endif
+
 // ESP...
 
 #include "Esp.h"
+#include "esp32-hal-gpio.h"
+
+#include "Print.h"
+
+// Output to Serial goes to stdout
+class HardwareSerial : public Print {
+public:
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
@@ -0,0 +1,54 @@
+#pragma once
+
+// Stand-in for the ThingPulse SSD1306 library, with the part of its interface
+// that FluidNC uses.  Nothing is drawn.
+
+#include <cstdint>
+#include "WString.h"
+
+// SSD1306 commands
+#define COLUMNADDR 0x21
+#define PAGEADDR 0x22
+
+enum OLEDDISPLAY_GEOMETRY { GEOMETRY_128_64, GEOMETRY_128_32, GEOMETRY_64_48, GEOMETRY_64_32 };
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT { TEXT_ALIGN_LEFT, TEXT_ALIGN_RIGHT, TEXT_ALIGN_CENTER, TEXT_ALIGN_CENTER_BOTH };
+
+inline const uint8_t ArialMT_Plain_10[] = { 0 };
+inline const uint8_t ArialMT_Plain_16[] = { 0 };
+inline const uint8_t ArialMT_Plain_24[] = { 0 };
+
+class OLEDDisplay {
+protected:
+    OLEDDISPLAY_GEOMETRY geometry;
+    uint16_t             displayWidth  = 128;
+    uint16_t             displayHeight = 64;
+    uint16_t             displayBufferSize = 1024;
+    uint8_t*             buffer            = nullptr;
+
+public:
+    virtual ~OLEDDisplay() {}
+
+    bool init() { return true; }
+    void clear() {}
+    void flipScreenVertically() {}
+    void mirrorScreen() {}
+    void resetDisplay() {}
+    void setContrast(uint8_t contrast) {}
+    void setGeometry(OLEDDISPLAY_GEOMETRY g, uint16_t width = 0, uint16_t height = 0) { geometry = g; }
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT alignment) {}
+    void setFont(const uint8_t* font) {}
+    void drawString(int16_t x, int16_t y, const String& text) {}
+    void drawStringMaxWidth(int16_t x, int16_t y, uint16_t maxWidth, const String& text) {}
+    uint16_t getStringWidth(const String& text) { return 0; }
+    void     setPixel(int16_t x, int16_t y) {}
+    void     drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {}
+    void     drawRect(int16_t x, int16_t y, int16_t width, int16_t height) {}
+    void     fillRect(int16_t x, int16_t y, int16_t width, int16_t height) {}
+    void     drawXbm(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t* xbm) {}
+    void     drawProgressBar(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t progress) {}
+    uint16_t width() { return displayWidth; }
+    uint16_t height() { return displayHeight; }
+
+    virtual void display(void) = 0;
+};
@@ -61,6 +61,8 @@ public:
     // default to zero, meaning "a single write may block"
     // should be overriden by subclasses with buffering
     virtual int availableForWrite() { return 0; }
+
+    virtual void flush() { /* Empty implementation for backward compatibility */ }
     size_t      print(const String&);
     size_t      print(const char[]);
     size_t      print(char);
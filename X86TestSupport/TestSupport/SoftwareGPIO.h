@@ -8,7 +8,7 @@
 struct SoftwarePin {
     SoftwarePin() : callback(), argument(nullptr), mode(0), driverValue(false), padValue(false), pinMode(0) {}
 
-    void (*callback)(void*, bool v);
+    void (*callback)(void*);
     void* argument;
     int   mode;
 
@@ -16,7 +16,7 @@ struct SoftwarePin {
     bool padValue;
     int  pinMode;
 
-    void handleISR(bool nv) { callback(argument, nv); }
+    void handleISR(bool nv) { callback(argument); }
 
     void reset() {
         callback    = nullptr;
@@ -134,7 +134,7 @@ public:
 
     bool read(int index) const { return pins[index].padValue; }
 
-    void attachISR(int index, void (*callback)(void* arg, bool v), void* arg, int mode) {
+    void attachISR(int index, void (*callback)(void* arg), void* arg, int mode) {
         auto& pin = pins[index];
         Assert(pin.mode == 0, "ISR mode should be 0 when attaching interrupt. Another interrupt is already attached.");
 
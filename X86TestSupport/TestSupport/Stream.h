@@ -47,7 +47,6 @@ public:
     virtual int  available() = 0;
     virtual int  read()      = 0;
     virtual int  peek()      = 0;
-    virtual void flush()     = 0;
 
     Stream() : _startMillis(0) { _timeout = 1000; }
     virtual ~Stream() {}
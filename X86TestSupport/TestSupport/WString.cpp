@@ -1,4 +1,5 @@
 #include "WString.h"
+#include "Arduino.h"  // itoa
 
 #include <iomanip>
 #include <sstream>
@@ -6,10 +7,8 @@
 #pragma warning(disable : 4996)  // itoa
 
 std::string String::ValueToString(int value, int base) {
-    char        buffer[100] = { 0 };
-    int         number_base = 10;
-    std::string output      = itoa(value, buffer, base);
-    return output;
+    char buffer[100] = { 0 };
+    return itoa(value, buffer, base);
 }
 
 std::string String::DecToString(double value, int decimalPlaces) {
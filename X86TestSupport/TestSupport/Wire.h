@@ -40,7 +40,7 @@ public:
     bool setPins(int sda, int scl);
 
     bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);  // returns true, if successful init of i2c bus
-    bool begin(uint8_t slaveAddr, int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool begin(uint8_t slaveAddr, int sda, int scl, uint32_t frequency);
     bool end();
 
     void     setTimeOut(uint16_t timeOutMillis);  // default timeout of i2c transactions is 50ms
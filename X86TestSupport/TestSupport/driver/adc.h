@@ -0,0 +1,4 @@
+#pragma once
+
+// Stand-in for the ESP-IDF ADC driver.  FluidNC reads analog inputs with
+// analogRead(), which is in Arduino.h.
@@ -0,0 +1,7 @@
+#pragma once
+
+// Stand-in for the ESP-IDF SPI master driver, with only the device handle
+// type that the driver interface in Driver/spi.h refers to
+
+struct spi_device_t;
+typedef struct spi_device_t* spi_device_handle_t;
@@ -40,12 +40,17 @@ typedef enum {
 /**
  * @brief UART peripheral number
  */
-typedef enum {
+typedef int uart_port_t;
+
+enum {
     UART_NUM_0 = 0x0, /*!< UART base address 0x3ff40000*/
     UART_NUM_1 = 0x1, /*!< UART base address 0x3ff50000*/
     UART_NUM_2 = 0x2, /*!< UART base address 0x3ff6e000*/
     UART_NUM_MAX,
-} uart_port_t;
+};
+
+// From esp_intr_alloc.h
+#define ESP_INTR_FLAG_IRAM (1 << 10)
 
 /**
  * @brief UART parity constants
@@ -80,6 +85,7 @@ typedef struct {
 const int UART_FIFO_LEN = 128;
 
 esp_err_t uart_flush(uart_port_t uart_num);
+esp_err_t uart_flush_input(uart_port_t uart_num);
 esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config);
 esp_err_t uart_driver_install(
     uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size, QueueHandle_t* uart_queue, int intr_alloc_flags);
@@ -16,6 +16,9 @@ inline std::string uart_key(uart_port_t uart_num) {
 esp_err_t uart_flush(uart_port_t uart_num) {
     return ESP_OK;
 }
+esp_err_t uart_flush_input(uart_port_t uart_num) {
+    return ESP_OK;
+}
 esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t* uart_config) {
     return ESP_OK;
 }
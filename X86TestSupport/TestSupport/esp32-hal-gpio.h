@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include "esp32-hal-ledc.h"
 
 // Interrupt Modes
 #define RISING 0x01
@@ -70,8 +71,8 @@ typedef enum {
 #define INPUT_PULLUP 0x05
 #define PULLDOWN 0x08
 #define INPUT_PULLDOWN 0x09
-// #define OPEN_DRAIN        0x10
-// #define OUTPUT_OPEN_DRAIN 0x12
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x12
 
 void attachInterrupt(uint8_t pin, void (*)(void), int mode);
 void attachInterruptArg(uint8_t pin, void (*)(void*), void* arg, int mode);
@@ -80,3 +81,8 @@ void detachInterrupt(uint8_t pin);
 extern "C" int  __digitalRead(uint8_t pin);
 extern "C" void __pinMode(uint8_t pin, uint8_t mode);
 extern "C" void __digitalWrite(uint8_t pin, uint8_t val);
+
+// Defined by PinMapper, which forwards them to the GPIO driver or a mapped pin
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
@@ -0,0 +1,3 @@
+#pragma once
+
+// Stand-in for the ESP-IDF ADC calibration interface, which FluidNC does not call
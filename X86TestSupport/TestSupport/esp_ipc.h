@@ -0,0 +1,13 @@
+#pragma once
+
+#include "esp_err.h"
+
+// Stand-in for the ESP-IDF inter-processor call.  There is only one "core",
+// so the function is called directly.
+
+typedef void (*esp_ipc_func_t)(void* arg);
+
+inline esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void* arg) {
+    func(arg);
+    return ESP_OK;
+}
@@ -1,7 +1,7 @@
 #pragma once
 
-#include "Task.h"
-#include "Queue.h"
+#include "task.h"
+#include "queue.h"
 #include "FreeRTOSTypes.h"
 #include <mutex>
 #include <atomic>
@@ -26,6 +26,16 @@ inline void vTaskEnterCritical(portMUX_TYPE* mux) {
     mux->unlock();
 }
 
+// There are no interrupt handlers on the host, so critical sections only need the lock
+#define portENTER_CRITICAL(mux) (mux)->lock()
+#define portEXIT_CRITICAL(mux) (mux)->unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->unlock()
+
+inline bool xPortInIsrContext() {
+    return false;
+}
+
 inline int32_t xPortGetFreeHeapSize() {
     return 1024 * 1024 * 4;
 }
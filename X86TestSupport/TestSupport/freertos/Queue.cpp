@@ -1,9 +1,21 @@
-#include "Queue.h"
+#include "queue.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <mutex>
 
+// Waits, as FreeRTOS does, up to xTicksToWait for ready() to become true
+template <typename Ready>
+static bool waitFor(QueueHandle_t xQueue, std::unique_lock<std::mutex>& lock, TickType_t xTicksToWait, Ready ready) {
+    if (xTicksToWait == portMAX_DELAY) {
+        xQueue->changed.wait(lock, ready);
+        return true;
+    }
+    return xQueue->changed.wait_for(lock, std::chrono::milliseconds(xTicksToWait * portTICK_PERIOD_MS), ready);
+}
+
 QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, const uint8_t ucQueueType /* =0 */) {
     auto ptr         = new QueueHandle();
     ptr->entrySize   = uxItemSize;
@@ -13,16 +25,19 @@ QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseTy
 }
 
 BaseType_t xQueueGenericReceive(QueueHandle_t xQueue, void* const pvBuffer, TickType_t xTicksToWait, const BaseType_t xJustPeek) {
-    std::lock_guard<std::mutex> lock(xQueue->mutex);
+    std::unique_lock<std::mutex> lock(xQueue->mutex);
 
-    if (xQueue->readIndex != xQueue->writeIndex) {
+    if (waitFor(xQueue, lock, xTicksToWait, [xQueue] { return xQueue->readIndex != xQueue->writeIndex; })) {
         memcpy(pvBuffer, xQueue->data.data() + xQueue->readIndex, xQueue->entrySize);
 
-        auto newPtr = xQueue->readIndex + xQueue->entrySize;
-        if (newPtr == xQueue->data.size()) {
-            newPtr = 0;
+        if (!xJustPeek) {
+            auto newPtr = xQueue->readIndex + xQueue->entrySize;
+            if (newPtr == xQueue->data.size()) {
+                newPtr = 0;
+            }
+            xQueue->readIndex = newPtr;
+            xQueue->changed.notify_all();
         }
-        xQueue->readIndex = newPtr;
 
         return pdTRUE;
     } else {
@@ -44,6 +59,7 @@ BaseType_t xQueueGenericSendFromISR(QueueHandle_t     xQueue,
         memcpy(xQueue->data.data() + xQueue->writeIndex, pvItemToQueue, xQueue->entrySize);
 
         xQueue->writeIndex = newPtr;
+        xQueue->changed.notify_all();
         return pdTRUE;
     } else {
         return errQUEUE_FULL;
@@ -57,6 +73,24 @@ BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue) {
     return pdTRUE;
 }
 
+void vQueueDelete(QueueHandle_t xQueue) {
+    delete xQueue;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue) {
+    std::lock_guard<std::mutex> lock(xQueue->mutex);
+
+    auto size = xQueue->data.size();
+    return ((xQueue->writeIndex + size - xQueue->readIndex) % size) / xQueue->entrySize;
+}
+
 BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void* const pvItemToQueue, TickType_t xTicksToWait, BaseType_t xCopyPosition) {
+    if (xTicksToWait) {
+        std::unique_lock<std::mutex> lock(xQueue->mutex);
+        waitFor(xQueue, lock, xTicksToWait, [xQueue] {
+            auto newPtr = xQueue->writeIndex + xQueue->entrySize;
+            return (newPtr == xQueue->data.size() ? 0 : newPtr) != xQueue->readIndex;
+        });
+    }
     return xQueueGenericSendFromISR(xQueue, pvItemToQueue, nullptr, xCopyPosition);
 }
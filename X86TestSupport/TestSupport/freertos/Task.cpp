@@ -1,4 +1,4 @@
-#include "Task.h"
+#include "task.h"
 
 #include "Capture.h"
 #include "../Arduino.h"
@@ -21,6 +21,7 @@ BaseType_t xTaskCreatePinnedToCore(TaskFunction_t      pvTaskCode,
                                    TaskHandle_t* const pvCreatedTask,
                                    const BaseType_t    xCoreID) {
     std::unique_ptr<std::thread> thread = std::make_unique<std::thread>(pvTaskCode, pvParameters);
+    thread->detach();  // Tasks never return, so a joinable thread would abort the program at exit
     threads.emplace_back(std::move(thread));
     return pdTRUE;
 }
@@ -40,6 +41,19 @@ TickType_t xTaskGetTickCount(void) {
     return inst.current();
 }
 
+void vTaskSuspend(TaskHandle_t xTaskToSuspend) {}
+
+void vTaskResume(TaskHandle_t xTaskToResume) {}
+
+void xTaskNotifyGive(TaskHandle_t xTaskToNotify) {}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    do {
+        vTaskDelay(xTicksToWait == portMAX_DELAY ? 1000 : xTicksToWait);
+    } while (xTicksToWait == portMAX_DELAY);
+    return 0;
+}
+
 unsigned long micros() {
     return xTaskGetTickCount() / (portTICK_PERIOD_MS / 1000);
 }
@@ -1,13 +1,15 @@
 #pragma once
 
-#include "Task.h"
+#include "task.h"
 #include "FreeRTOSTypes.h"
 
 #include <queue>
 #include <mutex>
+#include <condition_variable>
 
 struct QueueHandle {
-    std::mutex mutex;
+    std::mutex              mutex;
+    std::condition_variable changed;  // Wakes senders and receivers that are waiting for room or data
 
     size_t numberItems = 16;
     size_t entrySize   = 1;
@@ -37,6 +39,10 @@ QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseTy
 
 BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue);
 
+void vQueueDelete(QueueHandle_t xQueue);
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue);
+
 BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void* const pvItemToQueue, TickType_t xTicksToWait, BaseType_t xCopyPosition);
 
 #define xQueueSendFromISR(xQueue, pvItemToQueue, pxHigherPriorityTaskWoken)                                                                \
@@ -45,6 +51,7 @@ BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void* const pvItemToQue
 #define pdFALSE ((BaseType_t)0)
 #define pdTRUE ((BaseType_t)1)
 #define xQueueReceive(xQueue, pvBuffer, xTicksToWait) xQueueGenericReceive((xQueue), (pvBuffer), (xTicksToWait), pdFALSE)
+#define xQueuePeek(xQueue, pvBuffer, xTicksToWait) xQueueGenericReceive((xQueue), (pvBuffer), (xTicksToWait), pdTRUE)
 
 #define queueQUEUE_TYPE_BASE ((uint8_t)0U)
 
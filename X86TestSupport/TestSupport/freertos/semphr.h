@@ -0,0 +1,31 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+#include <chrono>
+#include <mutex>
+
+// Stand-in for FreeRTOS semaphores, with the mutexes that FluidNC uses
+
+typedef std::timed_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new std::timed_mutex();
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait) {
+    if (xTicksToWait == portMAX_DELAY) {
+        xSemaphore->lock();
+        return 1;
+    }
+    return xSemaphore->try_lock_for(std::chrono::milliseconds(xTicksToWait)) ? 1 : 0;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    xSemaphore->unlock();
+    return 1;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) {
+    delete xSemaphore;
+}
@@ -0,0 +1,28 @@
+#include "timers.h"
+
+namespace {
+    struct Timer {
+        void*                   id;
+        TimerCallbackFunction_t callback;
+    };
+}
+
+TimerHandle_t xTimerCreate(const char* const       pcTimerName,
+                           const TickType_t        xTimerPeriodInTicks,
+                           const UBaseType_t       uxAutoReload,
+                           void* const             pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction) {
+    return new Timer { pvTimerID, pxCallbackFunction };
+}
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    return pdPASS;
+}
+
+void* pvTimerGetTimerID(const TimerHandle_t xTimer) {
+    return static_cast<Timer*>(xTimer)->id;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Stand-in for FreeRTOS software timers.  Timers can be created and started,
+// but they never fire; nothing in the host builds depends on them.
+
+typedef void* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+#ifndef pdPASS
+#    define pdPASS ((BaseType_t)1)
+#    define pdFAIL ((BaseType_t)0)
+#endif
+
+TimerHandle_t xTimerCreate(const char* const       pcTimerName,
+                           const TickType_t        xTimerPeriodInTicks,
+                           const UBaseType_t       uxAutoReload,
+                           void* const             pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction);
+BaseType_t    xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t    xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+void*         pvTimerGetTimerID(const TimerHandle_t xTimer);
@@ -0,0 +1,30 @@
+#pragma once
+
+// Stand-in for the mbedTLS message digest interface, with SHA-256 only
+
+#include <cstddef>
+#include <cstdint>
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256,
+} mbedtls_md_type_t;
+
+typedef struct mbedtls_md_info_t mbedtls_md_info_t;
+
+typedef struct {
+    const mbedtls_md_info_t* md_info;
+    uint32_t                 state[8];
+    uint64_t                 length;  // Bytes hashed so far
+    uint8_t                  block[64];
+    size_t                   used;  // Bytes waiting in block
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t md_type);
+
+void mbedtls_md_init(mbedtls_md_context_t* ctx);
+void mbedtls_md_free(mbedtls_md_context_t* ctx);
+int  mbedtls_md_setup(mbedtls_md_context_t* ctx, const mbedtls_md_info_t* md_info, int hmac);
+int  mbedtls_md_starts(mbedtls_md_context_t* ctx);
+int  mbedtls_md_update(mbedtls_md_context_t* ctx, const unsigned char* input, size_t ilen);
+int  mbedtls_md_finish(mbedtls_md_context_t* ctx, unsigned char* output);
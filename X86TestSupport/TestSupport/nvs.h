@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <cstring>
 #include "esp_err.h"
 
 class NvsEmulator {
@@ -91,7 +92,8 @@ struct nvs_stats_t {
     int total_entries;
 };
 
-using nvs_handle = NvsEmulator*;
+using nvs_handle   = NvsEmulator*;
+using nvs_handle_t = nvs_handle;
 
 inline esp_err_t nvs_get_stats(const char* part_name, nvs_stats_t* stats) {
     auto& inst           = NvsEmulator::instance();
@@ -162,3 +164,4 @@ esp_err_t nvs_set_i8(nvs_handle handle, const char* key, int8_t value);
 esp_err_t nvs_set_i32(nvs_handle handle, const char* key, int32_t value);
 esp_err_t nvs_set_str(nvs_handle handle, const char* key, const char* value);
 esp_err_t nvs_set_blob(nvs_handle handle, const char* key, const void* value, size_t length);
+esp_err_t nvs_commit(nvs_handle handle);
@@ -0,0 +1,4 @@
+#pragma once
+
+// Stand-in for the ESP-IDF build configuration.  No CONFIG_IDF_TARGET_* is
+// defined, so code that tests for a chip takes its generic path.
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+
+# Converts a Maslow belt telemetry file (M4_telemetry.bin, recorded with
+# $Maslow/setTelemetry) to CSV.  The layout is described in
+# FluidNC/src/Maslow/Telemetry.h; keep the two in step.
+#
+#   decode-telemetry.py M4_telemetry.bin > telemetry.csv
+#   decode-telemetry.py M4_telemetry.bin -o telemetry.csv
+
+import argparse
+import csv
+import struct
+import sys
+
+HEADER = struct.Struct('<4sHHI20s')
+MAGIC = b'M4TL'
+VERSION = 2
+
+RECORD = struct.Struct('<I4f2f4h4h4h4hHBB')
+
+BELTS = ['tl', 'tr', 'bl', 'br']
+FLAGS = ['extendedTL', 'extendedTR', 'extendedBL', 'extendedBR', 'extendingALL', 'complyALL',
+         'takeSlack', 'safetyOn', 'holding', 'calibrationInProgress']
+STATES = ['Idle', 'Alarm', 'CheckMode', 'Homing', 'Cycle', 'Hold', 'Jog', 'SafetyDoor', 'Sleep', 'ConfigAlarm']
+
+def columns():
+    names = ['time_s']
+    names += [b + 'Pos' for b in BELTS]
+    names += ['targetX', 'targetY']
+    names += [b + 'Error' for b in BELTS]
+    names += [b + 'Current' for b in BELTS]
+    names += [b + 'Power' for b in BELTS]
+    names += [b + 'Speed' for b in BELTS]
+    names += FLAGS
+    names += ['state', 'work_us', 'gap']
+    return names
+
+def records(f, sampleHz):
+    # The recorded time is in microseconds and wraps every 2**32 us
+    start = None
+    last = None
+    offset = 0
+    period = 1e6 / sampleHz if sampleHz else 0
+    while True:
+        data = f.read(RECORD.size)
+        if len(data) < RECORD.size:
+            return
+        fields = RECORD.unpack(data)
+        time = fields[0]
+        if last is not None and time < last:
+            offset += 1 << 32
+        # A gap is a longer than usual wait since the previous record, from dropped records or a stalled loop
+        gap = 1 if last is not None and period and (time - last) % (1 << 32) > 1.5 * period else 0
+        last = time
+        if start is None:
+            start = time
+        t = (time + offset - start) / 1e6
+
+        position = fields[1:5]
+        target = fields[5:7]
+        error = [e / 1000.0 for e in fields[7:11]]
+        current = fields[11:15]
+        power = fields[15:19]
+        speed = [s / 100.0 for s in fields[19:23]]
+        flags, state, work = fields[23:26]
+        bits = [(flags >> i) & 1 for i in range(len(FLAGS))]
+        stateName = STATES[state] if state < len(STATES) else str(state)
+        yield ['%.6f' % t] + ['%.4f' % p for p in position] + ['%.3f' % p for p in target] + \
+              ['%.3f' % e for e in error] + list(current) + list(power) + ['%.2f' % s for s in speed] + \
+              bits + [stateName, work * 10, gap]
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert Maslow belt telemetry to CSV')
+    parser.add_argument('file', help='telemetry file downloaded from the SD card')
+    parser.add_argument('-o', '--output', help='CSV file to write, instead of standard output')
+    args = parser.parse_args()
+
+    with open(args.file, 'rb') as f:
+        header = f.read(HEADER.size)
+        if len(header) < HEADER.size:
+            sys.exit('%s is too short to be a telemetry file' % args.file)
+        magic, version, recordSize, sampleHz, firmware = HEADER.unpack(header)
+        if magic != MAGIC:
+            sys.exit('%s is not a telemetry file, or is from firmware that wrote the old format' % args.file)
+        if version != VERSION or recordSize != RECORD.size:
+            sys.exit('%s has telemetry version %d with %d byte records; this decoder reads version %d'
+                     % (args.file, version, recordSize, VERSION))
+        firmware = firmware.rstrip(b'\0').decode('ascii', 'replace')
+        sys.stderr.write('Firmware %s, %d Hz\n' % (firmware, sampleHz))
+
+        out = open(args.output, 'w', newline='') if args.output else sys.stdout
+        writer = csv.writer(out)
+        writer.writerow(columns())
+        count = 0
+        gaps = 0
+        for row in records(f, sampleHz):
+            writer.writerow(row)
+            count += 1
+            gaps += row[-1]
+        if args.output:
+            out.close()
+        sys.stderr.write('%d records, %d gaps\n' % (count, gaps))
+
+if __name__ == '__main__':
+    main()